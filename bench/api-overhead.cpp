@@ -0,0 +1,139 @@
+// Per-call overhead of the gsCore api wrappers
+//
+// usage: api-overhead [--prebind] [--in-process] [--profile] [iterations]
+//
+// The core library is located the same way as in applications (system search path, GS_SDK_BIN, ...).
+// The wrapper cost is measured against a direct call of the same symbol exported by the loaded gsCore.
+//
+// When built with the stub core linked in (BENCH_STUB_CORE_LINKED), --in-process registers its api table
+// instead of loading gsCore; with GS_SDK_STATIC_CORE the wrappers call the stub core directly.
+//
+// --profile measures the wrappers with api profiling turned on.
+
+#include <GS5_Intf.h>
+#ifdef BENCH_STUB_CORE_LINKED
+#include <gsCoreStub.h>
+namespace stub_core {
+extern "C" int gsGetLastErrorCode();
+}
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <dlfcn.h>
+#include <link.h>
+
+using namespace gs;
+
+namespace {
+
+typedef std::chrono::steady_clock clk;
+
+double ns_since(clk::time_point t0) {
+    return std::chrono::duration<double, std::nano>(clk::now() - t0).count();
+}
+
+//full path of the loaded gsCore module
+std::string core_path() {
+    std::string path;
+    dl_iterate_phdr([](struct dl_phdr_info *info, size_t, void *data) -> int {
+        if (info->dlpi_name && strstr(info->dlpi_name, "gsCore")) {
+            *(std::string *)data = info->dlpi_name;
+            return 1;
+        }
+        return 0;
+    },
+                    &path);
+    return path;
+}
+
+template <typename F>
+double per_call(F f, long n) {
+    auto t0 = clk::now();
+    for (long i = 0; i < n; i++)
+        f();
+    return ns_since(t0) / n;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bool prebind = false;
+    bool inProcess = false;
+    bool profile = false;
+    long N = 10000000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--prebind") == 0)
+            prebind = true;
+        else if (strcmp(argv[i], "--in-process") == 0)
+            inProcess = true;
+        else if (strcmp(argv[i], "--profile") == 0)
+            profile = true;
+        else
+            N = atol(argv[i]);
+    }
+
+    //cold: load core and bind the apis
+    auto t0 = clk::now();
+    if (inProcess) {
+#ifdef BENCH_STUB_CORE_LINKED
+        int count = 0;
+        const sdk_api_entry *table = gsStubGetApiTable(&count);
+        if (!sdk_set_api_table(table, count)) {
+            fprintf(stderr, "api table not accepted!\n");
+            return -1;
+        }
+#else
+        fprintf(stderr, "--in-process: stub core not linked!\n");
+        return -1;
+#endif
+    }
+    if (prebind)
+        printf("prebind: %d apis bound\n", sdk_prebind());
+    else
+        gsGetVersion();
+    printf("%-28s %12.0f ns\n", prebind ? "load + bind all" : "load + bind first api", ns_since(t0));
+    if (const sdk_core_discovery *d = sdk_get_core_discovery()) {
+        for (int i = 0; i < d->probeCount; i++)
+            printf("  probe %-20s %12llu ns  %s\n", d->probes[i].source, (unsigned long long)d->probes[i].elapsed, d->probes[i].path);
+    }
+
+    //first call of other apis
+    t0 = clk::now();
+    gsGetLastErrorCode();
+    gsGetLastErrorMessage();
+    gsIsDebugVersion();
+    gsRunInWrappedMode();
+    printf("%-28s %12.0f ns\n", "first call of 4 apis", ns_since(t0));
+
+    //steady state
+    std::string path = core_path();
+    void *h = path.empty() ? nullptr : dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+    typedef int (*Fapi)();
+    volatile Fapi direct = h ? (Fapi)dlsym(h, "gsGetLastErrorCode") : nullptr;
+#ifdef BENCH_STUB_CORE_LINKED
+    if (h == nullptr)
+        direct = &stub_core::gsGetLastErrorCode;
+#endif
+    if (direct == nullptr) {
+        fprintf(stderr, "cannot locate gsCore symbols!\n");
+        return -1;
+    }
+
+    if (profile)
+        sdk_profile_enable(true);
+
+    double t_direct = per_call([&] { direct(); }, N);
+    double t_wrapper = per_call([] { gsGetLastErrorCode(); }, N);
+    printf("%-28s %12.2f ns/call\n", "direct core call", t_direct);
+    printf("%-28s %12.2f ns/call\n", "wrapper call", t_wrapper);
+    printf("%-28s %12.2f ns/call\n", "wrapper overhead", t_wrapper - t_direct);
+
+    if (h)
+        dlclose(h);
+    return 0;
+}
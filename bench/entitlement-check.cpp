@@ -0,0 +1,171 @@
+// Scalability of entitlement checks: the same check run from 1..N threads at once
+//
+// usage: entitlement-check [--threads N] [--ops N] [--sample N]
+//
+// --threads: highest thread count (default: number of cpus), runs 1, 2, 4... up to it
+// --ops: checks per thread and run (default: 100000)
+// --sample: one check in N is timed on its own for the latencies (default: 16)
+//
+// Output is csv, one line per check and thread count:
+//
+//   check,threads,ops_per_sec,p50_ns,p99_ns,p999_ns
+//
+// The checks between two samples run as a batch timed by one pair of clock reads, throughput is the sum over the
+// threads of the batched checks over the time spent in them. Latencies are of the sampled checks, over all threads
+// (they include reading the clock, ~20ns).
+
+#include <GS5.h>
+#include <sdk-test-0/license_data.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace gs;
+
+namespace {
+
+typedef std::chrono::steady_clock clk;
+
+const char *productId = "b5e5cfab-3783-4358-a575-3520d1ef0f7b";
+const char *password = "egsne_3111&IJGN&dcsvo&17332";
+const char *lic_clean = "EZDH-E9E4-KZLZ-GSV3-CI9G-MFH3-ILDB-GW57-4YEP";
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+
+double pct(const std::vector<float> &sorted, double q) {
+    return sorted[std::min(sorted.size() - 1, (size_t)(q * sorted.size()))];
+}
+
+//make() returns the check run by a thread, with its own objects
+template <class TMake> void run(const char *name, TMake make, int threads, int ops, int sampleEvery) {
+    typedef decltype(make()) TFn;
+    std::vector<TFn> fns;
+    std::vector<std::vector<float>> samples(threads);
+    std::vector<double> batchOps(threads), batchSecs(threads);
+    for (int t = 0; t < threads; t++) {
+        fns.push_back(make());
+        samples[t].reserve(ops / sampleEvery + 1);
+    }
+
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::atomic<long> failed(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            TFn &f = fns[t];
+            std::vector<float> &v = samples[t];
+            long fails = 0;
+            long n = 0;
+            clk::duration batched(0);
+            ready++;
+            while (!go.load())
+                ;
+            for (int i = 0; i < ops; i += sampleEvery) {
+                auto t0 = clk::now();
+                if (!f())
+                    fails++;
+                auto t1 = clk::now();
+                v.push_back(std::chrono::duration<float, std::nano>(t1 - t0).count());
+
+                int end = std::min(ops, i + sampleEvery);
+                for (int j = i + 1; j < end; j++) {
+                    if (!f())
+                        fails++;
+                }
+                batched += clk::now() - t1;
+                n += end - i - 1;
+            }
+            batchOps[t] = (double)n;
+            batchSecs[t] = std::chrono::duration<double>(batched).count();
+            failed += fails;
+        });
+    }
+    while (ready.load() < threads)
+        std::this_thread::yield();
+    go = true;
+    for (auto &w : workers)
+        w.join();
+
+    double opsPerSec = 0;
+    std::vector<float> all;
+    for (int t = 0; t < threads; t++) {
+        if (batchSecs[t] > 0)
+            opsPerSec += batchOps[t] / batchSecs[t];
+        all.insert(all.end(), samples[t].begin(), samples[t].end());
+    }
+    std::sort(all.begin(), all.end());
+    printf("%s,%d,%.0f,%.0f,%.0f,%.0f\n", name, threads, opsPerSec, pct(all, 0.5), pct(all, 0.99), pct(all, 0.999));
+    if (failed)
+        fprintf(stderr, "%s: %ld checks failed!\n", name, failed.load());
+}
+
+//runs a check from 1, 2, 4... up to maxThreads threads
+template <class TMake> void runAll(const char *name, TMake make, int maxThreads, int ops, int sampleEvery) {
+    for (int n = 1;; n = std::min(n * 2, maxThreads)) {
+        run(name, make, n, ops, sampleEvery);
+        if (n == maxThreads)
+            break;
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    int ops = 100000;
+    int sampleEvery = 16;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--threads") == 0)
+            maxThreads = std::max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--ops") == 0)
+            ops = std::max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--sample") == 0)
+            sampleEvery = std::max(2, atoi(argv[i + 1]));
+    }
+
+    auto core = TGSCore::getInstance();
+    if (!core->init(productId, sdk_test_0_lic_data_build_4, sizeof(sdk_test_0_lic_data_build_4), password)) {
+        fprintf(stderr, "license cannot be initialized: %s\n", core->lastErrorMessage());
+        return -1;
+    }
+    //e1 must be accessible
+    core->applyLicenseCode(lic_clean);
+    core->applyLicenseCode(lic_e1_unlock);
+
+    printf("check,threads,ops_per_sec,p50_ns,p99_ns,p999_ns\n");
+    runAll("isAccessible", [&] {
+        std::shared_ptr<TGSEntity> e(core->getEntityById(e1_id));
+        return [e] { return e->isAccessible(); };
+    }, maxThreads, ops, sampleEvery);
+    runAll("getParamInt", [&] {
+        std::shared_ptr<TGSEntity> e(core->getEntityById(e1_id));
+        std::shared_ptr<TGSLicense> lic(e->getLicense());
+        return [e, lic] { return lic->getParamInt("rollbackTolerance") == 4000; };
+    }, maxThreads, ops, sampleEvery);
+    runAll("beginAccess/endAccess", [&] {
+        std::shared_ptr<TGSEntity> e(core->getEntityById(e1_id));
+        return [e] { return e->beginAccess() && e->endAccess(); };
+    }, maxThreads, ops, sampleEvery);
+    runAll("getEntityById", [&] {
+        return [core] {
+            std::unique_ptr<TGSEntity> e(core->getEntityById(e1_id));
+            return e != nullptr;
+        };
+    }, maxThreads, ops, sampleEvery);
+    runAll("entityAttributes", [&] {
+        int index = core->entityRegistry()->indexOf(e1_id);
+        return [core, index] { return (core->entityAttributes(index) & ENTITY_ATTRIBUTE_ACCESSIBLE) != 0; };
+    }, maxThreads, ops, sampleEvery);
+
+    core->applyLicenseCode(lic_clean);
+    TGSCore::finish();
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Latency of the first licensing call of a process, depending on how gsCore is loaded
+//
+// usage: first-call [--now] [--prefault] [--warm-up] [runs]
+//
+// Each run is a fresh process (fork) which starts up (sleeps a while, as if initializing), then times
+// its first "request", a few gsCore api calls, and the same request again once everything is loaded.
+//
+// --now, --prefault: load policy (see sdk_set_core_load_policy()), gsCore is loaded lazily by default
+// --warm-up: gsCore is loaded in the background while the process is starting up (see sdk_warm_up())
+
+#include <GS5_Intf.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace gs;
+
+namespace {
+
+typedef std::chrono::steady_clock clk;
+
+const int STARTUP_MS = 50;
+
+double ns_since(clk::time_point t0) {
+    return std::chrono::duration<double, std::nano>(clk::now() - t0).count();
+}
+
+struct TRun {
+    double first;  //first request
+    double steady; //same request, everything loaded
+};
+
+//apis without license state, so only the cost of loading and binding gsCore is measured
+double request() {
+    auto t0 = clk::now();
+    gsGetVersion();
+    gsGetLastErrorCode();
+    gsGetLastErrorMessage();
+    gsIsDebugVersion();
+    return ns_since(t0);
+}
+
+TRun run(int policy, bool warmUp) {
+    sdk_set_core_load_policy(policy);
+    if (warmUp)
+        sdk_warm_up();
+    std::this_thread::sleep_for(std::chrono::milliseconds(STARTUP_MS));
+
+    TRun r;
+    r.first = request();
+    r.steady = request();
+    return r;
+}
+
+double pct(std::vector<double> v, double q) {
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, (size_t)(q * v.size()))];
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int policy = SDK_CORE_LOAD_LAZY;
+    bool warmUp = false;
+    int runs = 20;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--now") == 0)
+            policy |= SDK_CORE_LOAD_NOW;
+        else if (strcmp(argv[i], "--prefault") == 0)
+            policy |= SDK_CORE_LOAD_PREFAULT;
+        else if (strcmp(argv[i], "--warm-up") == 0)
+            warmUp = true;
+        else
+            runs = atoi(argv[i]);
+    }
+
+    std::vector<double> first, steady;
+    for (int i = 0; i < runs; i++) {
+        int fd[2];
+        if (pipe(fd) != 0)
+            return -1;
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fd[0]);
+            TRun r = run(policy, warmUp);
+            ssize_t n = write(fd[1], &r, sizeof(r));
+            _exit(n == sizeof(r) ? 0 : 1);
+        }
+        close(fd[1]);
+        TRun r;
+        ssize_t n = read(fd[0], &r, sizeof(r));
+        close(fd[0]);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (pid < 0 || n != sizeof(r) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "run %d failed!\n", i);
+            return -1;
+        }
+        first.push_back(r.first);
+        steady.push_back(r.steady);
+    }
+
+    printf("policy:%s%s%s, %d runs\n", policy & SDK_CORE_LOAD_NOW ? " now" : " lazy", policy & SDK_CORE_LOAD_PREFAULT ? " prefault" : "",
+           warmUp ? " warm-up" : "", runs);
+    printf("%-16s %12s %12s\n", "", "p50(ns)", "p90(ns)");
+    printf("%-16s %12.0f %12.0f\n", "first request", pct(first, 0.5), pct(first, 0.9));
+    printf("%-16s %12.0f %12.0f\n", "steady request", pct(steady, 0.5), pct(steady, 0.9));
+    return 0;
+}
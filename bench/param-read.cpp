@@ -0,0 +1,120 @@
+// Cost of reading a license parameter: heap-allocated TGSVariable vs. value objects, ParamRef and TLicenseModel
+//
+// usage: param-read [iterations]
+//
+// Heap allocations are counted by replacing the global operator new, which an in-process core (the stub core) calls
+// as well. The sdk allocations of a read are the ones left after subtracting those of the same gsCore calls made
+// directly through the C api (core allocs/read).
+
+#include <GS5_LM.h>
+#include <sdk-test-0/license_data.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+using namespace gs;
+
+namespace {
+std::atomic<long> s_allocs(0);
+} // namespace
+
+void *operator new(std::size_t size) {
+    s_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, std::size_t) noexcept { free(p); }
+
+namespace {
+
+typedef std::chrono::steady_clock clk;
+
+const char *productId = "b5e5cfab-3783-4358-a575-3520d1ef0f7b";
+const char *password = "egsne_3111&IJGN&dcsvo&17332";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+
+//allocations per call of f, made by gsCore
+template <typename F>
+double coreAllocs(long n, F f) {
+    long allocs = s_allocs.load();
+    for (long i = 0; i < n; i++)
+        f();
+    return (double)(s_allocs.load() - allocs) / n;
+}
+
+template <typename F>
+void measure(const char *name, long n, double core, F f) {
+    long sum = 0;
+    long allocs = s_allocs.load();
+    auto t0 = clk::now();
+    for (long i = 0; i < n; i++)
+        sum += f();
+    double ns = std::chrono::duration<double, std::nano>(clk::now() - t0).count() / n;
+    double perRead = (double)(s_allocs.load() - allocs) / n;
+    printf("%-32s %10.1f ns/read %8.2f allocs/read %8.2f sdk allocs/read\n", name, ns, perRead, perRead - core);
+    if (sum != 4000L * n)
+        fprintf(stderr, "%s: unexpected value!\n", name);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    long N = argc > 1 ? atol(argv[1]) : 1000000;
+
+    auto core = TGSCore::getInstance();
+    if (!core->init(productId, sdk_test_0_lic_data_build_4, sizeof(sdk_test_0_lic_data_build_4), password)) {
+        fprintf(stderr, "license cannot be initialized: %s\n", core->lastErrorMessage());
+        return -1;
+    }
+
+    std::unique_ptr<TGSEntity> entity(core->getEntityById(e1_id));
+    std::unique_ptr<TGSLicense> lic(entity->getLicense());
+    License license = core->entity(e1_id).license();
+
+    //the gsCore calls of a read by name, of a held variable and of a missing parameter
+    TLicenseHandle hLic = license.handle();
+    double byName = coreAllocs(N / 10, [&] {
+        TVarHandle h = gsGetLicenseParamByName(hLic, "rollbackTolerance");
+        int v = 0;
+        gsGetVariableValueAsInt(h, v);
+        gsCloseHandle(h);
+    });
+    double missing = coreAllocs(N / 10, [&] { gsGetLicenseParamByName(hLic, "noSuchParam"); });
+    printf("core allocs/read: %.2f by name, %.2f missing, 0 held\n", byName, missing);
+
+    measure("TGSVariable (heap)", N, byName, [&] {
+        std::unique_ptr<TGSVariable> var(lic->getParamByName("rollbackTolerance"));
+        return var->asInt();
+    });
+    measure("TGSLicense::getParamInt()", N, byName, [&] { return lic->getParamInt("rollbackTolerance"); });
+    measure("License::getParamInt()", N, byName, [&] { return license.getParamInt("rollbackTolerance"); });
+
+    Variable var = license.param("rollbackTolerance");
+    measure("Variable::asInt()", N, 0, [&] { return var.asInt(); });
+
+    ParamRef<int> ref(license, "rollbackTolerance");
+    measure("ParamRef<int>::get()", N, 0, [&] { return ref.get(); });
+
+    TLicenseModel<lm::HardDate> hd(license);
+    measure("TLicenseModel<HardDate>::get()", N, 0, [&] { return hd.get<lm::HardDate::rollbackTolerance>(); });
+
+    //a missing parameter, defaulted to the expected value
+    measure("missing, getParamInt() + catch", N / 10, missing, [&] {
+        try {
+            return license.getParamInt("noSuchParam");
+        } catch (gs5_error &) {
+            return 4000;
+        }
+    });
+    measure("missing, tryGetParamInt()", N, missing, [&] { return license.tryGetParamInt("noSuchParam").value_or(4000); });
+
+    TGSCore::finish();
+    return 0;
+}
@@ -4,11 +4,18 @@
 #include <Windows.h>
 #endif
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 
 namespace gs {
 
+//ordinals of the apis not exported by older cores (ref: GS5_Intf.cpp)
+static const int ORD_RENDER_HTML_EX = 83;
+static const int ORD_APPLY_LICENSE_CODE_EX = 158;
+
 //************** gs5_error *******************
 #ifdef _MSC_VER
 gs5_error::gs5_error(const char *msg, int code) : std::exception(msg), _code(code) {}
@@ -37,95 +44,252 @@ TGSObject::TGSObject(gs_handle_t handle) : _handle(handle) {
 };
 TGSObject::~TGSObject() { gsCloseHandle(_handle); }
 
-//***************** TGSVariable *****************
-//--- Static helpers ---
-//
-const char *TGSVariable::getTypeName(var_type_t varType) {
-    return gsVariableTypeToString(varType);
-};
+//***************** gs_errc ***********************
+const char *gs_errc_message(gs_errc e) {
+    switch (e) {
+    case gs_errc::ok:
+        return "Success";
+    case gs_errc::invalid_handle:
+        return "Invalid handle";
+    case gs_errc::invalid_index:
+        return "Index out of range";
+    case gs_errc::invalid_name:
+        return "Invalid name";
+    case gs_errc::invalid_action:
+        return "Invalid action";
+    case gs_errc::invalid_license:
+        return "Invalid license";
+    case gs_errc::invalid_entity:
+        return "Invalid entity";
+    case gs_errc::invalid_value:
+        return "Invalid value";
+    default:
+        return "Generic error";
+    }
+}
 
-//Permission conversion helpers
-int TGSVariable::AttrFromString(const char *permitStr) {
-    return gsVariableAttrFromString(permitStr);
-};
-std::string TGSVariable::AttrToString(int permit) {
-    char Result[32];
-    return gsVariableAttrToString(permit, Result, 32);
-};
+//***************** Handle helpers *****************
+//shared by the TGSObject subclasses and the value objects
+namespace {
 
-//Setter
-void TGSVariable::fromString(const char *v) {
-    if (!gsSetVariableValueFromString(_handle, v))
-        throw gs5_error("String conversion error", GS_ERROR_INVALID_VALUE);
+//Variable value, non-throwing
+template <typename T, bool (*get)(TVarHandle, T &)>
+expected<T> varAs(TVarHandle h) {
+    T Result;
+    if (!get(h, Result))
+        return gs_errc::invalid_value;
+    return Result;
 }
-void TGSVariable::fromInt(int v) {
-    if (!gsSetVariableValueFromInt(_handle, v))
-        throw gs5_error("Int conversion error", GS_ERROR_INVALID_VALUE);
+expected<int> tryVarAsInt(TVarHandle h) { return varAs<int, gsGetVariableValueAsInt>(h); }
+expected<int64_t> tryVarAsInt64(TVarHandle h) { return varAs<int64_t, gsGetVariableValueAsInt64>(h); }
+expected<float> tryVarAsFloat(TVarHandle h) { return varAs<float, gsGetVariableValueAsFloat>(h); }
+expected<double> tryVarAsDouble(TVarHandle h) { return varAs<double, gsGetVariableValueAsDouble>(h); }
+expected<time_t> tryVarAsUTCTime(TVarHandle h) { return varAs<time_t, gsGetVariableValueAsTime>(h); }
+
+template <typename T, bool (*set)(TVarHandle, T)>
+expected<void> varFrom(TVarHandle h, T v) {
+    if (!set(h, v))
+        return gs_errc::invalid_value;
+    return expected<void>();
+}
+expected<void> tryVarFromString(TVarHandle h, const char *v) { return varFrom<const char *, gsSetVariableValueFromString>(h, v); }
+expected<void> tryVarFromInt(TVarHandle h, int v) { return varFrom<int, gsSetVariableValueFromInt>(h, v); }
+expected<void> tryVarFromInt64(TVarHandle h, int64_t v) { return varFrom<int64_t, gsSetVariableValueFromInt64>(h, v); }
+expected<void> tryVarFromFloat(TVarHandle h, float v) { return varFrom<float, gsSetVariableValueFromFloat>(h, v); }
+expected<void> tryVarFromDouble(TVarHandle h, double v) { return varFrom<double, gsSetVariableValueFromDouble>(h, v); }
+expected<void> tryVarFromUTCTime(TVarHandle h, time_t t) { return varFrom<time_t, gsSetVariableValueFromTime>(h, t); }
+
+//Variable value, raise gs5_error on conversion error
+template <typename T>
+T checked(const expected<T> &r, const char *what) {
+    if (!r)
+        throw gs5_error(what, GS_ERROR_INVALID_VALUE);
+    return *r;
+}
+void checked(const expected<void> &r, const char *what) {
+    if (!r)
+        throw gs5_error(what, GS_ERROR_INVALID_VALUE);
+}
+
+const char *varAsString(TVarHandle h) {
+    return gsGetVariableValueAsString(h);
+}
+int varAsInt(TVarHandle h) { return checked(tryVarAsInt(h), "Int conversion error"); }
+int64_t varAsInt64(TVarHandle h) { return checked(tryVarAsInt64(h), "Int64 conversion error"); }
+float varAsFloat(TVarHandle h) { return checked(tryVarAsFloat(h), "Float conversion error"); }
+double varAsDouble(TVarHandle h) { return checked(tryVarAsDouble(h), "Double conversion error"); }
+time_t varAsUTCTime(TVarHandle h) { return checked(tryVarAsUTCTime(h), "Time conversion error"); }
+
+void varFromString(TVarHandle h, const char *v) { checked(tryVarFromString(h, v), "String conversion error"); }
+void varFromInt(TVarHandle h, int v) { checked(tryVarFromInt(h, v), "Int conversion error"); }
+void varFromInt64(TVarHandle h, int64_t v) { checked(tryVarFromInt64(h, v), "Int64 conversion error"); }
+void varFromFloat(TVarHandle h, float v) { checked(tryVarFromFloat(h, v), "Float conversion error"); }
+void varFromDouble(TVarHandle h, double v) { checked(tryVarFromDouble(h, v), "Double conversion error"); }
+void varFromUTCTime(TVarHandle h, time_t t) { checked(tryVarFromUTCTime(h, t), "Time conversion error"); }
+
+//Object lookups, non-throwing
+expected<TVarHandle> tryActionParam(TActionHandle hAct, int index) {
+    if ((index < 0) || (index >= gsGetActionParamCount(hAct)))
+        return gs_errc::invalid_index;
+    return gsGetActionParamByIndex(hAct, index);
+}
+expected<TVarHandle> tryActionParam(TActionHandle hAct, const char *name) {
+    gs_handle_t h = gsGetActionParamByName(hAct, name);
+    if (h == INVALID_GS_HANDLE)
+        return gs_errc::invalid_name;
+    return h;
 }
-void TGSVariable::fromInt64(int64_t v) {
-    if (!gsSetVariableValueFromInt64(_handle, v))
-        throw gs5_error("Int64 conversion error", GS_ERROR_INVALID_VALUE);
+
+expected<TVarHandle> tryLicenseParam(TLicenseHandle hLic, int index) {
+    if ((index < 0) || (index >= gsGetLicenseParamCount(hLic)))
+        return gs_errc::invalid_index;
+    return gsGetLicenseParamByIndex(hLic, index);
 }
-void TGSVariable::fromFloat(float v) {
-    if (!gsSetVariableValueFromFloat(_handle, v))
-        throw gs5_error("Float conversion error", GS_ERROR_INVALID_VALUE);
+expected<TVarHandle> tryLicenseParam(TLicenseHandle hLic, const char *name) {
+    gs_handle_t h = gsGetLicenseParamByName(hLic, name);
+    if (h == INVALID_GS_HANDLE)
+        return gs_errc::invalid_name;
+    return h;
 }
-void TGSVariable::fromDouble(double v) {
-    if (!gsSetVariableValueFromDouble(_handle, v))
-        throw gs5_error("Double conversion error", GS_ERROR_INVALID_VALUE);
+
+expected<TActionHandle> tryRequestAction(TRequestHandle hReq, action_id_t actId, const char *entityId) {
+    gs_handle_t h = gsAddRequestActionEx(hReq, actId, entityId, NULL);
+    if (h == INVALID_GS_HANDLE)
+        return gs_errc::invalid_action;
+    return h;
 }
-void TGSVariable::fromUTCTime(time_t t) {
-    if (!gsSetVariableValueFromTime(_handle, t))
-        throw gs5_error("Time conversion error", GS_ERROR_INVALID_VALUE);
+
+expected<TLicenseHandle> tryEntityLicense(TEntityHandle hEntity) {
+    gs_handle_t h = gsOpenLicense(hEntity);
+    if (h == INVALID_GS_HANDLE)
+        return gs_errc::invalid_license;
+    return h;
 }
 
-//Getter
-const char *TGSVariable::asString() {
-    return gsGetVariableValueAsString(_handle);
+expected<TEntityHandle> tryEntityByIndex(int index) {
+    if ((index < 0) || (index >= gsGetEntityCount()))
+        return gs_errc::invalid_index;
+    return gsOpenEntityByIndex(index);
+}
+expected<TVarHandle> tryVariableByIndex(int index) {
+    if ((index < 0) || (index >= gsGetTotalVariables()))
+        return gs_errc::invalid_index;
+    gs_handle_t h = gsGetVariableByIndex(index);
+    if (h == INVALID_GS_HANDLE)
+        return gs_errc::invalid_index;
+    return h;
+}
+expected<TEntityHandle> tryEntityById(entity_id_t entityId) {
+    gs_handle_t h = gsOpenEntityById(entityId);
+    if (h == INVALID_GS_HANDLE)
+        return gs_errc::invalid_entity;
+    return h;
 }
 
-int TGSVariable::asInt() {
-    int Result;
-    if (!gsGetVariableValueAsInt(_handle, Result))
-        throw gs5_error("Int conversion error", GS_ERROR_INVALID_VALUE);
-    return Result;
+//Object lookups, raise gs5_error if not found
+TVarHandle actionParam(TActionHandle hAct, int index) {
+    expected<TVarHandle> h = tryActionParam(hAct, index);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_INDEX, "Index [%d] out of range [0, %d)", index, gsGetActionParamCount(hAct));
+    return *h;
+}
+TVarHandle actionParam(TActionHandle hAct, const char *name) {
+    expected<TVarHandle> h = tryActionParam(hAct, name);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_NAME, "Invalid Param Name [%s]", name);
+    return *h;
 }
 
-bool TGSVariable::asBool() {
-    return asInt() != 0;
+TVarHandle licenseParam(TLicenseHandle hLic, int index) {
+    expected<TVarHandle> h = tryLicenseParam(hLic, index);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_INDEX, "Index [%d] out of range [0, %d)", index, gsGetLicenseParamCount(hLic));
+    return *h;
+}
+TVarHandle licenseParam(TLicenseHandle hLic, const char *name) {
+    expected<TVarHandle> h = tryLicenseParam(hLic, name);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_NAME, "Invalid Param Name [%s]", name);
+    return *h;
 }
 
-void TGSVariable::fromBool(bool v) {
-    this->fromInt(v ? 1 : 0);
+TActionHandle requestAction(TRequestHandle hReq, action_id_t actId, const char *entityId) {
+    expected<TActionHandle> h = tryRequestAction(hReq, actId, entityId);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_ACTION, "Invalid action (actId = %d)", actId);
+    return *h;
 }
 
-int64_t TGSVariable::asInt64() {
-    int64_t Result;
-    if (!gsGetVariableValueAsInt64(_handle, Result))
-        throw gs5_error("Int64 conversion error", GS_ERROR_INVALID_VALUE);
-    return Result;
+TLicenseHandle entityLicense(TEntityHandle hEntity) {
+    expected<TLicenseHandle> h = tryEntityLicense(hEntity);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_LICENSE, "No License Bundled to entity[%s]", gsGetEntityName(hEntity));
+    return *h;
 }
 
-float TGSVariable::asFloat() {
-    float Result;
-    if (!gsGetVariableValueAsFloat(_handle, Result))
-        throw gs5_error("Float conversion error", GS_ERROR_INVALID_VALUE);
-    return Result;
+TEntityHandle entityByIndex(int index) {
+    expected<TEntityHandle> h = tryEntityByIndex(index);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_INDEX, "Index [%d] out of range [0, %d)", index, gsGetEntityCount());
+    return *h;
+}
+TEntityHandle entityById(entity_id_t entityId) {
+    expected<TEntityHandle> h = tryEntityById(entityId);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_ENTITY, "Invalid EntityId (%s)", entityId);
+    return *h;
 }
 
-double TGSVariable::asDouble() {
-    double Result;
-    if (!gsGetVariableValueAsDouble(_handle, Result))
-        throw gs5_error("Double conversion error", GS_ERROR_INVALID_VALUE);
-    return Result;
+TVarHandle variableByIndex(int index) {
+    expected<TVarHandle> h = tryVariableByIndex(index);
+    if (!h)
+        gs5_error::raise(GS_ERROR_INVALID_INDEX, "Invalid Variable Index [%d]", index);
+    return *h;
 }
-time_t TGSVariable::asUTCTime() {
-    time_t Result;
-    if (!gsGetVariableValueAsTime(_handle, Result))
-        throw gs5_error("Time conversion error", GS_ERROR_INVALID_VALUE);
-    return Result;
+
+template <typename T>
+expected<T> wrap(const expected<gs_handle_t> &h) {
+    if (!h)
+        return h.error();
+    return T(*h);
 }
 
+} // namespace
+
+//***************** TGSVariable *****************
+//--- Static helpers ---
+//
+const char *TGSVariable::getTypeName(var_type_t varType) {
+    return gsVariableTypeToString(varType);
+};
+
+//Permission conversion helpers
+int TGSVariable::AttrFromString(const char *permitStr) {
+    return gsVariableAttrFromString(permitStr);
+};
+std::string TGSVariable::AttrToString(int permit) {
+    char Result[32];
+    return gsVariableAttrToString(permit, Result, 32);
+};
+
+//Setter
+void TGSVariable::fromString(const char *v) { varFromString(_handle, v); }
+void TGSVariable::fromInt(int v) { varFromInt(_handle, v); }
+void TGSVariable::fromInt64(int64_t v) { varFromInt64(_handle, v); }
+void TGSVariable::fromFloat(float v) { varFromFloat(_handle, v); }
+void TGSVariable::fromDouble(double v) { varFromDouble(_handle, v); }
+void TGSVariable::fromUTCTime(time_t t) { varFromUTCTime(_handle, t); }
+void TGSVariable::fromBool(bool v) { varFromInt(_handle, v ? 1 : 0); }
+
+//Getter
+const char *TGSVariable::asString() { return varAsString(_handle); }
+int TGSVariable::asInt() { return varAsInt(_handle); }
+bool TGSVariable::asBool() { return varAsInt(_handle) != 0; }
+int64_t TGSVariable::asInt64() { return varAsInt64(_handle); }
+float TGSVariable::asFloat() { return varAsFloat(_handle); }
+double TGSVariable::asDouble() { return varAsDouble(_handle); }
+time_t TGSVariable::asUTCTime() { return varAsUTCTime(_handle); }
+
 //Properties
 const char *TGSVariable::name() { return gsGetVariableName(_handle); }
 var_type_t TGSVariable::typeId() { return gsGetVariableType(_handle); }
@@ -175,11 +339,7 @@ TGSVariable *TGSAction::getParamByIndex(int index) {
 }
 
 TGSVariable *TGSAction::getParamByName(const char *name) {
-    gs_handle_t h = gsGetActionParamByName(_handle, name);
-    if (h == INVALID_GS_HANDLE)
-        gs5_error::raise(GS_ERROR_INVALID_NAME, "Invalid Param Name [%s]", name);
-
-    return new TGSVariable(h);
+    return new TGSVariable(actionParam(_handle, name));
 }
 //Properties
 const char *TGSAction::name() {
@@ -204,88 +364,73 @@ int TGSAction::paramCount() {
 bool TGSLicense::bindToEntity(TGSEntity *entity) {
     if (gsBindLicense(entity->handle(), this->handle())) {
         _licensedEntity = entity;
+        TGSCore::getInstance()->invalidateRequestCodes();
         return true;
     } else
         return false;
 }
 
 TGSVariable *TGSLicense::getParamByIndex(int index) {
-    if ((index >= 0) && (index < paramCount())) {
-        return new TGSVariable(gsGetLicenseParamByIndex(_handle, index));
-    }
-    gs5_error::raise(GS_ERROR_INVALID_INDEX, "Index [%d] out of range [0, %d)", index, paramCount());
+    return new TGSVariable(licenseParam(_handle, index));
 }
 
 TGSVariable *TGSLicense::getParamByName(const char *name) {
-    gs_handle_t h = gsGetLicenseParamByName(_handle, name);
-    if (h != INVALID_GS_HANDLE)
-        return new TGSVariable(h);
-
-    gs5_error::raise(GS_ERROR_INVALID_NAME, "Invalid Param Name [%s]", name);
+    return new TGSVariable(licenseParam(_handle, name));
 }
 
+//the parameter helpers read through a stack-allocated Variable
+
 std::string TGSLicense::getParamStr(const char *name) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    return var->asString();
+    return Variable(licenseParam(_handle, name)).asString();
+}
+string_view TGSLicense::getParamStrView(const char *name) {
+    return Variable(licenseParam(_handle, name)).asStringView();
 }
 void TGSLicense::setParamStr(const char *name, const char *v) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    var->fromString(v);
+    Variable(licenseParam(_handle, name)).fromString(v);
 }
 
 int TGSLicense::getParamInt(const char *name) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    return var->asInt();
+    return Variable(licenseParam(_handle, name)).asInt();
 }
 
 void TGSLicense::setParamInt(const char *name, int v) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    var->fromInt(v);
+    Variable(licenseParam(_handle, name)).fromInt(v);
 }
 
 int64_t TGSLicense::getParamInt64(const char *name) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    return var->asInt64();
+    return Variable(licenseParam(_handle, name)).asInt64();
 }
 void TGSLicense::setParamInt64(const char *name, int64_t v) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    var->fromInt64(v);
+    Variable(licenseParam(_handle, name)).fromInt64(v);
 }
 
 bool TGSLicense::getParamBool(const char *name) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    return var->asBool();
+    return Variable(licenseParam(_handle, name)).asBool();
 }
 void TGSLicense::setParamBool(const char *name, bool v) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    var->fromBool(v);
+    Variable(licenseParam(_handle, name)).fromBool(v);
 }
 
 float TGSLicense::getParamFloat(const char *name) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    return var->asFloat();
+    return Variable(licenseParam(_handle, name)).asFloat();
 }
 void TGSLicense::setParamFloat(const char *name, float v) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    var->fromFloat(v);
+    Variable(licenseParam(_handle, name)).fromFloat(v);
 }
 
 double TGSLicense::getParamDouble(const char *name) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    return var->asDouble();
+    return Variable(licenseParam(_handle, name)).asDouble();
 }
 void TGSLicense::setParamDouble(const char *name, double v) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    var->fromDouble(v);
+    Variable(licenseParam(_handle, name)).fromDouble(v);
 }
 
 time_t TGSLicense::getParamUTCTime(const char *name) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    return var->asUTCTime();
+    return Variable(licenseParam(_handle, name)).asUTCTime();
 }
 void TGSLicense::setParamUTCTime(const char *name, time_t v) {
-    std::unique_ptr<TGSVariable> var(params(name));
-    var->fromUTCTime(v);
+    Variable(licenseParam(_handle, name)).fromUTCTime(v);
 }
 
 //Properties
@@ -311,6 +456,7 @@ bool TGSLicense::isValid() {
 
 void TGSLicense::lock() {
     gsLockLicense(_handle);
+    TGSCore::getInstance()->invalidateRequestCodes();
 }
 
 TGSEntity *TGSLicense::licensedEntity() {
@@ -318,9 +464,7 @@ TGSEntity *TGSLicense::licensedEntity() {
 }
 
 std::string TGSLicense::getUnlockRequestCode() {
-    std::unique_ptr<TGSRequest> req(TGSCore::getInstance()->createRequest());
-    std::unique_ptr<TGSAction> act(req->addAction(ACT_UNLOCK, this->_licensedEntity));
-    return req->code();
+    return TGSCore::getInstance()->requestCode(ACT_UNLOCK, _licensedEntity->id());
 }
 
 int TGSLicense::paramCount() {
@@ -361,11 +505,7 @@ TGSAction *TGSRequest::addAction(action_id_t actId, TGSEntity *entity) {
 }
 
 TGSAction *TGSRequest::addAction(action_id_t actId, const char *entityId) {
-    gs_handle_t h = gsAddRequestActionEx(_handle, actId, entityId, NULL);
-    if (h != INVALID_GS_HANDLE)
-        return new TGSAction(h);
-
-    gs5_error::raise(GS_ERROR_INVALID_ACTION, "Invalid action (actId = %d)", actId);
+    return new TGSAction(requestAction(_handle, actId, entityId));
 }
 
 const char *TGSRequest::code() {
@@ -381,9 +521,7 @@ bool TGSEntity::endAccess() {
 }
 
 std::string TGSEntity::getUnlockRequestCode() {
-    std::unique_ptr<TGSRequest> req(TGSCore::getInstance()->createRequest());
-    std::unique_ptr<TGSAction> act(req->addAction(ACT_UNLOCK, this));
-    return req->code();
+    return TGSCore::getInstance()->requestCode(ACT_UNLOCK, id());
 }
 
 bool TGSEntity::hasLicense() {
@@ -391,11 +529,7 @@ bool TGSEntity::hasLicense() {
 }
 
 TGSLicense *TGSEntity::getLicense() {
-    gs_handle_t h = gsOpenLicense(_handle);
-    if (h == INVALID_GS_HANDLE)
-        gs5_error::raise(GS_ERROR_INVALID_LICENSE, "No License Bundled to entity[%s]", name());
-
-    return new TGSLicense(h, this);
+    return new TGSLicense(entityLicense(_handle), this);
 }
 //Properties
 unsigned int TGSEntity::attribute() {
@@ -418,6 +552,1064 @@ void TGSEntity::lock() {
     }
 }
 
+//************** Value objects *******************
+
+//Variable
+void Variable::fromString(const char *v) { varFromString(_handle, v); }
+void Variable::fromInt(int v) { varFromInt(_handle, v); }
+void Variable::fromBool(bool v) { varFromInt(_handle, v ? 1 : 0); }
+void Variable::fromInt64(int64_t v) { varFromInt64(_handle, v); }
+void Variable::fromFloat(float v) { varFromFloat(_handle, v); }
+void Variable::fromDouble(double v) { varFromDouble(_handle, v); }
+void Variable::fromUTCTime(time_t t) { varFromUTCTime(_handle, t); }
+
+const char *Variable::asString() const { return varAsString(_handle); }
+int Variable::asInt() const { return varAsInt(_handle); }
+bool Variable::asBool() const { return varAsInt(_handle) != 0; }
+int64_t Variable::asInt64() const { return varAsInt64(_handle); }
+float Variable::asFloat() const { return varAsFloat(_handle); }
+double Variable::asDouble() const { return varAsDouble(_handle); }
+time_t Variable::asUTCTime() const { return varAsUTCTime(_handle); }
+
+const char *Variable::name() const { return gsGetVariableName(_handle); }
+var_type_t Variable::typeId() const { return gsGetVariableType(_handle); }
+std::string Variable::attribute() const { return TGSVariable::AttrToString(gsGetVariableAttr(_handle)); }
+
+//Action
+const char *Action::name() const { return gsGetActionName(_handle); }
+action_id_t Action::id() const { return gsGetActionId(_handle); }
+const char *Action::description() const { return gsGetActionDescription(_handle); }
+const char *Action::whatToDo() const { return gsGetActionString(_handle); }
+
+int Action::paramCount() const { return gsGetActionParamCount(_handle); }
+Variable Action::param(int index) const { return Variable(actionParam(_handle, index)); }
+Variable Action::param(const char *name) const { return Variable(actionParam(_handle, name)); }
+
+//License
+const char *License::id() const { return gsGetLicenseId(_handle); }
+const char *License::name() const { return gsGetLicenseName(_handle); }
+const char *License::description() const { return gsGetLicenseDescription(_handle); }
+TLicenseStatus License::status() const { return gsGetLicenseStatus(_handle); }
+bool License::isValid() const { return gsIsLicenseValid(_handle); }
+void License::lock() {
+    gsLockLicense(_handle);
+    TGSCore::getInstance()->invalidateRequestCodes();
+}
+
+Entity License::entity() const { return Entity(gsGetLicensedEntity(_handle)); }
+
+std::string License::getUnlockRequestCode() const {
+    return TGSCore::getInstance()->requestCode(ACT_UNLOCK, entity().id());
+}
+
+Request License::unlockRequest() const {
+    Entity target = entity();
+    Request req = TGSCore::getInstance()->request();
+    Action act = req.addAction(ACT_UNLOCK, target);
+    return req;
+}
+
+int License::paramCount() const { return gsGetLicenseParamCount(_handle); }
+Variable License::param(int index) const { return Variable(licenseParam(_handle, index)); }
+Variable License::param(const char *name) const { return Variable(licenseParam(_handle, name)); }
+
+std::string License::getParamStr(const char *name) const { return param(name).asString(); }
+string_view License::getParamStrView(const char *name) const { return param(name).asStringView(); }
+void License::setParamStr(const char *name, const char *v) { param(name).fromString(v); }
+int License::getParamInt(const char *name) const { return param(name).asInt(); }
+void License::setParamInt(const char *name, int v) { param(name).fromInt(v); }
+int64_t License::getParamInt64(const char *name) const { return param(name).asInt64(); }
+void License::setParamInt64(const char *name, int64_t v) { param(name).fromInt64(v); }
+bool License::getParamBool(const char *name) const { return param(name).asBool(); }
+void License::setParamBool(const char *name, bool v) { param(name).fromBool(v); }
+double License::getParamDouble(const char *name) const { return param(name).asDouble(); }
+void License::setParamDouble(const char *name, double v) { param(name).fromDouble(v); }
+float License::getParamFloat(const char *name) const { return param(name).asFloat(); }
+void License::setParamFloat(const char *name, float v) { param(name).fromFloat(v); }
+time_t License::getParamUTCTime(const char *name) const { return param(name).asUTCTime(); }
+void License::setParamUTCTime(const char *name, time_t v) { param(name).fromUTCTime(v); }
+
+int License::actionCount() const { return gsGetActionInfoCount(_handle); }
+action_id_t License::actionIds(int index) const {
+    action_id_t Result;
+    gsGetActionInfoByIndex(_handle, index, &Result);
+    return Result;
+}
+const char *License::actionNames(int index) const {
+    action_id_t dummy;
+    return gsGetActionInfoByIndex(_handle, index, &dummy);
+}
+
+//Request
+Action Request::addAction(action_id_t actId) { return Action(requestAction(_handle, actId, NULL)); }
+Action Request::addAction(action_id_t actId, const Entity &entity) { return Action(requestAction(_handle, actId, entity.id())); }
+Action Request::addAction(action_id_t actId, const char *entityId) { return Action(requestAction(_handle, actId, entityId)); }
+const char *Request::code() const { return gsGetRequestCode(_handle); }
+
+//Entity
+bool Entity::beginAccess() { return gsBeginAccessEntity(_handle); }
+bool Entity::endAccess() { return gsEndAccessEntity(_handle); }
+
+void Entity::lock() {
+    if (hasLicense())
+        license().lock();
+}
+
+std::string Entity::getUnlockRequestCode() const {
+    return TGSCore::getInstance()->requestCode(ACT_UNLOCK, id());
+}
+
+Request Entity::unlockRequest() const {
+    Request req = TGSCore::getInstance()->request();
+    Action act = req.addAction(ACT_UNLOCK, *this);
+    return req;
+}
+
+unsigned int Entity::attribute() const { return gsGetEntityAttributes(_handle); }
+const char *Entity::id() const { return gsGetEntityId(_handle); }
+const char *Entity::name() const { return gsGetEntityName(_handle); }
+const char *Entity::description() const { return gsGetEntityDescription(_handle); }
+
+bool Entity::hasLicense() const { return gsHasLicense(_handle); }
+License Entity::license() const { return License(entityLicense(_handle)); }
+
+//************** Value objects, non-throwing *******
+
+//Variable
+expected<void> Variable::tryFromString(const char *v) { return tryVarFromString(_handle, v); }
+expected<void> Variable::tryFromInt(int v) { return tryVarFromInt(_handle, v); }
+expected<void> Variable::tryFromBool(bool v) { return tryVarFromInt(_handle, v ? 1 : 0); }
+expected<void> Variable::tryFromInt64(int64_t v) { return tryVarFromInt64(_handle, v); }
+expected<void> Variable::tryFromFloat(float v) { return tryVarFromFloat(_handle, v); }
+expected<void> Variable::tryFromDouble(double v) { return tryVarFromDouble(_handle, v); }
+expected<void> Variable::tryFromUTCTime(time_t t) { return tryVarFromUTCTime(_handle, t); }
+
+expected<int> Variable::tryAsInt() const { return tryVarAsInt(_handle); }
+expected<bool> Variable::tryAsBool() const {
+    expected<int> v = tryVarAsInt(_handle);
+    if (!v)
+        return v.error();
+    return *v != 0;
+}
+expected<int64_t> Variable::tryAsInt64() const { return tryVarAsInt64(_handle); }
+expected<float> Variable::tryAsFloat() const { return tryVarAsFloat(_handle); }
+expected<double> Variable::tryAsDouble() const { return tryVarAsDouble(_handle); }
+expected<time_t> Variable::tryAsUTCTime() const { return tryVarAsUTCTime(_handle); }
+
+//Action
+expected<Variable> Action::tryParam(int index) const { return wrap<Variable>(tryActionParam(_handle, index)); }
+expected<Variable> Action::tryParam(const char *name) const { return wrap<Variable>(tryActionParam(_handle, name)); }
+
+//License
+expected<Variable> License::tryParam(int index) const { return wrap<Variable>(tryLicenseParam(_handle, index)); }
+expected<Variable> License::tryParam(const char *name) const { return wrap<Variable>(tryLicenseParam(_handle, name)); }
+
+//reads / writes a parameter through a stack-allocated Variable
+namespace {
+template <typename T, expected<T> (Variable::*get)() const>
+expected<T> getParam(TLicenseHandle hLic, const char *name) {
+    expected<TVarHandle> h = tryLicenseParam(hLic, name);
+    if (!h)
+        return h.error();
+    return (Variable(*h).*get)();
+}
+template <typename T, expected<void> (Variable::*set)(T)>
+expected<void> setParam(TLicenseHandle hLic, const char *name, T v) {
+    expected<TVarHandle> h = tryLicenseParam(hLic, name);
+    if (!h)
+        return h.error();
+    Variable var(*h);
+    return (var.*set)(v);
+}
+} // namespace
+
+expected<std::string> License::tryGetParamStr(const char *name) const {
+    expected<TVarHandle> h = tryLicenseParam(_handle, name);
+    if (!h)
+        return h.error();
+    return std::string(Variable(*h).asString());
+}
+expected<void> License::trySetParamStr(const char *name, const char *v) { return setParam<const char *, &Variable::tryFromString>(_handle, name, v); }
+expected<int> License::tryGetParamInt(const char *name) const { return getParam<int, &Variable::tryAsInt>(_handle, name); }
+expected<void> License::trySetParamInt(const char *name, int v) { return setParam<int, &Variable::tryFromInt>(_handle, name, v); }
+expected<int64_t> License::tryGetParamInt64(const char *name) const { return getParam<int64_t, &Variable::tryAsInt64>(_handle, name); }
+expected<void> License::trySetParamInt64(const char *name, int64_t v) { return setParam<int64_t, &Variable::tryFromInt64>(_handle, name, v); }
+expected<bool> License::tryGetParamBool(const char *name) const { return getParam<bool, &Variable::tryAsBool>(_handle, name); }
+expected<void> License::trySetParamBool(const char *name, bool v) { return setParam<bool, &Variable::tryFromBool>(_handle, name, v); }
+expected<double> License::tryGetParamDouble(const char *name) const { return getParam<double, &Variable::tryAsDouble>(_handle, name); }
+expected<void> License::trySetParamDouble(const char *name, double v) { return setParam<double, &Variable::tryFromDouble>(_handle, name, v); }
+expected<float> License::tryGetParamFloat(const char *name) const { return getParam<float, &Variable::tryAsFloat>(_handle, name); }
+expected<void> License::trySetParamFloat(const char *name, float v) { return setParam<float, &Variable::tryFromFloat>(_handle, name, v); }
+expected<time_t> License::tryGetParamUTCTime(const char *name) const { return getParam<time_t, &Variable::tryAsUTCTime>(_handle, name); }
+expected<void> License::trySetParamUTCTime(const char *name, time_t v) { return setParam<time_t, &Variable::tryFromUTCTime>(_handle, name, v); }
+
+//Request
+expected<Action> Request::tryAddAction(action_id_t actId) { return wrap<Action>(tryRequestAction(_handle, actId, NULL)); }
+expected<Action> Request::tryAddAction(action_id_t actId, const Entity &entity) { return wrap<Action>(tryRequestAction(_handle, actId, entity.id())); }
+expected<Action> Request::tryAddAction(action_id_t actId, const char *entityId) { return wrap<Action>(tryRequestAction(_handle, actId, entityId)); }
+
+//Entity
+expected<License> Entity::tryLicense() const { return wrap<License>(tryEntityLicense(_handle)); }
+
+//************** TEntityRegistry *****************
+
+//FNV-1a
+unsigned int TEntityRegistry::hash(const char *s) {
+    unsigned int h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+unsigned int TEntityRegistry::hash(TEntityHandle handle) {
+    uint64_t h = (uint64_t)(uintptr_t)handle * 0x9E3779B97F4A7C15ull;
+    return (unsigned int)(h >> 32);
+}
+
+TEntityRegistry::TEntityRegistry(unsigned int generation) : _generation(generation) {
+    int N = gsGetEntityCount();
+    _entities.reserve(N);
+    _idOffsets.reserve(N);
+    _hashes.reserve(N);
+    _objects.reserve(N);
+    for (int i = 0; i < N; i++) {
+        _entities.push_back(Entity(gsOpenEntityByIndex(i)));
+        _objects.push_back(std::unique_ptr<TGSEntity>(new TGSEntity(gsOpenEntityByIndex(i))));
+        const char *id = _entities.back().id();
+        _idOffsets.push_back(_ids.size());
+        _ids.append(id);
+        _ids.push_back('\0');
+        _hashes.push_back(hash(id));
+    }
+
+    //load factor <= 0.5
+    size_t slots = 4;
+    while (slots < 2 * (size_t)N)
+        slots <<= 1;
+    _slots.assign(slots, -1);
+    _handleSlots.assign(slots, -1);
+    for (int i = 0; i < N; i++) {
+        size_t k = _hashes[i] & (slots - 1);
+        while (_slots[k] >= 0)
+            k = (k + 1) & (slots - 1);
+        _slots[k] = i;
+
+        k = hash(_entities[i].handle()) & (slots - 1);
+        while (_handleSlots[k] >= 0)
+            k = (k + 1) & (slots - 1);
+        _handleSlots[k] = i;
+    }
+}
+
+int TEntityRegistry::indexOf(entity_id_t entityId) const {
+    if (entityId == nullptr)
+        return -1;
+    unsigned int h = hash(entityId);
+    size_t mask = _slots.size() - 1;
+    for (size_t k = h & mask; _slots[k] >= 0; k = (k + 1) & mask) {
+        int i = _slots[k];
+        if (_hashes[i] == h && strcmp(id(i), entityId) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int TEntityRegistry::indexOfHandle(TEntityHandle handle) const {
+    size_t mask = _handleSlots.size() - 1;
+    for (size_t k = hash(handle) & mask; _handleSlots[k] >= 0; k = (k + 1) & mask) {
+        if (_entities[_handleSlots[k]].handle() == handle)
+            return _handleSlots[k];
+    }
+    return -1;
+}
+
+//************** TEntitlementMap *****************
+
+const unsigned int TEntitlementMap::MASK;
+
+TEntitlementMap::TEntitlementMap(int count) : _count(count), _words(new std::atomic<uint64_t>[(count + 15) / 16]) {
+    for (int i = 0; i < (count + 15) / 16; i++)
+        _words[i].store(0, std::memory_order_relaxed);
+}
+
+void TEntitlementMap::set(int index, unsigned int attr) {
+    std::atomic<uint64_t> &w = _words[index / 16];
+    int shift = index % 16 * 4;
+    uint64_t bits = (uint64_t)(attr & MASK) << shift;
+    uint64_t v = w.load(std::memory_order_relaxed);
+    while (!w.compare_exchange_weak(v, (v & ~((uint64_t)MASK << shift)) | bits, std::memory_order_relaxed))
+        ;
+}
+
+//************** TEventQueue *********************
+
+TEventQueue::TEventQueue(int capacity, TEventBackpressure backpressure)
+    : _slots(capacity > 0 ? capacity : 1), _head(0), _count(0), _backpressure(backpressure), _closed(false) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool TEventQueue::push(int eventId, TEventType type, const char *entityId, const void *data, unsigned int dataSize, bool mayBlock) {
+    std::unique_lock<std::mutex> lock(_lock);
+    if (_count == capacity() && !_closed) {
+        if (_backpressure == EVENT_QUEUE_BLOCK && mayBlock) {
+            _notFull.wait(lock, [this] { return _count < capacity() || _closed; });
+        } else if (_backpressure == EVENT_QUEUE_DROP_OLDEST) {
+            _head = (_head + 1) % capacity();
+            _count--;
+            _stats.dropped++;
+        }
+    }
+    if (_closed || _count == capacity()) {
+        _stats.dropped++;
+        return false;
+    }
+
+    TQueuedEvent &evt = _slots[(_head + _count) % capacity()];
+    evt.eventId = eventId;
+    evt.type = type;
+    evt.entityId.assign(entityId ? entityId : "");
+    evt.data.assign((const unsigned char *)data, (const unsigned char *)data + (data ? dataSize : 0));
+    _count++;
+    _stats.queued++;
+    if (_count > _stats.highWater)
+        _stats.highWater = _count;
+    _notEmpty.notify_one();
+    return true;
+}
+
+bool TEventQueue::pop(TQueuedEvent &evt, bool wait) {
+    std::unique_lock<std::mutex> lock(_lock);
+    if (wait)
+        _notEmpty.wait(lock, [this] { return _count > 0 || _closed; });
+    if (_count == 0)
+        return false;
+
+    TQueuedEvent &slot = _slots[_head];
+    evt.eventId = slot.eventId;
+    evt.type = slot.type;
+    evt.entityId.swap(slot.entityId);
+    evt.data.swap(slot.data);
+    _head = (_head + 1) % capacity();
+    _count--;
+    _stats.delivered++;
+    _notFull.notify_one();
+    return true;
+}
+
+void TEventQueue::close(bool discard) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _closed = true;
+    if (discard) {
+        for (; _count > 0; _count--) {
+            _slots[_head] = TQueuedEvent();
+            _head = (_head + 1) % capacity();
+            _stats.dropped++;
+        }
+    }
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+}
+
+TEventQueueStats TEventQueue::stats() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    TEventQueueStats s = _stats;
+    s.pending = _count;
+    return s;
+}
+
+//************** TEventRecorder ******************
+
+TEventRecorder::TEventRecorder(int capacity) : _next(0), _start(std::chrono::steady_clock::now()) {
+    uint64_t n = 1;
+    while (n < (uint64_t)capacity)
+        n <<= 1;
+    _mask = n - 1;
+    _slots.reset(new TSlot[n]);
+    for (uint64_t i = 0; i < n; i++)
+        _slots[i].seq.store(0, std::memory_order_relaxed);
+}
+
+void TEventRecorder::record(int eventId, const char *entityId) {
+    static thread_local uint64_t s_thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    uint64_t words[(MAX_ENTITY_ID + 1) / 8] = {0};
+    if (entityId)
+        strncpy((char *)words, entityId, MAX_ENTITY_ID);
+
+    uint64_t pos = _next.fetch_add(1, std::memory_order_relaxed);
+    TSlot &slot = _slots[pos & _mask];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.time.store(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count(),
+                    std::memory_order_relaxed);
+    slot.eventId.store(eventId, std::memory_order_relaxed);
+    slot.thread.store(s_thread, std::memory_order_relaxed);
+    for (int i = 0; i < (MAX_ENTITY_ID + 1) / 8; i++)
+        slot.entityId[i].store(words[i], std::memory_order_relaxed);
+    slot.seq.store(pos + 1, std::memory_order_release);
+}
+
+std::vector<TEventRecorder::TRecord> TEventRecorder::records() const {
+    uint64_t end = _next.load(std::memory_order_acquire);
+    uint64_t begin = end > _mask + 1 ? end - (_mask + 1) : 0;
+
+    std::vector<TRecord> v;
+    v.reserve((size_t)(end - begin));
+    for (uint64_t pos = begin; pos < end; pos++) {
+        const TSlot &slot = _slots[pos & _mask];
+        TRecord r;
+        uint64_t words[(MAX_ENTITY_ID + 1) / 8];
+        if (slot.seq.load(std::memory_order_acquire) != pos + 1)
+            continue;
+        r.seq = pos;
+        r.time = slot.time.load(std::memory_order_relaxed);
+        r.eventId = slot.eventId.load(std::memory_order_relaxed);
+        r.thread = slot.thread.load(std::memory_order_relaxed);
+        for (int i = 0; i < (MAX_ENTITY_ID + 1) / 8; i++)
+            words[i] = slot.entityId[i].load(std::memory_order_relaxed);
+        //overwritten while being read?
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != pos + 1)
+            continue;
+        memcpy(r.entityId, words, sizeof(words));
+        r.entityId[MAX_ENTITY_ID] = '\0';
+        v.push_back(r);
+    }
+    return v;
+}
+
+std::string TEventRecorder::dump() const {
+    std::string s;
+    char line[256];
+    for (const TRecord &r : records()) {
+        snprintf(line, sizeof(line), "#%llu %.6f %s(%d) thread:%016llx%s%s\n", (unsigned long long)r.seq, r.time / 1e9,
+                 TGSCore::getEventName(r.eventId), r.eventId, (unsigned long long)r.thread, r.entityId[0] ? " entity:" : "", r.entityId);
+        s += line;
+    }
+    return s;
+}
+
+bool TEventRecorder::dump(const char *fileName) const {
+    FILE *f = fopen(fileName, "w");
+    if (f == nullptr)
+        return false;
+    std::string s = dump();
+    bool ok = fwrite(s.data(), 1, s.size(), f) == s.size();
+    return (fclose(f) == 0) && ok;
+}
+
+//************** TEventJournal *******************
+
+namespace {
+const char JOURNAL_MAGIC[] = {'G', 'S', 'E', 'J', 1}; //version 1
+
+void putVarint(std::string &buf, uint64_t v) {
+    while (v >= 0x80) {
+        buf += (char)(v | 0x80);
+        v >>= 7;
+    }
+    buf += (char)v;
+}
+
+//false at the end of file
+bool getVarint(FILE *f, uint64_t &v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(f);
+        if (c == EOF)
+            return false;
+        v |= (uint64_t)(c & 0x7F) << shift;
+        if ((c & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+} // namespace
+
+TEventJournal::TEventJournal(const char *fileName, bool writing)
+    : _file(fopen(fileName, writing ? "wb" : "rb")), _writing(writing), _size(0), _failed(false), _last(std::chrono::steady_clock::now()), _count(0) {
+    if (_file == nullptr)
+        gs5_error::raise(GS_ERROR_GENERIC, "Event journal (%s) cannot be opened", fileName);
+    if (!writing && fseek(_file, 0, SEEK_END) == 0) {
+        long size = ftell(_file);
+        _size = size > 0 ? (uint64_t)size : 0;
+        rewind(_file);
+    }
+
+    char magic[sizeof(JOURNAL_MAGIC)];
+    if (writing ? fwrite(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC), 1, _file) != 1
+                : (fread(magic, sizeof(magic), 1, _file) != 1 || memcmp(magic, JOURNAL_MAGIC, sizeof(magic)) != 0)) {
+        fclose(_file);
+        gs5_error::raise(GS_ERROR_INVALID_VALUE, "(%s) is not an event journal", fileName);
+    }
+}
+
+TEventJournal::~TEventJournal() {
+    fclose(_file);
+}
+
+bool TEventJournal::write(unsigned int eventId, TEventType type, const char *entityId, const void *data, unsigned int dataSize) {
+    size_t idLen = entityId ? strlen(entityId) : 0;
+    std::string rec;
+    rec.reserve(24 + idLen + dataSize);
+
+    std::lock_guard<std::mutex> lock(_lock);
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    putVarint(rec, std::chrono::duration_cast<std::chrono::microseconds>(now - _last).count());
+    _last = now;
+    putVarint(rec, eventId);
+    putVarint(rec, (uint64_t)type);
+    putVarint(rec, idLen);
+    rec.append(entityId ? entityId : "", idLen);
+    putVarint(rec, dataSize);
+    rec.append((const char *)data, data ? dataSize : 0);
+    if (_failed.load() || fwrite(rec.data(), 1, rec.size(), _file) != rec.size()) {
+        _failed = true;
+        return false;
+    }
+    _count++;
+    return true;
+}
+
+bool TEventJournal::flush() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_writing && fflush(_file) != 0)
+        _failed = true;
+    return !_failed.load();
+}
+
+uint64_t TEventJournal::bytesLeft() {
+    long pos = ftell(_file);
+    return pos >= 0 && (uint64_t)pos < _size ? _size - (uint64_t)pos : 0;
+}
+
+bool TEventJournal::read(TEntry &entry) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_writing)
+        gs5_error::raise(GS_ERROR_INVALID_ACTION, "Event journal is opened for writing");
+
+    uint64_t v;
+    if (!getVarint(_file, entry.delay))
+        return false;
+
+    bool ok = getVarint(_file, v);
+    entry.eventId = (unsigned int)v;
+    ok = ok && getVarint(_file, v);
+    entry.type = (TEventType)v;
+    //a length is checked against the bytes left before anything is allocated for it
+    ok = ok && getVarint(_file, v) && v <= 0xFFFF && v <= bytesLeft();
+    if (ok) {
+        entry.entityId.resize((size_t)v);
+        ok = v == 0 || fread(&entry.entityId[0], (size_t)v, 1, _file) == 1;
+    }
+    ok = ok && getVarint(_file, v) && v <= 0xFFFFFFFF && v <= bytesLeft();
+    if (ok) {
+        entry.data.resize((size_t)v);
+        ok = v == 0 || fread(entry.data.data(), (size_t)v, 1, _file) == 1;
+    }
+    if (!ok)
+        gs5_error::raise(GS_ERROR_INVALID_VALUE, "Event journal is truncated after %llu events", (unsigned long long)_count);
+    _count++;
+    return true;
+}
+
+//************** TUserEventPoster ****************
+
+struct TUserEventPoster::TBuffer {
+    std::atomic<TBuffer *> next; //queue link
+    uint32_t freeNext;           //pool link, index + 1 of the next free buffer, 0: none
+    int sizeClass;               //-1: heap allocated
+    uint32_t index;
+    unsigned int eventId;
+    unsigned int size;
+    unsigned char *data;
+};
+
+//a free list of buffers of the same capacity, the head is tagged against ABA
+struct TUserEventPoster::TSizeClass {
+    unsigned int capacity;
+    uint32_t count;
+    std::unique_ptr<unsigned char[]> storage;
+    std::unique_ptr<TBuffer[]> buffers;
+    std::atomic<uint64_t> free; //tag << 32 | (index + 1)
+};
+
+namespace {
+const unsigned int s_classCapacity[] = {64, 256, 1024, 4096};
+const uint32_t s_classCount[] = {256, 128, 64, 32};
+const int SIZE_CLASSES = sizeof(s_classCapacity) / sizeof(s_classCapacity[0]);
+thread_local bool t_userEventPoster = false;
+} // namespace
+
+TUserEventPoster::TUserEventPoster()
+    : _stub(new TBuffer()), _tail(nullptr), _started(false), _sleeping(false), _stop(false), _posted(0), _delivered(0), _unpooled(0) {
+    _stub->next.store(nullptr, std::memory_order_relaxed);
+    _head.store(_stub.get(), std::memory_order_relaxed);
+    _tail = _stub.get();
+}
+
+TUserEventPoster::~TUserEventPoster() {
+    stop();
+}
+
+void TUserEventPoster::start() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_started.load(std::memory_order_relaxed) || _stop)
+        return;
+    _classes.reset(new TSizeClass[SIZE_CLASSES]);
+    for (int c = 0; c < SIZE_CLASSES; c++) {
+        TSizeClass &sc = _classes[c];
+        sc.capacity = s_classCapacity[c];
+        sc.count = s_classCount[c];
+        sc.storage.reset(new unsigned char[(size_t)sc.capacity * sc.count]);
+        sc.buffers.reset(new TBuffer[sc.count]);
+        for (uint32_t i = 0; i < sc.count; i++) {
+            TBuffer &b = sc.buffers[i];
+            b.sizeClass = c;
+            b.index = i;
+            b.data = sc.storage.get() + (size_t)sc.capacity * i;
+            b.freeNext = i + 1 < sc.count ? i + 2 : 0;
+        }
+        sc.free.store(1, std::memory_order_relaxed);
+    }
+    _thread = std::thread(&TUserEventPoster::proc, this);
+    _started.store(true, std::memory_order_release);
+}
+
+TUserEventPoster::TBuffer *TUserEventPoster::acquire(unsigned int size) {
+    for (int c = 0; c < SIZE_CLASSES; c++) {
+        TSizeClass &sc = _classes[c];
+        if (size > sc.capacity)
+            continue;
+        uint64_t head = sc.free.load(std::memory_order_acquire);
+        while ((uint32_t)head != 0) {
+            TBuffer *b = &sc.buffers[(uint32_t)head - 1];
+            uint64_t next = ((head >> 32) + 1) << 32 | b->freeNext;
+            if (sc.free.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
+                return b;
+        }
+        //used up, a larger class or the heap then
+    }
+    _unpooled.fetch_add(1, std::memory_order_relaxed);
+    TBuffer *b = new TBuffer();
+    b->sizeClass = -1;
+    b->data = new unsigned char[size ? size : 1];
+    return b;
+}
+
+void TUserEventPoster::release(TBuffer *b) {
+    if (b->sizeClass < 0) {
+        delete[] b->data;
+        delete b;
+        return;
+    }
+    TSizeClass &sc = _classes[b->sizeClass];
+    uint64_t head = sc.free.load(std::memory_order_relaxed);
+    do {
+        b->freeNext = (uint32_t)head;
+    } while (!sc.free.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | (b->index + 1), std::memory_order_release,
+                                            std::memory_order_relaxed));
+}
+
+void TUserEventPoster::post(unsigned int eventId, const void *data, unsigned int dataSize) {
+    if (!_started.load(std::memory_order_acquire)) {
+        start();
+        if (!_started.load(std::memory_order_acquire)) { //stopped
+            gsPostUserEvent(eventId, true, (void *)data, data ? dataSize : 0);
+            return;
+        }
+    }
+    if (data == nullptr)
+        dataSize = 0;
+    TBuffer *b = acquire(dataSize);
+    b->eventId = eventId;
+    b->size = dataSize;
+    if (dataSize)
+        memcpy(b->data, data, dataSize);
+
+    //intrusive MPSC queue: one exchange to link in
+    _posted.fetch_add(1, std::memory_order_relaxed);
+    b->next.store(nullptr, std::memory_order_relaxed);
+    TBuffer *prev = _head.exchange(b, std::memory_order_acq_rel);
+    prev->next.store(b, std::memory_order_release);
+
+    //the lock is only taken to wake the poster thread up
+    if (_sleeping.load() && _sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _cv.notify_one();
+    }
+}
+
+//poster thread only, nullptr if empty (or a post is being linked in)
+TUserEventPoster::TBuffer *TUserEventPoster::pop() {
+    TBuffer *tail = _tail;
+    TBuffer *next = tail->next.load(std::memory_order_acquire);
+    if (tail == _stub.get()) {
+        if (next == nullptr)
+            return nullptr;
+        _tail = tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (next) {
+        _tail = next;
+        return tail;
+    }
+    if (tail != _head.load(std::memory_order_acquire))
+        return nullptr;
+    //tail is the last one, the stub goes behind it
+    _stub->next.store(nullptr, std::memory_order_relaxed);
+    TBuffer *prev = _head.exchange(_stub.get(), std::memory_order_acq_rel);
+    prev->next.store(_stub.get(), std::memory_order_release);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+        _tail = next;
+        return tail;
+    }
+    return nullptr;
+}
+
+void TUserEventPoster::proc() {
+    t_userEventPoster = true;
+    for (;;) {
+        while (TBuffer *b = pop()) {
+            gsPostUserEvent(b->eventId, true, b->size ? b->data : NULL, b->size);
+            release(b);
+            _delivered.fetch_add(1, std::memory_order_release);
+        }
+        if (_delivered.load(std::memory_order_acquire) != _posted.load(std::memory_order_acquire)) {
+            std::this_thread::yield(); //being linked in
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_lock);
+        if (_stop)
+            break;
+        _sleeping.store(true);
+        if (_delivered.load() == _posted.load())
+            _cv.wait_for(lock, std::chrono::milliseconds(100), [this] { return !_sleeping.load() || _stop; });
+        _sleeping.store(false);
+    }
+}
+
+void TUserEventPoster::flush() {
+    if (t_userEventPoster || !_started.load(std::memory_order_acquire))
+        return;
+    uint64_t target = _posted.load();
+    while (_delivered.load(std::memory_order_acquire) < target)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void TUserEventPoster::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stop = true;
+        _cv.notify_one();
+    }
+    //posted synchronously from now on
+    _started.store(false);
+    if (!_thread.joinable())
+        return;
+    if (_thread.get_id() == std::this_thread::get_id()) {
+        _thread.detach(); //stopped by a handler, the thread ends on return
+        return;
+    }
+    _thread.join();
+    //the posts racing with stop()
+    while (_delivered.load() != _posted.load()) {
+        if (TBuffer *b = pop()) {
+            gsPostUserEvent(b->eventId, true, b->size ? b->data : NULL, b->size);
+            release(b);
+            _delivered.fetch_add(1);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+TUserEventPoster::TStats TUserEventPoster::stats() const {
+    TStats s;
+    s.posted = _posted.load();
+    s.delivered = _delivered.load();
+    s.unpooled = _unpooled.load();
+    return s;
+}
+
+//************** LicenseSnapshot *****************
+
+unsigned int LicenseSnapshot::intern(const char *s) {
+    unsigned int offset = (unsigned int)_strings.size();
+    _strings.append(s ? s : "");
+    _strings.push_back('\0');
+    return offset;
+}
+
+void LicenseSnapshot::add(TLicenseHandle hLic, const char *entityId) {
+    TLicense lic;
+    lic.entityId = intern(entityId);
+    lic.licenseId = intern(gsGetLicenseId(hLic));
+    lic.status = gsGetLicenseStatus(hLic);
+    lic.firstParam = (int)_params.size();
+    lic.paramCount = gsGetLicenseParamCount(hLic);
+
+    for (int i = 0; i < lic.paramCount; i++) {
+        Variable v(gsGetLicenseParamByIndex(hLic, i));
+        TParam p;
+        p.license = (int)_licenses.size();
+        p.name = intern(v.name());
+        p.type = v.typeId();
+        p.attr = gsGetVariableAttr(v.handle());
+        switch (p.type) {
+        case VAR_TYPE_FLOAT:
+        case VAR_TYPE_DOUBLE:
+            p.d = v.asDouble();
+            break;
+        case VAR_TYPE_STRING:
+            p.str = intern(v.asString());
+            break;
+        case VAR_TYPE_TIME:
+            p.i = v.asUTCTime();
+            break;
+        default:
+            p.i = v.asInt64();
+        }
+        _params.push_back(p);
+    }
+    _licenses.push_back(lic);
+}
+
+LicenseSnapshot LicenseSnapshot::capture() {
+    LicenseSnapshot snap;
+    std::shared_ptr<const TEntityRegistry> reg = TGSCore::getInstance()->entityRegistry();
+    snap._licenses.reserve(reg->size());
+    for (int i = 0; i < reg->size(); i++) {
+        const Entity &e = (*reg)[i];
+        if (e.hasLicense())
+            snap.add(License(entityLicense(e.handle())).handle(), reg->id(i));
+    }
+    return snap;
+}
+
+LicenseSnapshot LicenseSnapshot::capture(const License &license) {
+    LicenseSnapshot snap;
+    snap.add(license.handle(), license.entity().id());
+    return snap;
+}
+
+//snapshots of the same licenses are laid out the same, so the item at the same index is tried first
+int LicenseSnapshot::findLicense(const char *entityId, int hint) const {
+    int N = (int)_licenses.size();
+    for (int k = 0; k < N; k++) {
+        int i = (hint + k) % N;
+        if (strcmp(str(_licenses[i].entityId), entityId) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int LicenseSnapshot::findParam(const TLicense &lic, const char *name, int hint) const {
+    int N = lic.paramCount;
+    for (int k = 0; k < N; k++) {
+        const TParam &p = _params[lic.firstParam + (hint + k) % N];
+        if (strcmp(str(p.name), name) == 0)
+            return lic.firstParam + (hint + k) % N;
+    }
+    return -1;
+}
+
+bool LicenseSnapshot::sameValue(const TParam &p, const LicenseSnapshot &other, const TParam &q) const {
+    if (p.type != q.type || p.attr != q.attr)
+        return false;
+    switch (p.type) {
+    case VAR_TYPE_FLOAT:
+    case VAR_TYPE_DOUBLE:
+        return p.d == q.d;
+    case VAR_TYPE_STRING:
+        return strcmp(str(p.str), other.str(q.str)) == 0;
+    default:
+        return p.i == q.i;
+    }
+}
+
+std::vector<LicenseSnapshot::TChange> LicenseSnapshot::diff(const LicenseSnapshot &after) const {
+    std::vector<TChange> changes;
+    std::vector<bool> matched(after._licenses.size(), false);
+
+    for (int l = 0; l < (int)_licenses.size(); l++) {
+        const TLicense &lic = _licenses[l];
+        int l2 = after.findLicense(str(lic.entityId), l);
+        if (l2 < 0) {
+            TChange c = {LICENSE_REMOVED, l, -1, -1, -1};
+            changes.push_back(c);
+            continue;
+        }
+        matched[l2] = true;
+        const TLicense &lic2 = after._licenses[l2];
+        if (lic.status != lic2.status) {
+            TChange c = {STATUS_CHANGED, l, l2, -1, -1};
+            changes.push_back(c);
+        }
+
+        int found = 0;
+        for (int k = 0; k < lic.paramCount; k++) {
+            int p = lic.firstParam + k;
+            int p2 = after.findParam(lic2, str(_params[p].name), k);
+            if (p2 < 0) {
+                TChange c = {PARAM_REMOVED, l, l2, p, -1};
+                changes.push_back(c);
+                continue;
+            }
+            found++;
+            if (!sameValue(_params[p], after, after._params[p2])) {
+                TChange c = {VALUE_CHANGED, l, l2, p, p2};
+                changes.push_back(c);
+            }
+        }
+        //only looked for when some parameters are new
+        if (found < lic2.paramCount) {
+            for (int k = 0; k < lic2.paramCount; k++) {
+                int p2 = lic2.firstParam + k;
+                if (findParam(lic, after.str(after._params[p2].name), k) < 0) {
+                    TChange c = {PARAM_ADDED, l, l2, -1, p2};
+                    changes.push_back(c);
+                }
+            }
+        }
+    }
+    for (int l2 = 0; l2 < (int)matched.size(); l2++) {
+        if (!matched[l2]) {
+            TChange c = {LICENSE_ADDED, -1, l2, -1, -1};
+            changes.push_back(c);
+        }
+    }
+    return changes;
+}
+
+//************** ParamRef *************************
+
+ParamRefBase::ParamRefBase(TLicenseHandle license, const char *name)
+    : _license(license), _name(name), _generation(0), _core(NULL) {
+    resolve();
+}
+
+void ParamRefBase::resolve() {
+    if (_license == INVALID_GS_HANDLE)
+        gs5_error::raise(GS_ERROR_INVALID_LICENSE, "Parameter [%s] is not bound to a license", _name.c_str());
+    if (_core == NULL)
+        _core = TGSCore::getInstance();
+    //read first, so that a license changing while resolving leaves the reference stale
+    _generation = _core->licenseGeneration();
+    _var = Variable(licenseParam(_license, _name.c_str()));
+}
+
+bool ParamRefBase::stale() const {
+    //_core is set once _var is
+    return !_var || _generation != _core->licenseGeneration();
+}
+
+void ParamRefBase::rebind(TLicenseHandle license) {
+    _license = license;
+    _var = Variable();
+}
+
+//************** Request Builder ******************
+
+void RequestValue::setTo(Variable &var, var_type_t varType) const {
+    switch (_kind) {
+    case INT:
+    case INT64:
+        if (varType == VAR_TYPE_TIME)
+            var.fromUTCTime((time_t)_v.i);
+        else if (_kind == INT)
+            var.fromInt((int)_v.i);
+        else
+            var.fromInt64(_v.i);
+        break;
+    case BOOL:
+        var.fromBool(_v.i != 0);
+        break;
+    case FLOAT:
+        var.fromFloat(_v.f);
+        break;
+    case DOUBLE:
+        var.fromDouble(_v.d);
+        break;
+    case STRING:
+        var.fromString(_v.s);
+        break;
+    default:
+        gs5_error::raise(GS_ERROR_INVALID_VALUE, "No value for parameter [%s]", var.name());
+    }
+}
+
+RequestBuilder &RequestBuilder::action(action_id_t actId) {
+    _action = _request.addAction(actId);
+    return *this;
+}
+RequestBuilder &RequestBuilder::action(action_id_t actId, const Entity &entity) {
+    _action = _request.addAction(actId, entity);
+    return *this;
+}
+RequestBuilder &RequestBuilder::action(action_id_t actId, const char *entityId) {
+    _action = _request.addAction(actId, entityId);
+    return *this;
+}
+
+RequestBuilder &RequestBuilder::param(const char *name, const RequestValue &value) {
+    if (!_action)
+        gs5_error::raise(GS_ERROR_INVALID_ACTION, "Parameter [%s] set before any action", name);
+    Variable var = _action.param(name);
+    value.setTo(var, var.typeId());
+    return *this;
+}
+
+Action RequestTemplate::addAction(Request &request, const TStep &step) {
+    return request.addAction(step.actId, step.entityId.empty() ? NULL : step.entityId.c_str());
+}
+
+//looked up in a throwaway request, no handle is kept by the template
+RequestTemplate &RequestTemplate::action(action_id_t actId, const char *entityId) {
+    TStep step = {actId, entityId ? entityId : "", (int)_slots.size()};
+    Request probe = TGSCore::getInstance()->request();
+    addAction(probe, step);
+    _steps.push_back(step);
+    return *this;
+}
+
+RequestTemplate &RequestTemplate::param(const char *name) {
+    if (_steps.empty())
+        gs5_error::raise(GS_ERROR_INVALID_ACTION, "Template [%s]: parameter [%s] added before any action", _name.c_str(), name);
+    Request probe = TGSCore::getInstance()->request();
+    Action action = addAction(probe, _steps.back());
+    for (int i = 0, n = action.paramCount(); i < n; i++) {
+        Variable var = action.param(i);
+        if (strcmp(var.name(), name) == 0) {
+            _slots.push_back({i, var.typeId()});
+            return *this;
+        }
+    }
+    gs5_error::raise(GS_ERROR_INVALID_NAME, "Template [%s]: invalid param name [%s]", _name.c_str(), name);
+}
+
+//the parameters are set by index, as looked up when the template is defined
+std::string RequestTemplate::generate(const RequestValue *values, int count) const {
+    if (count != (int)_slots.size())
+        gs5_error::raise(GS_ERROR_INVALID_VALUE, "Template [%s] takes %d values, %d given", _name.c_str(), (int)_slots.size(), count);
+
+    Request request = TGSCore::getInstance()->request();
+    for (size_t i = 0; i < _steps.size(); i++) {
+        const TStep &step = _steps[i];
+        Action action = addAction(request, step);
+        int end = i + 1 < _steps.size() ? _steps[i + 1].firstSlot : (int)_slots.size();
+        for (int slot = step.firstSlot; slot < end; slot++) {
+            Variable var = action.param(_slots[slot].index);
+            values[slot].setTo(var, _slots[slot].type);
+        }
+    }
+    return request.code();
+}
+
 //************** TGSCore *************************
 
 void WINAPI TGSCore::s_monitorCallback(int eventId, TEventHandle hEvent, void *usrData) {
@@ -442,9 +1634,127 @@ void TGSCore::setUserEventHandler(TGSUserEventHandler handler, void *usrData) {
     _userEventUsrData = usrData;
 }
 
+//Subscribers
+struct TGSCore::TSubscriber {
+    int id;
+    TGSEventSubscriber fn;
+    void *usrData;
+    TEventMask mask;
+    std::string entityId; //empty: any entity
+    std::atomic<bool> active;
+};
+
+struct TGSCore::TSubscriberList {
+    TEventMask mask; //events any subscriber is interested in
+    std::vector<std::shared_ptr<TSubscriber>> subscribers;
+};
+
+//Delivery policies
+struct TGSCore::TPolicyState {
+    struct TKey {
+        bool seen;
+        bool held;      //EVENT_POLICY_LAST_IN_BURST: an event is waiting to be released
+        int64_t last;   //ms of the last event delivered (coalesce) or held (last in burst)
+        uint64_t count; //events
+    };
+    int eventId;
+    TEventPolicy policy;
+    std::mutex lock;
+    std::vector<TKey> keys; //by entity index + 1, 0: not an entity event or not in the registry
+    std::atomic<uint64_t> delivered;
+    std::atomic<uint64_t> suppressed;
+};
+
+static int64_t steady_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 void TGSCore::onEvent(int eventId, TEventHandle hEvent) {
     TEventType evtType = gsGetEventType(hEvent);
+    recordEvent(eventId, evtType == EVENT_TYPE_ENTITY ? gsGetEventSource(hEvent) : INVALID_GS_HANDLE);
+    if (eventId == EVENT_LICENSE_FAIL || eventId == EVENT_APP_CLOCK_ROLLBACK)
+        dumpRecorder();
+    journalEvent(eventId, evtType, hEvent);
+
+    if (eventId == EVENT_LICENSE_READY || eventId == EVENT_ENTITY_ACTION_APPLIED)
+        _licenseGeneration.fetch_add(1);
+    if (eventId == EVENT_LICENSE_READY) {
+        std::lock_guard<std::mutex> lock(_reconcileLock);
+        _reconcileNow = true;
+        _reconcileCV.notify_one();
+    }
+
+    if (evtType == EVENT_TYPE_ENTITY)
+        updateEntitlement(gsGetEventSource(hEvent));
+
+    TPolicyState *policy = (eventId >= 0 && eventId < MAX_POLICY_EVENT_ID) ? _policies[eventId].load(std::memory_order_acquire) : nullptr;
+    if (policy) {
+        int key = 0;
+        if (evtType == EVENT_TYPE_ENTITY) {
+            TEntityHandle hEntity = gsGetEventSource(hEvent);
+            std::shared_ptr<const TEntityRegistry> reg = std::atomic_load(&_registry);
+            int index = reg ? reg->indexOfHandle(hEntity) : -1;
+            if (reg && index < 0)
+                index = reg->indexOf(gsGetEntityId(hEntity));
+            key = index + 1;
+        }
+        if (!admitEvent(*policy, key))
+            return;
+    }
+
+    //gsCore acts on what these handlers do right after they return
+    std::shared_ptr<TEventQueue> queue = std::atomic_load(&_eventQueue);
+    if (!queue || eventId == EVENT_LICENSE_LOADING || eventId == EVENT_ENTITY_TRY_ACCESS) {
+        unsigned int evtDataSize = 0;
+        void *evtData = evtType == EVENT_TYPE_USER ? gsGetUserEventData(hEvent, &evtDataSize) : NULL;
+        std::shared_ptr<const TEntityRegistry> reg;
+        std::unique_ptr<TGSEntity> owned;
+        TGSEntity *entity = evtType == EVENT_TYPE_ENTITY ? eventEntity(gsGetEventSource(hEvent), NULL, reg, owned) : NULL;
+        deliver(eventId, evtType, entity, evtData, evtDataSize);
+        return;
+    }
+
     switch (evtType) {
+    case EVENT_TYPE_ENTITY:
+        queue->push(eventId, evtType, gsGetEntityId(gsGetEventSource(hEvent)), NULL, 0,
+                    _deliveringThread.load() != std::this_thread::get_id());
+        break;
+    case EVENT_TYPE_USER: {
+        unsigned int evtDataSize;
+        void *evtData = gsGetUserEventData(hEvent, &evtDataSize);
+        queue->push(eventId, evtType, NULL, evtData, evtDataSize, _deliveringThread.load() != std::this_thread::get_id());
+        break;
+    }
+    default:
+        queue->push(eventId, evtType, NULL, NULL, 0, _deliveringThread.load() != std::this_thread::get_id());
+    }
+}
+
+/*
+ * The entity objects handed to the handlers are interned in the registry, so an entity event (e.g. the heartbeat)
+ * is delivered without allocating. The registry is not rebuilt here: the current one, even if out of date, still
+ * has the same entities unless the license is being reloaded, in which case the entity is opened on its own.
+ */
+TGSEntity *TGSCore::eventEntity(TEntityHandle hSource, entity_id_t entityId, std::shared_ptr<const TEntityRegistry> &reg,
+                                std::unique_ptr<TGSEntity> &owned) {
+    reg = std::atomic_load(&_registry);
+    if (reg) {
+        int index = hSource != INVALID_GS_HANDLE ? reg->indexOfHandle(hSource) : -1;
+        if (index < 0)
+            index = reg->indexOf(entityId ? entityId : gsGetEntityId(hSource));
+        if (index >= 0)
+            return reg->object(index);
+    }
+    //the event source is not ours to close
+    TEntityHandle hEntity = gsOpenEntityById(entityId ? entityId : gsGetEntityId(hSource));
+    if (hEntity == INVALID_GS_HANDLE)
+        return NULL;
+    owned.reset(new TGSEntity(hEntity));
+    return owned.get();
+}
+
+void TGSCore::deliver(int eventId, TEventType type, TGSEntity *entity, void *data, unsigned int dataSize) {
+    switch (type) {
     case EVENT_TYPE_APP: {
         if (_appEventHandler)
             _appEventHandler(eventId, _appEventUsrData);
@@ -456,30 +1766,386 @@ void TGSCore::onEvent(int eventId, TEventHandle hEvent) {
         break;
     }
     case EVENT_TYPE_ENTITY: {
-        std::unique_ptr<TGSEntity> entity(new TGSEntity(gsGetEventSource(hEvent)));
         if (_entityEventHandler)
-            _entityEventHandler(eventId, entity.get(), _entityEventUsrData);
+            _entityEventHandler(eventId, entity, _entityEventUsrData);
         break;
     }
 
     case EVENT_TYPE_USER: {
-        unsigned int evtDataSize;
-        void *evtData = gsGetUserEventData(hEvent, &evtDataSize);
         if (_userEventHandler)
-            _userEventHandler(eventId, evtData, evtDataSize, _userEventUsrData);
+            _userEventHandler(eventId, data, dataSize, _userEventUsrData);
+        break;
+    }
+    }
+
+    //counted before the list is read, see publishSubscribers()
+    _delivering.fetch_add(1);
+    const TSubscriberList *list = _subscribers.load();
+    if (list && list->mask.test(eventId)) {
+        const char *sourceId = NULL;
+        for (const std::shared_ptr<TSubscriber> &sub : list->subscribers) {
+            if (!sub->mask.test(eventId) || !sub->active.load(std::memory_order_relaxed))
+                continue;
+            if (entity && !sub->entityId.empty()) {
+                if (sourceId == NULL)
+                    sourceId = entity->id();
+                if (sub->entityId != sourceId)
+                    continue;
+            }
+            sub->fn(eventId, entity, data, dataSize, sub->usrData);
+        }
+    }
+    _delivering.fetch_sub(1);
+}
+
+void TGSCore::deliver(const TQueuedEvent &evt) {
+    std::shared_ptr<const TEntityRegistry> reg;
+    std::unique_ptr<TGSEntity> owned;
+    TGSEntity *entity = NULL;
+    if (evt.type == EVENT_TYPE_ENTITY) {
+        entity = eventEntity(INVALID_GS_HANDLE, evt.entityId.c_str(), reg, owned);
+        if (entity == NULL)
+            return;
+    }
+    deliver(evt.eventId, evt.type, entity, evt.data.empty() ? NULL : (void *)evt.data.data(), (unsigned int)evt.data.size());
+}
+
+bool TGSCore::admitEvent(TPolicyState &state, int key) {
+    int64_t now = steady_ms();
+    std::lock_guard<std::mutex> lock(state.lock);
+    if ((int)state.keys.size() <= key)
+        state.keys.resize(key + 1, TPolicyState::TKey());
+    TPolicyState::TKey &k = state.keys[key];
+
+    bool admit = true;
+    switch (state.policy.kind) {
+    case EVENT_POLICY_COALESCE:
+        admit = !k.seen || now - k.last >= state.policy.param;
+        if (admit)
+            k.last = now;
+        break;
+    case EVENT_POLICY_SAMPLE:
+        admit = k.count % state.policy.param == 0;
+        break;
+    case EVENT_POLICY_LAST_IN_BURST:
+        //the one held before is superseded, this one is released later
+        if (k.held)
+            state.suppressed++;
+        k.held = true;
+        k.last = now;
+        admit = false;
         break;
+    default:
+        break;
+    }
+    k.seen = true;
+    k.count++;
+    if (state.policy.kind != EVENT_POLICY_LAST_IN_BURST)
+        (admit ? state.delivered : state.suppressed)++;
+    return admit;
+}
+
+//delivers the events held by EVENT_POLICY_LAST_IN_BURST once quiet for long enough, or all of them
+void TGSCore::releaseHeldEvents(bool all) {
+    int64_t now = steady_ms();
+    std::shared_ptr<const TEntityRegistry> reg = std::atomic_load(&_registry);
+    std::shared_ptr<TEventQueue> queue = std::atomic_load(&_eventQueue);
+    TQueuedEvent evt;
+    for (int id = 0; id < MAX_POLICY_EVENT_ID; id++) {
+        TPolicyState *state = _policies[id].load(std::memory_order_acquire);
+        if (state == nullptr || state->policy.kind != EVENT_POLICY_LAST_IN_BURST)
+            continue;
+        for (int key = 0;; key++) {
+            {
+                std::lock_guard<std::mutex> lock(state->lock);
+                if (key >= (int)state->keys.size())
+                    break;
+                TPolicyState::TKey &k = state->keys[key];
+                if (!k.held || (!all && now - k.last < state->policy.param))
+                    continue;
+                k.held = false;
+            }
+            evt.eventId = id;
+            evt.type = id >= EVENT_TYPE_ENTITY ? EVENT_TYPE_ENTITY : id >= EVENT_TYPE_LICENSE ? EVENT_TYPE_LICENSE : EVENT_TYPE_APP;
+            evt.entityId.assign(key > 0 && reg && key <= reg->size() ? reg->id(key - 1) : "");
+            if (evt.type == EVENT_TYPE_ENTITY && evt.entityId.empty()) {
+                state->suppressed++;
+                continue;
+            }
+            state->delivered++;
+            if (queue)
+                queue->push(evt.eventId, evt.type, evt.entityId.c_str(), NULL, 0, true);
+            else
+                deliver(evt);
+        }
     }
+}
+
+void TGSCore::policyProc() {
+    std::unique_lock<std::mutex> lock(_policyLock);
+    while (!_policyStop) {
+        _policyCV.wait_for(lock, std::chrono::milliseconds(_policyTick));
+        if (_policyStop)
+            break;
+        lock.unlock();
+        releaseHeldEvents(false);
+        lock.lock();
+    }
+}
+
+void TGSCore::stopPolicyThread() {
+    {
+        std::lock_guard<std::mutex> lock(_policyLock);
+        _policyStop = true;
+        _policyCV.notify_one();
+    }
+    if (_policyThread.joinable())
+        _policyThread.join();
+    releaseHeldEvents(true);
+}
+
+void TGSCore::setEventPolicy(unsigned int eventId, const TEventPolicy &policy) {
+    if (eventId >= MAX_POLICY_EVENT_ID)
+        gs5_error::raise(GS_ERROR_INVALID_VALUE, "No delivery policy for event [%u]", eventId);
+
+    //the events held by the policy replaced are released first
+    releaseHeldEvents(true);
+
+    std::lock_guard<std::mutex> lock(_policyLock);
+    TPolicyState *state = nullptr;
+    if (policy.kind != EVENT_POLICY_ALL) {
+        _policyStates.push_back(std::unique_ptr<TPolicyState>(new TPolicyState()));
+        state = _policyStates.back().get();
+        state->eventId = (int)eventId;
+        state->policy = policy;
+        if (state->policy.param < (policy.kind == EVENT_POLICY_SAMPLE ? 1 : 0))
+            state->policy.param = policy.kind == EVENT_POLICY_SAMPLE ? 1 : 0;
+        state->delivered = 0;
+        state->suppressed = 0;
+    }
+    _policies[eventId].store(state, std::memory_order_release);
+
+    if (policy.kind == EVENT_POLICY_LAST_IN_BURST) {
+        _policyTick = std::min(_policyTick, std::max(1, state->policy.param / 2));
+        _policyCV.notify_one();
+        if (!_policyThread.joinable() && !_policyStop)
+            _policyThread = std::thread(&TGSCore::policyProc, this);
+    }
+}
+
+TEventPolicyStats TGSCore::eventPolicyStats(unsigned int eventId) const {
+    TEventPolicyStats stats = {0, 0};
+    TPolicyState *state = eventId < MAX_POLICY_EVENT_ID ? _policies[eventId].load(std::memory_order_acquire) : nullptr;
+    if (state) {
+        stats.delivered = state->delivered.load();
+        stats.suppressed = state->suppressed.load();
     }
+    return stats;
+}
+
+void TGSCore::setEventDispatch(TEventDispatchMode mode, int capacity, TEventBackpressure backpressure) {
+    if (_deliveringThread.load() == std::this_thread::get_id())
+        gs5_error::raise(GS_ERROR_GENERIC, "Event dispatch cannot be changed from an event handler");
+    if (mode == EVENT_DISPATCH_PUMP && backpressure == EVENT_QUEUE_BLOCK)
+        gs5_error::raise(GS_ERROR_GENERIC, "EVENT_QUEUE_BLOCK cannot be used with EVENT_DISPATCH_PUMP");
+
+    std::lock_guard<std::mutex> lock(_dispatchLock);
+    std::shared_ptr<TEventQueue> queue;
+    if (mode != EVENT_DISPATCH_SYNC)
+        queue = std::make_shared<TEventQueue>(capacity, backpressure);
+    std::shared_ptr<TEventQueue> old = std::atomic_exchange(&_eventQueue, queue);
+    _dispatchMode = mode;
+
+    //the pending events of the old queue go first
+    if (old) {
+        old->close();
+        if (_dispatcher.joinable()) {
+            _dispatcher.join();
+        } else {
+            _deliveringThread = std::this_thread::get_id();
+            TQueuedEvent evt;
+            while (old->pop(evt, false))
+                deliver(evt);
+            _deliveringThread = std::thread::id();
+        }
+    }
+    if (mode == EVENT_DISPATCH_THREAD)
+        _dispatcher = std::thread(&TGSCore::dispatchProc, this, queue);
+}
+
+/*
+ * cleanUp() called by a handler (e.g. one exiting the app on a license failure): the pending events cannot be
+ * delivered from within the handler, nor after gsCore is cleaned up, so they are dropped. The dispatcher thread,
+ * being the caller, is detached and ends once the handler returns.
+ */
+void TGSCore::stopDispatchFromHandler() {
+    std::lock_guard<std::mutex> lock(_dispatchLock);
+    std::shared_ptr<TEventQueue> old = std::atomic_exchange(&_eventQueue, std::shared_ptr<TEventQueue>());
+    _dispatchMode = EVENT_DISPATCH_SYNC;
+    if (old)
+        old->close(true);
+    if (_dispatcher.joinable() && _dispatcher.get_id() == std::this_thread::get_id())
+        _dispatcher.detach();
+}
+
+void TGSCore::dispatchProc(std::shared_ptr<TEventQueue> queue) {
+    _deliveringThread = std::this_thread::get_id();
+    TQueuedEvent evt;
+    while (queue->pop(evt, true))
+        deliver(evt);
+    _deliveringThread = std::thread::id();
+}
+
+int TGSCore::dispatchPending(int maxEvents) {
+    std::shared_ptr<TEventQueue> queue = std::atomic_load(&_eventQueue);
+    if (!queue || _dispatchMode.load() != EVENT_DISPATCH_PUMP)
+        return 0;
+
+    //events fired by the handlers are queued for the next round
+    std::thread::id none;
+    if (!_deliveringThread.compare_exchange_strong(none, std::this_thread::get_id()))
+        return 0;
+    int n = 0;
+    TQueuedEvent evt;
+    for (int pending = queue->stats().pending; n < pending && (maxEvents < 0 || n < maxEvents) && queue->pop(evt, false); n++)
+        deliver(evt);
+    _deliveringThread = std::thread::id();
+    return n;
+}
+
+TEventQueueStats TGSCore::eventQueueStats() const {
+    std::shared_ptr<TEventQueue> queue = std::atomic_load(&_eventQueue);
+    if (queue)
+        return queue->stats();
+    TEventQueueStats s;
+    memset(&s, 0, sizeof(s));
+    return s;
+}
+
+//the entity id is taken from the registry if possible, it is cheaper than asking gsCore
+void TGSCore::recordEvent(int eventId, TEntityHandle hEntity) {
+    const char *entityId = NULL;
+    std::shared_ptr<const TEntityRegistry> reg;
+    if (hEntity != INVALID_GS_HANDLE) {
+        reg = std::atomic_load(&_registry);
+        int index = reg ? reg->indexOfHandle(hEntity) : -1;
+        entityId = index >= 0 ? reg->id(index) : gsGetEntityId(hEntity);
+    }
+    _recorder.record(eventId, entityId);
+}
+
+void TGSCore::dumpRecorder() {
+    std::lock_guard<std::mutex> lock(_recorderLock);
+    if (!_recorderDumpFile.empty()) {
+        _recorder.dump(_recorderDumpFile.c_str());
+        return;
+    }
+    std::string s = _recorder.dump();
+    for (size_t begin = 0, end; begin < s.size(); begin = end + 1) {
+        end = s.find('\n', begin);
+        gsTrace(s.substr(begin, end - begin).c_str());
+    }
+}
+
+void TGSCore::setEventRecorderDumpFile(const char *fileName) {
+    std::lock_guard<std::mutex> lock(_recorderLock);
+    _recorderDumpFile = fileName ? fileName : "";
+}
+
+void TGSCore::journalEvent(int eventId, TEventType type, TEventHandle hEvent) {
+    std::shared_ptr<TEventJournal> journal = std::atomic_load(&_journal);
+    if (!journal)
+        return;
+    unsigned int dataSize = 0;
+    void *data = type == EVENT_TYPE_USER ? gsGetUserEventData(hEvent, &dataSize) : NULL;
+    bool failedBefore = journal->failed();
+    if (!journal->write(eventId, type, type == EVENT_TYPE_ENTITY ? gsGetEntityId(gsGetEventSource(hEvent)) : NULL, data, dataSize) &&
+        !failedBefore)
+        gsTrace("Event journal cannot be written, the events are no longer journaled");
+}
+
+void TGSCore::startEventJournal(const char *fileName) {
+    std::atomic_store(&_journal, std::make_shared<TEventJournal>(fileName, true));
+}
+
+bool TGSCore::stopEventJournal() {
+    std::shared_ptr<TEventJournal> journal = std::atomic_exchange(&_journal, std::shared_ptr<TEventJournal>());
+    return !journal || journal->flush();
+}
+
+//_subscribeLock held
+void TGSCore::publishSubscribers(const TSubscriberList *list) {
+    const TSubscriberList *old = _subscribers.exchange(list);
+    if (old)
+        _retiredSubscribers.push_back(old);
+    //a delivery starting from now on reads the new list
+    if (_delivering.load() == 0) {
+        for (const TSubscriberList *l : _retiredSubscribers)
+            delete l;
+        _retiredSubscribers.clear();
+    }
+}
+
+int TGSCore::subscribe(TGSEventSubscriber subscriber, void *usrData, const TEventMask &mask, entity_id_t entityId) {
+    std::shared_ptr<TSubscriber> sub = std::make_shared<TSubscriber>();
+    sub->fn = subscriber;
+    sub->usrData = usrData;
+    sub->mask = mask;
+    sub->entityId = entityId ? entityId : "";
+    sub->active = true;
+
+    std::lock_guard<std::mutex> lock(_subscribeLock);
+    sub->id = ++_lastSubscription;
+    const TSubscriberList *current = _subscribers.load();
+    TSubscriberList *list = current ? new TSubscriberList(*current) : new TSubscriberList();
+    list->subscribers.push_back(sub);
+    list->mask |= mask;
+    publishSubscribers(list);
+    return sub->id;
+}
+
+bool TGSCore::unsubscribe(int subscription) {
+    std::lock_guard<std::mutex> lock(_subscribeLock);
+    const TSubscriberList *current = _subscribers.load();
+    if (current == nullptr)
+        return false;
+
+    TSubscriberList *list = new TSubscriberList();
+    bool found = false;
+    for (const std::shared_ptr<TSubscriber> &sub : current->subscribers) {
+        if (sub->id == subscription) {
+            sub->active = false;
+            found = true;
+        } else {
+            list->subscribers.push_back(sub);
+            list->mask |= sub->mask;
+        }
+    }
+    if (!found) {
+        delete list;
+        return false;
+    }
+    publishSubscribers(list);
+    return true;
 }
 
 TGSCore::TGSCore() : _appEventHandler(NULL), _appEventUsrData(NULL),
                      _licEventHandler(NULL), _licEventUsrData(NULL), _entityEventHandler(NULL), _entityEventUsrData(NULL),
-                     _userEventHandler(NULL), _userEventUsrData(NULL) {
+                     _userEventHandler(NULL), _userEventUsrData(NULL), _licenseGeneration(0),
+                     _entitlements(nullptr), _reconcileInterval(1000), _reconcileNow(false), _reconcileStop(false),
+                     _deliveringThread(std::thread::id()), _dispatchMode(EVENT_DISPATCH_SYNC),
+                     _subscribers(nullptr), _delivering(0), _lastSubscription(0), _requestCodesGeneration(0), _requestCodesEpoch(0),
+                     _requestCodeEpoch(0), _requestCodeStats(), _policyTick(1000), _policyStop(false) {
+    for (int i = 0; i < MAX_POLICY_EVENT_ID; i++)
+        _policies[i].store(nullptr, std::memory_order_relaxed);
     gsCreateMonitorEx(s_monitorCallback, this, "$SDK");
 }
 
 TGSCore::~TGSCore() {
     cleanUp();
+    delete _subscribers.load();
+    for (const TSubscriberList *l : _retiredSubscribers)
+        delete l;
 }
 
 static TGSCore *s_core = nullptr;
@@ -500,15 +2166,34 @@ void TGSCore::finish() {
 }
 
 int TGSCore::cleanUp() {
-    return gsCleanUp();
-}
-
+    _userEventPoster.stop();
+    stopReconciler();
+    stopPolicyThread();
+    if (_deliveringThread.load() != std::this_thread::get_id())
+        setEventDispatch(EVENT_DISPATCH_SYNC);
+    else
+        stopDispatchFromHandler();
+    std::atomic_store(&_registry, std::shared_ptr<const TEntityRegistry>());
+    int rc = gsCleanUp();
+    //after the events fired by gsCleanUp()
+    stopEventJournal();
+    invalidateRequestCodes();
+    return rc;
+}
+
+//the registry is built right away, the entity events are delivered with the entity objects interned in it
 bool TGSCore::init(const char *productId, const char *productLic, const char *licPassword) {
-    return (0 == gsInit(productId, productLic, licPassword, NULL));
+    if (0 != gsInit(productId, productLic, licPassword, NULL))
+        return false;
+    entityRegistry();
+    return true;
 }
 
 bool TGSCore::init(const char *productId, const unsigned char *pLicData, int licSize, const char *licPassword) {
-    return (0 == gsInit(productId, pLicData, licSize, licPassword, NULL));
+    if (0 != gsInit(productId, pLicData, licSize, licPassword, NULL))
+        return false;
+    entityRegistry();
+    return true;
 }
 
 //Convert event id to human readable string, for debug purpose
@@ -556,19 +2241,48 @@ const char *TGSCore::getEventName(int eventId) {
 void TGSCore::flush() { gsFlush(); }
 
 TGSEntity *TGSCore::getEntityByIndex(int index) const {
-    int N = getTotalEntities();
-    if ((index >= 0) && (index < N))
-        return new TGSEntity(gsOpenEntityByIndex(index));
-
-    gs5_error::raise(GS_ERROR_INVALID_INDEX, "Index [%d] out of range [0, %d)", index, N);
+    return new TGSEntity(entityByIndex(index));
 }
 
 TGSEntity *TGSCore::getEntityById(entity_id_t entityId) const {
-    gs_handle_t h = gsOpenEntityById(entityId);
-    if (h != INVALID_GS_HANDLE)
-        return new TGSEntity(h);
+    int index = entityRegistry()->indexOf(entityId);
+    return new TGSEntity(index < 0 ? entityById(entityId) : gsOpenEntityByIndex(index));
+}
+
+Entity TGSCore::entity(int index) const {
+    return Entity(entityByIndex(index));
+}
+
+Entity TGSCore::entity(entity_id_t entityId) const {
+    int index = entityRegistry()->indexOf(entityId);
+    return Entity(index < 0 ? entityById(entityId) : gsOpenEntityByIndex(index));
+}
 
-    gs5_error::raise(GS_ERROR_INVALID_ENTITY, "Invalid EntityId (%s)", entityId);
+expected<Entity> TGSCore::tryEntity(int index) const {
+    return wrap<Entity>(tryEntityByIndex(index));
+}
+
+expected<Entity> TGSCore::tryEntity(entity_id_t entityId) const {
+    int index = entityRegistry()->indexOf(entityId);
+    if (index >= 0)
+        return Entity(gsOpenEntityByIndex(index));
+    return wrap<Entity>(tryEntityById(entityId));
+}
+
+std::shared_ptr<const TEntityRegistry> TGSCore::entityRegistry() const {
+    std::shared_ptr<const TEntityRegistry> reg = std::atomic_load(&_registry);
+    unsigned int gen = _licenseGeneration.load();
+    if (reg && reg->generation() == gen)
+        return reg;
+
+    std::lock_guard<std::mutex> lock(_registryLock);
+    reg = std::atomic_load(&_registry);
+    gen = _licenseGeneration.load();
+    if (!reg || reg->generation() != gen) {
+        reg = std::make_shared<const TEntityRegistry>(gen);
+        std::atomic_store(&_registry, reg);
+    }
+    return reg;
 }
 
 //Variables
@@ -582,11 +2296,7 @@ bool TGSCore::removeVariable(const char *varName) {
 }
 
 TGSVariable *TGSCore::getVariableByIndex(int index) const {
-    gs_handle_t h = gsGetVariableByIndex(index);
-    if (h != INVALID_GS_HANDLE)
-        return new TGSVariable(h);
-
-    gs5_error::raise(GS_ERROR_INVALID_INDEX, "Invalid Variable Index [%s]", index);
+    return new TGSVariable(variableByIndex(index));
 }
 
 TGSVariable *TGSCore::getVariableByName(const char *name) const {
@@ -597,12 +2307,59 @@ TGSVariable *TGSCore::getVariableByName(const char *name) const {
     gs5_error::raise(GS_ERROR_INVALID_NAME, "Invalid Variable Name [%s]", name);
 }
 
+Variable TGSCore::variable(const char *name) const {
+    expected<Variable> var = tryVariable(name);
+    if (!var)
+        gs5_error::raise(GS_ERROR_INVALID_NAME, "Invalid Variable Name [%s]", name);
+    return std::move(*var);
+}
+
+expected<Variable> TGSCore::tryVariable(const char *name) const {
+    gs_handle_t h = gsGetVariable(name);
+    if (h == INVALID_GS_HANDLE)
+        return gs_errc::invalid_name;
+    return Variable(h);
+}
+
+Variable TGSCore::variable(int index) const {
+    return Variable(variableByIndex(index));
+}
+
+expected<Variable> TGSCore::tryVariable(int index) const {
+    return wrap<Variable>(tryVariableByIndex(index));
+}
+
 //Request
 TGSRequest *TGSCore::createRequest() {
     return new TGSRequest(gsCreateRequest());
 }
 
+Request TGSCore::request() {
+    return Request(gsCreateRequest());
+}
+
+RequestBuilder TGSCore::requestBuilder() {
+    return RequestBuilder(request());
+}
+
+void TGSCore::registerRequestTemplate(RequestTemplate &&requestTemplate) {
+    std::shared_ptr<const RequestTemplate> t = std::make_shared<RequestTemplate>(std::move(requestTemplate));
+    std::lock_guard<std::mutex> lock(_requestTemplateLock);
+    _requestTemplates[t->name()] = t;
+}
+
+std::shared_ptr<const RequestTemplate> TGSCore::requestTemplate(const char *name) const {
+    std::lock_guard<std::mutex> lock(_requestTemplateLock);
+    auto it = _requestTemplates.find(name);
+    if (it == _requestTemplates.end())
+        gs5_error::raise(GS_ERROR_INVALID_NAME, "Request template [%s] not registered", name);
+    return it->second;
+}
+
 bool TGSCore::applyLicenseCode(const char *code, const char *sn, const char *snRef) {
+    //older cores do not take the serial number
+    if (!gsHasApi(ORD_APPLY_LICENSE_CODE_EX))
+        return gsApplyLicenseCode(code);
     return gsApplyLicenseCodeEx(code, sn, snRef);
 }
 
@@ -621,6 +2378,8 @@ bool TGSCore::renderHTML(const char *url, const char *title, int width, int heig
 }
 bool TGSCore::renderHTML(const char *url, const char *title, int width, int height,
                          bool resizable, bool exitAppWhenUIClosed, bool cleanUpAfterRendering) {
+    if (!gsHasApi(ORD_RENDER_HTML_EX))
+        return gsRenderHTML(url, title, width, height);
     return gsRenderHTMLEx(url, title, width, height, resizable, exitAppWhenUIClosed, cleanUpAfterRendering);
 }
 
@@ -629,6 +2388,13 @@ int TGSCore::lastErrorCode() { return gsGetLastErrorCode(); }
 
 const char *TGSCore::SDKVersion() { return gsGetVersion(); }
 
+std::bitset<SDK_MAX_API_ORDINAL + 1> TGSCore::capabilities() {
+    std::bitset<SDK_MAX_API_ORDINAL + 1> caps;
+    for (int ord = 0; ord <= SDK_MAX_API_ORDINAL; ord++)
+        caps[ord] = gsHasApi(ord);
+    return caps;
+}
+
 const char *TGSCore::productName() { return gsGetProductName(); }
 const char *TGSCore::productId() { return gsGetProductId(); }
 int TGSCore::buildId() { return gsGetBuildId(); }
@@ -638,21 +2404,96 @@ bool TGSCore::runInVM() { return gsRunInsideVM(0xFFFFFFFF); }
 int TGSCore::getTotalEntities() const { return gsGetEntityCount(); }
 
 void TGSCore::lockAllEntities() {
-    for (int i = 0; i < getTotalEntities(); i++) {
-        std::unique_ptr<TGSEntity> entity(getEntityByIndex(i));
-        entity->lock();
+    std::shared_ptr<const TEntityRegistry> reg = entityRegistry();
+    for (const Entity &entity : *reg) {
+        if (entity.hasLicense())
+            entity.license().lock();
     }
 }
 
 bool TGSCore::isAllEntitiesLocked() const {
-    for (int i = 0; i < getTotalEntities(); i++) {
-        std::unique_ptr<TGSEntity> entity(getEntityByIndex(i));
-        if (!entity->isLocked())
+    std::shared_ptr<const TEntityRegistry> reg = entityRegistry();
+    for (const Entity &entity : *reg) {
+        if (!entity.isLocked())
             return false;
     }
     return true;
 }
 
+//Entitlements
+TEntitlementMap *TGSCore::initEntitlements() {
+    reconcileEntitlements();
+    return _entitlements.load(std::memory_order_acquire);
+}
+
+//the monitor callback only reads the current registry, it is never rebuilt from within gsCore
+void TGSCore::updateEntitlement(TEntityHandle hEntity) {
+    TEntitlementMap *m = _entitlements.load(std::memory_order_acquire);
+    std::shared_ptr<const TEntityRegistry> reg = std::atomic_load(&_registry);
+    if (m == nullptr || !reg)
+        return;
+    int index = reg->indexOfHandle(hEntity);
+    if (index < 0)
+        index = reg->indexOf(gsGetEntityId(hEntity));
+    if (index >= 0 && index < m->size())
+        m->set(index, gsGetEntityAttributes(hEntity));
+}
+
+void TGSCore::reconcileEntitlements() {
+    std::shared_ptr<const TEntityRegistry> reg = entityRegistry();
+
+    std::lock_guard<std::mutex> lock(_entitlementLock);
+    TEntitlementMap *m = _entitlements.load(std::memory_order_relaxed);
+    bool publish = (m == nullptr || m->size() != reg->size());
+    if (publish) {
+        _entitlementMaps.push_back(std::unique_ptr<TEntitlementMap>(new TEntitlementMap(reg->size())));
+        m = _entitlementMaps.back().get();
+    }
+    for (int i = 0; i < reg->size(); i++)
+        m->set(i, gsGetEntityAttributes((*reg)[i].handle()));
+    if (publish)
+        _entitlements.store(m, std::memory_order_release);
+
+    //reconciled periodically from now on
+    std::lock_guard<std::mutex> reconcileLock(_reconcileLock);
+    if (!_reconciler.joinable() && !_reconcileStop)
+        _reconciler = std::thread(&TGSCore::reconcileProc, this);
+}
+
+void TGSCore::setEntitlementReconcileInterval(int ms) {
+    std::lock_guard<std::mutex> lock(_reconcileLock);
+    _reconcileInterval = ms;
+    _reconcileNow = true;
+    _reconcileCV.notify_one();
+}
+
+void TGSCore::reconcileProc() {
+    std::unique_lock<std::mutex> lock(_reconcileLock);
+    auto woken = [this] { return _reconcileStop || _reconcileNow; };
+    while (!_reconcileStop) {
+        if (_reconcileInterval > 0)
+            _reconcileCV.wait_for(lock, std::chrono::milliseconds(_reconcileInterval), woken);
+        else
+            _reconcileCV.wait(lock, woken);
+        if (_reconcileStop)
+            break;
+        _reconcileNow = false;
+        lock.unlock();
+        reconcileEntitlements();
+        lock.lock();
+    }
+}
+
+void TGSCore::stopReconciler() {
+    {
+        std::lock_guard<std::mutex> lock(_reconcileLock);
+        _reconcileStop = true;
+        _reconcileCV.notify_one();
+    }
+    if (_reconciler.joinable())
+        _reconciler.join();
+}
+
 //Debug Helpers (v5.0.14.0+)
 bool TGSCore::isDebugVersion() {
     return gsIsDebugVersion();
@@ -663,24 +2504,43 @@ void TGSCore::trace(const char *msg) {
 }
 
 std::string TGSCore::getFixRequestCode() {
-    std::unique_ptr<TGSRequest> req(this->createRequest());
-    std::unique_ptr<TGSAction> act(req->addAction(ACT_FIX));
-    return req->code();
+    return requestCode(ACT_FIX);
 }
 std::string TGSCore::getUnlockRequestCode() {
-    std::unique_ptr<TGSRequest> req(this->createRequest());
-    std::unique_ptr<TGSAction> act(req->addAction(ACT_UNLOCK));
-    return req->code();
+    return requestCode(ACT_UNLOCK);
 }
 std::string TGSCore::getCleanRequestCode() {
-    std::unique_ptr<TGSRequest> req(this->createRequest());
-    std::unique_ptr<TGSAction> act(req->addAction(ACT_CLEAN));
-    return req->code();
+    return requestCode(ACT_CLEAN);
 }
 std::string TGSCore::getDummyRequestCode() {
-    std::unique_ptr<TGSRequest> req(this->createRequest());
-    std::unique_ptr<TGSAction> act(req->addAction(ACT_DUMMY));
-    return req->code();
+    return requestCode(ACT_DUMMY);
+}
+
+//the generation and epoch are read before the code is built, a change meanwhile drops it on the next call
+std::string TGSCore::requestCode(action_id_t actId, entity_id_t entityId) {
+    unsigned int gen = _licenseGeneration.load();
+    unsigned int epoch = _requestCodeEpoch.load();
+    std::lock_guard<std::mutex> lock(_requestCodeLock);
+    if (gen != _requestCodesGeneration || epoch != _requestCodesEpoch) {
+        _requestCodes.clear();
+        _requestCodesGeneration = gen;
+        _requestCodesEpoch = epoch;
+    }
+    std::pair<action_id_t, std::string> key(actId, entityId ? entityId : "");
+    auto it = _requestCodes.find(key);
+    if (it != _requestCodes.end()) {
+        _requestCodeStats.hits++;
+        return it->second;
+    }
+    Request req = request();
+    Action act = req.addAction(actId, entityId);
+    _requestCodeStats.misses++;
+    return _requestCodes.emplace(key, req.code()).first->second;
+}
+
+TRequestCodeStats TGSCore::requestCodeStats() const {
+    std::lock_guard<std::mutex> lock(_requestCodeLock);
+    return _requestCodeStats;
 }
 
 /// Auto destroy TCore shared instance when not used.
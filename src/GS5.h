@@ -6,10 +6,21 @@
 #ifndef _GS5_WRAP_H_
 #define _GS5_WRAP_H_
 
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
 #include <cassert>
+#include <condition_variable>
 #include <exception>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "GS5_Intf.h"
 
@@ -49,6 +60,11 @@ enum {
 
 #endif
 
+#if ((defined(_MSVC_LANG) && _MSVC_LANG >= 201703L) || __cplusplus >= 201703L)
+#include <string_view>
+#define GS_HAS_STRING_VIEW
+#endif
+
 //GS5 exception
 class gs5_error : public std::exception {
   private:
@@ -72,6 +88,148 @@ class gs5_error : public std::exception {
     static NORETURN void raise(int code, const char *message, ...);
 };
 
+/** @name Non-throwing api [ C++ Only ]
+ *
+ *  The value objects and TGSCore provide a try* counterpart for every lookup (entity, variable, license and action
+ *  parameter) and value conversion which raises gs5_error, returning expected<T> instead. A failure is reported as a
+ *  gs_errc only: no message is formatted and nothing is allocated, so a missing parameter or entity can be handled
+ *  as a normal case:
+ *
+ *  \code
+ *  expected<int> tolerance = license.tryGetParamInt("rollbackTolerance");
+ *  if (tolerance)
+ *      ... *tolerance ...
+ *  else if (tolerance.error() == gs_errc::invalid_name)
+ *      ...
+ *  \endcode
+ *
+ *  The throwing calls are implemented on top of them. The other calls raising gs5_error, such as
+ *  TGSCore::requestTemplate() or TGSCore::startEventJournal(), report a misuse or an I/O failure and have no try*
+ *  counterpart.
+ */
+//@{
+/// Error code (same values as GS_ERROR_xxx)
+enum class gs_errc : int {
+    ok = 0,
+    generic = GS_ERROR_GENERIC,
+    invalid_handle = GS_ERROR_INVALID_HANDLE,
+    invalid_index = GS_ERROR_INVALID_INDEX,
+    invalid_name = GS_ERROR_INVALID_NAME,
+    invalid_action = GS_ERROR_INVALID_ACTION,
+    invalid_license = GS_ERROR_INVALID_LICENSE,
+    invalid_entity = GS_ERROR_INVALID_ENTITY,
+    invalid_value = GS_ERROR_INVALID_VALUE
+};
+
+/// Static description of an error code
+const char *gs_errc_message(gs_errc e);
+
+/// Either a value or the error code of the failure
+template <typename T>
+class NODISCARD expected {
+  private:
+    T _value;
+    gs_errc _error;
+
+  public:
+    expected(T &&v) : _value(std::move(v)), _error(gs_errc::ok) {}
+    expected(const T &v) : _value(v), _error(gs_errc::ok) {}
+    expected(gs_errc e) : _value(), _error(e) {}
+
+    bool has_value() const { return _error == gs_errc::ok; }
+    explicit operator bool() const { return has_value(); }
+    gs_errc error() const { return _error; }
+    /// Description of the error, only built when asked for
+    const char *message() const { return gs_errc_message(_error); }
+
+    /// The value, raises gs5_error if none
+    T &value() {
+        if (!has_value())
+            throw gs5_error(message(), (int)_error);
+        return _value;
+    }
+    const T &value() const {
+        if (!has_value())
+            throw gs5_error(message(), (int)_error);
+        return _value;
+    }
+    /// The value, or a default one if none
+    T value_or(const T &def) const { return has_value() ? _value : def; }
+
+    T &operator*() { return _value; }
+    const T &operator*() const { return _value; }
+    T *operator->() { return &_value; }
+    const T *operator->() const { return &_value; }
+};
+
+/// Success or the error code of the failure
+template <>
+class NODISCARD expected<void> {
+  private:
+    gs_errc _error;
+
+  public:
+    expected() : _error(gs_errc::ok) {}
+    expected(gs_errc e) : _error(e) {}
+
+    bool has_value() const { return _error == gs_errc::ok; }
+    explicit operator bool() const { return has_value(); }
+    gs_errc error() const { return _error; }
+    const char *message() const { return gs_errc_message(_error); }
+
+    /// Raises gs5_error on failure
+    void value() const {
+        if (!has_value())
+            throw gs5_error(message(), (int)_error);
+    }
+};
+//@}
+
+/** \brief Borrowed string [ C++ Only ]
+ *
+ *  A string owned by gsCore, referred to without being copied. It is only valid as long as its owner:
+ *
+ *  - a string of an object (entity, license, request code, move package data) lives as long as the object;
+ *  - a variable or parameter value (Variable::asStringView(), getParamStrView()) and a string returned by TGSCore
+ *    (preliminary SN, exported app...) live until the next gsCore call from the same thread: gsCore may hand them
+ *    out in a single per-thread buffer, so reading another value can overwrite a view taken before.
+ *
+ *  Copy it (str()) to keep it longer. Converts to std::string_view in C++17.
+ */
+class string_view {
+  private:
+    const char *_data;
+    size_t _size;
+
+  public:
+    string_view() : _data(""), _size(0) {}
+    string_view(const char *s) : _data(s ? s : ""), _size(s ? strlen(s) : 0) {}
+    string_view(const char *s, size_t n) : _data(s), _size(n) {}
+
+    const char *data() const { return _data; }
+    size_t size() const { return _size; }
+    size_t length() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const char *begin() const { return _data; }
+    const char *end() const { return _data + _size; }
+    char operator[](size_t i) const { return _data[i]; }
+
+    /// Copies the string
+    std::string str() const { return std::string(_data, _size); }
+    explicit operator std::string() const { return str(); }
+#ifdef GS_HAS_STRING_VIEW
+    operator std::string_view() const { return std::string_view(_data, _size); }
+#endif
+
+    int compare(string_view rhs) const {
+        int r = memcmp(_data, rhs._data, _size < rhs._size ? _size : rhs._size);
+        return r != 0 ? r : (_size < rhs._size ? -1 : (_size > rhs._size ? 1 : 0));
+    }
+    friend bool operator==(string_view a, string_view b) { return a._size == b._size && memcmp(a._data, b._data, a._size) == 0; }
+    friend bool operator!=(string_view a, string_view b) { return !(a == b); }
+    friend bool operator<(string_view a, string_view b) { return a.compare(b) < 0; }
+};
+
 /** \brief Base of GS5 Objects
   *
   * In C++, the OOP-SDK apis return pointer to an instance of TGSObject subclass, the caller must delete it later to avoid memory leakage.
@@ -329,6 +487,8 @@ class TGSLicense : public TGSObject {
     //@{
     /// Gets parameter value as a string
     std::string getParamStr(const char *name);
+    /// Parameter value as a borrowed string, valid until the next gsCore call from this thread (ref: gs::string_view)
+    string_view getParamStrView(const char *name);
     /// Sets parameter value from a string
     void setParamStr(const char *name, const char *v);
 
@@ -539,6 +699,10 @@ class TMovePackage : public TGSObject {
     std::string exportData() {
         return gsMPExport(_handle);
     }
+    /// Same as exportData(), without copying the data. Valid while the move package is alive.
+    string_view exportDataView() {
+        return gsMPExport(_handle);
+    }
 
     const char *getImportOfflineRequestCode() {
         return gsMPGetImportOfflineRequestCode(_handle);
@@ -581,10 +745,807 @@ class TCodeExchange : public TGSObject {
     }
 };
 
+/** @name Value objects [ C++ Only ]
+ *
+ *  Move-only counterparts of TGSEntity, TGSLicense, TGSVariable, TGSAction and TGSRequest.
+ *
+ *  They are returned by value instead of being allocated on the heap, live on the stack or directly in containers
+ *  (std::vector<Entity>...), and close their handle when destroyed:
+ *
+ *  \code
+ *  Entity entity = core->entity("e1");
+ *  time_t expire = entity.license().getParamUTCTime("endDate");
+ *  \endcode
+ */
+//@{
+/// Owns a GS5 object handle, which is closed when the object is destroyed
+class Object {
+  protected:
+    gs_handle_t _handle;
+
+  public:
+    Object() : _handle(INVALID_GS_HANDLE) {}
+    explicit Object(gs_handle_t handle) : _handle(handle) {}
+    Object(Object &&rhs) noexcept : _handle(rhs._handle) { rhs._handle = INVALID_GS_HANDLE; }
+    Object &operator=(Object &&rhs) noexcept {
+        if (this != &rhs) {
+            close();
+            _handle = rhs._handle;
+            rhs._handle = INVALID_GS_HANDLE;
+        }
+        return *this;
+    }
+    Object(const Object &) = delete;
+    Object &operator=(const Object &) = delete;
+    ~Object() { close(); }
+
+    ///Gets GS5 object handle
+    gs_handle_t handle() const { return _handle; }
+    /// Is a handle owned?
+    explicit operator bool() const { return _handle != INVALID_GS_HANDLE; }
+    /// Closes the handle now
+    void close() {
+        if (_handle != INVALID_GS_HANDLE) {
+            gsCloseHandle(_handle);
+            _handle = INVALID_GS_HANDLE;
+        }
+    }
+    /// Gives up the handle without closing it, the caller must close it.
+    gs_handle_t release() {
+        gs_handle_t h = _handle;
+        _handle = INVALID_GS_HANDLE;
+        return h;
+    }
+};
+
+/// User defined variable, or parameter of action / license (ref: TGSVariable)
+class Variable : public Object {
+  public:
+    Variable() {}
+    explicit Variable(TVarHandle handle) : Object(handle) {}
+
+    /** @name Value Accessor */
+    //@{
+    void fromString(const char *v);
+    void fromInt(int v);
+    void fromBool(bool v);
+    void fromInt64(int64_t v);
+    void fromFloat(float v);
+    void fromDouble(double v);
+    void fromUTCTime(time_t t);
+
+    const char *asString() const;
+    int asInt() const;
+    bool asBool() const;
+    int64_t asInt64() const;
+    float asFloat() const;
+    double asDouble() const;
+    time_t asUTCTime() const;
+    /// get value as a borrowed string, valid until the next gsCore call from this thread (ref: gs::string_view)
+    string_view asStringView() const { return asString(); }
+    //@}
+
+    /** @name Value Accessor, non-throwing */
+    //@{
+    expected<void> tryFromString(const char *v);
+    expected<void> tryFromInt(int v);
+    expected<void> tryFromBool(bool v);
+    expected<void> tryFromInt64(int64_t v);
+    expected<void> tryFromFloat(float v);
+    expected<void> tryFromDouble(double v);
+    expected<void> tryFromUTCTime(time_t t);
+
+    expected<int> tryAsInt() const;
+    expected<bool> tryAsBool() const;
+    expected<int64_t> tryAsInt64() const;
+    expected<float> tryAsFloat() const;
+    expected<double> tryAsDouble() const;
+    expected<time_t> tryAsUTCTime() const;
+    //@}
+
+    /// get the variable name
+    const char *name() const;
+    /// get the variable type id. (ref: \ref varType)
+    var_type_t typeId() const;
+    /// get the variable attribute (ref: \ref varAttr)
+    std::string attribute() const;
+};
+
+/// Action (ref: TGSAction)
+class Action : public Object {
+  public:
+    Action() {}
+    explicit Action(TActionHandle handle) : Object(handle) {}
+
+    const char *name() const;
+    action_id_t id() const;
+    const char *description() const;
+    const char *whatToDo() const;
+
+    int paramCount() const;
+    /// Gets action parameter by its index, range [0, paramCount()-1 ]
+    Variable param(int index) const;
+    /// Gets action parameter by its name
+    Variable param(const char *name) const;
+
+    expected<Variable> tryParam(int index) const;
+    expected<Variable> tryParam(const char *name) const;
+};
+
+class Entity;
+class Request;
+
+/// License (ref: TGSLicense)
+class License : public Object {
+  public:
+    License() {}
+    explicit License(TLicenseHandle handle) : Object(handle) {}
+
+    const char *id() const;
+    const char *name() const;
+    const char *description() const;
+    TLicenseStatus status() const;
+    bool isValid() const;
+    void lock();
+
+    /// Gets the entity this license is attached to, empty if not attached
+    Entity entity() const;
+    /// Gets a request code to unlock this license only.
+    std::string getUnlockRequestCode() const;
+    /// Gets a request to unlock this license only, its code() is valid while it is alive
+    Request unlockRequest() const;
+
+    /** @name License Parameter APIs */
+    //@{
+    int paramCount() const;
+    /// Gets the license parameter by its index, range [0, paramCount()-1 ]
+    Variable param(int index) const;
+    /// Gets the license parameter by its name
+    Variable param(const char *name) const;
+
+    std::string getParamStr(const char *name) const;
+    /// Parameter value as a borrowed string, valid until the next gsCore call from this thread (ref: gs::string_view)
+    string_view getParamStrView(const char *name) const;
+    void setParamStr(const char *name, const char *v);
+    int getParamInt(const char *name) const;
+    void setParamInt(const char *name, int v);
+    int64_t getParamInt64(const char *name) const;
+    void setParamInt64(const char *name, int64_t v);
+    bool getParamBool(const char *name) const;
+    void setParamBool(const char *name, bool v);
+    double getParamDouble(const char *name) const;
+    void setParamDouble(const char *name, double v);
+    float getParamFloat(const char *name) const;
+    void setParamFloat(const char *name, float v);
+    time_t getParamUTCTime(const char *name) const;
+    void setParamUTCTime(const char *name, time_t v);
+    //@}
+
+    /** @name License Parameter APIs, non-throwing */
+    //@{
+    expected<Variable> tryParam(int index) const;
+    expected<Variable> tryParam(const char *name) const;
+
+    expected<std::string> tryGetParamStr(const char *name) const;
+    expected<void> trySetParamStr(const char *name, const char *v);
+    expected<int> tryGetParamInt(const char *name) const;
+    expected<void> trySetParamInt(const char *name, int v);
+    expected<int64_t> tryGetParamInt64(const char *name) const;
+    expected<void> trySetParamInt64(const char *name, int64_t v);
+    expected<bool> tryGetParamBool(const char *name) const;
+    expected<void> trySetParamBool(const char *name, bool v);
+    expected<double> tryGetParamDouble(const char *name) const;
+    expected<void> trySetParamDouble(const char *name, double v);
+    expected<float> tryGetParamFloat(const char *name) const;
+    expected<void> trySetParamFloat(const char *name, float v);
+    expected<time_t> tryGetParamUTCTime(const char *name) const;
+    expected<void> trySetParamUTCTime(const char *name, time_t v);
+    //@}
+
+    /// Gets total number of actions appliable to a license (ref: \ref ActionInfo)
+    int actionCount() const;
+    /// Gets action id by index (ref: \ref ActionInfo)
+    action_id_t actionIds(int index) const;
+    /// Gets action name by index (ref: \ref ActionInfo)
+    const char *actionNames(int index) const;
+};
+
+/// Request (ref: TGSRequest)
+class Request : public Object {
+  public:
+    Request() {}
+    explicit Request(TRequestHandle handle) : Object(handle) {}
+
+    /// adds a global action targeting all entities
+    Action addAction(action_id_t actId);
+    /// adds an action targeting all licenses of an entity
+    Action addAction(action_id_t actId, const Entity &entity);
+    /// adds an action targeting all licenses of an entity
+    Action addAction(action_id_t actId, const char *entityId);
+
+    expected<Action> tryAddAction(action_id_t actId);
+    expected<Action> tryAddAction(action_id_t actId, const Entity &entity);
+    expected<Action> tryAddAction(action_id_t actId, const char *entityId);
+
+    /// gets the request string code (ref: \ref requestCode "Request Code"), valid while the request is alive
+    const char *code() const;
+};
+
+/// Entity (ref: TGSEntity)
+class Entity : public Object {
+  public:
+    Entity() {}
+    explicit Entity(TEntityHandle handle) : Object(handle) {}
+
+    bool isAccessible() const { return (attribute() & ENTITY_ATTRIBUTE_ACCESSIBLE) != 0; }
+    bool isAccessing() const { return (attribute() & ENTITY_ATTRIBUTE_ACCESSING) != 0; }
+    bool isUnlocked() const { return (attribute() & ENTITY_ATTRIBUTE_UNLOCKED) != 0; }
+    bool isLocked() const { return (attribute() & ENTITY_ATTRIBUTE_LOCKED) != 0; }
+
+    /// Try start accessing an entity (ref: TGSEntity::beginAccess())
+    bool beginAccess();
+    /// Try end accessing an entity (ref: TGSEntity::endAccess())
+    bool endAccess();
+    /// Lock the bundled license
+    void lock();
+    /// Get the *Unlock* request code to unlock all attached license(s)
+    std::string getUnlockRequestCode() const;
+    /// Get the *Unlock* request, its code() is valid while it is alive
+    Request unlockRequest() const;
+
+    /// Entity Attributes (ref: \ref EntityAttr)
+    unsigned int attribute() const;
+    const char *id() const;
+    const char *name() const;
+    const char *description() const;
+
+    /// Is a licene attached to this entity?
+    bool hasLicense() const;
+    /// Get the attached license
+    License license() const;
+    /// Get the attached license, gs_errc::invalid_license if none
+    expected<License> tryLicense() const;
+};
+//@}
+
+/** \brief Entity registry [ C++ Only ]
+ *
+ *  Snapshot of all entities of the application: every entity is opened once, and its id is interned in a hash table,
+ *  so that looking up an entity by id is O(1) and walking through the entities allocates nothing:
+ *
+ *  \code
+ *  std::shared_ptr<const TEntityRegistry> reg = core->entityRegistry();
+ *  for (const Entity &e : *reg)
+ *      if (e.isUnlocked()) ...
+ *
+ *  if (const Entity *e = reg->find("e1")) ...
+ *  \endcode
+ *
+ *  A snapshot never changes once built, it can be used by any thread and its entities stay open as long as it is
+ *  referenced. TGSCore builds a new one on demand after the license is loaded (EVENT_LICENSE_READY) or an action
+ *  is applied (EVENT_ENTITY_ACTION_APPLIED).
+ */
+class TEntityRegistry {
+  private:
+    unsigned int _generation;
+    std::vector<Entity> _entities;
+    std::string _ids;                  //interned ids, '\0' terminated
+    std::vector<size_t> _idOffsets;    //offsets of ids in _ids
+    std::vector<unsigned int> _hashes; //hashes of ids
+    std::vector<int> _slots;           //open addressing hash table of entity indexes (-1: empty), size is a power of 2
+    std::vector<int> _handleSlots;     //same, by entity handle
+    std::vector<std::unique_ptr<TGSEntity>> _objects; //interned entity objects, handed to the entity event handlers
+
+    static unsigned int hash(const char *s);
+    static unsigned int hash(TEntityHandle handle);
+
+    TEntityRegistry(const TEntityRegistry &) = delete;
+    TEntityRegistry &operator=(const TEntityRegistry &) = delete;
+
+  public:
+    /// Opens all entities of the application, generation: the license change this snapshot is taken after
+    explicit TEntityRegistry(unsigned int generation = 0);
+
+    unsigned int generation() const { return _generation; }
+
+    /// Total entities
+    int size() const { return (int)_entities.size(); }
+    /// Entity by index ( 0 <= index < size() )
+    const Entity &operator[](int index) const { return _entities[index]; }
+    /// Entity id by index, the string is owned by the registry
+    const char *id(int index) const { return _ids.c_str() + _idOffsets[index]; }
+
+    /// Index of an entity, -1 if not found
+    int indexOf(entity_id_t entityId) const;
+    /// Index of an entity by a handle to it (e.g. an event source), -1 if not known
+    int indexOfHandle(TEntityHandle handle) const;
+    /// Entity object by index ( 0 <= index < size() ), owned by the registry
+    TGSEntity *object(int index) const { return _objects[index].get(); }
+    /// Entity by id, nullptr if not found
+    const Entity *find(entity_id_t entityId) const {
+        int index = indexOf(entityId);
+        return index < 0 ? nullptr : &_entities[index];
+    }
+
+    const Entity *begin() const { return _entities.data(); }
+    const Entity *end() const { return _entities.data() + _entities.size(); }
+};
+
+/** \brief Entitlement bitmap [ C++ Only ]
+ *
+ *  The ENTITY_ATTRIBUTE_ACCESSIBLE / UNLOCKED / ACCESSING / LOCKED bits of every entity, 16 entities per 64-bit atomic
+ *  word, indexed as in TEntityRegistry. Reading the bits of an entity is one relaxed atomic load.
+ *
+ *  Maintained by TGSCore (ref: TGSCore::entityAttributes()).
+ */
+class TEntitlementMap {
+  private:
+    int _count;
+    std::unique_ptr<std::atomic<uint64_t>[]> _words;
+
+    TEntitlementMap(const TEntitlementMap &) = delete;
+    TEntitlementMap &operator=(const TEntitlementMap &) = delete;
+
+  public:
+    /// Attribute bits kept
+    static const unsigned int MASK = ENTITY_ATTRIBUTE_ACCESSIBLE | ENTITY_ATTRIBUTE_UNLOCKED | ENTITY_ATTRIBUTE_ACCESSING | ENTITY_ATTRIBUTE_LOCKED;
+
+    explicit TEntitlementMap(int count);
+
+    int size() const { return _count; }
+    /// Attribute bits of an entity ( 0 <= index < size() )
+    unsigned int get(int index) const {
+        return (unsigned int)(_words[index / 16].load(std::memory_order_relaxed) >> (index % 16 * 4)) & MASK;
+    }
+    /// Updates the attribute bits of an entity ( 0 <= index < size() )
+    void set(int index, unsigned int attr);
+};
+
+/// How the event handlers are called (ref: TGSCore::setEventDispatch())
+enum TEventDispatchMode {
+    EVENT_DISPATCH_SYNC = 0,   ///< from the thread the event is fired from (default)
+    EVENT_DISPATCH_THREAD = 1, ///< from a dispatcher thread
+    EVENT_DISPATCH_PUMP = 2    ///< from TGSCore::dispatchPending(), called by the application
+};
+
+/// What to do with a new event when the event queue is full
+enum TEventBackpressure {
+    EVENT_QUEUE_DROP_NEWEST = 0, ///< the new event is dropped
+    EVENT_QUEUE_DROP_OLDEST = 1, ///< the oldest pending event is dropped
+    EVENT_QUEUE_BLOCK = 2        ///< the firing thread waits for room (the new event is dropped if it is the delivering thread), EVENT_DISPATCH_THREAD only
+};
+
+/// Event copied out of gsCore for deferred delivery
+struct TQueuedEvent {
+    int eventId;
+    TEventType type;
+    std::string entityId;            ///< source entity of an entity event
+    std::vector<unsigned char> data; ///< event data of a user event
+};
+
+/// Event queue counters
+struct TEventQueueStats {
+    uint64_t queued;    ///< events queued
+    uint64_t delivered; ///< events taken out for delivery
+    uint64_t dropped;   ///< events dropped, by backpressure or queued while the queue is being closed
+    int pending;        ///< events in the queue
+    int highWater;      ///< most events ever in the queue
+};
+
+/** \brief Bounded event queue [ C++ Only ]
+ *
+ *  Filled by any thread gsCore fires events from, emptied by a single delivering thread. The slots are allocated
+ *  once, an event popped is swapped out of its slot so that the string buffers are reused.
+ */
+class TEventQueue {
+  private:
+    std::vector<TQueuedEvent> _slots;
+    int _head;  //oldest event
+    int _count; //pending events
+    TEventBackpressure _backpressure;
+    bool _closed;
+    TEventQueueStats _stats;
+    mutable std::mutex _lock;
+    std::condition_variable _notEmpty;
+    std::condition_variable _notFull;
+
+    TEventQueue(const TEventQueue &) = delete;
+    TEventQueue &operator=(const TEventQueue &) = delete;
+
+  public:
+    TEventQueue(int capacity, TEventBackpressure backpressure);
+
+    int capacity() const { return (int)_slots.size(); }
+    /// Copies an event into the queue, returns false if dropped. A full queue with EVENT_QUEUE_BLOCK waits for room only if mayBlock.
+    bool push(int eventId, TEventType type, const char *entityId, const void *data, unsigned int dataSize, bool mayBlock);
+    /// Takes out the oldest event, waits for one if wait, returns false if there is none (or closed and empty)
+    bool pop(TQueuedEvent &evt, bool wait);
+    /// Closes the queue: nothing is queued anymore, waiting threads are woken up. discard: drops the pending events too.
+    void close(bool discard = false);
+    TEventQueueStats stats() const;
+};
+
+/// Kind of event delivery policy (ref: TEventPolicy)
+enum TEventPolicyKind {
+    EVENT_POLICY_ALL = 0,           ///< every event is delivered (default)
+    EVENT_POLICY_COALESCE = 1,      ///< the first event is delivered, the ones within the next param ms are dropped
+    EVENT_POLICY_LAST_IN_BURST = 2, ///< only the last event of a burst is delivered, once none comes for param ms
+    EVENT_POLICY_SAMPLE = 3         ///< every param-th event is delivered (the 1st, param+1-th...)
+};
+
+/** \brief Delivery policy of an event id (ref: TGSCore::setEventPolicy())
+ *
+ *  Entity events are counted per entity: the heartbeats of an entity never suppress the ones of another.
+ */
+struct TEventPolicy {
+    TEventPolicyKind kind;
+    int param;
+
+    static TEventPolicy all() { return {EVENT_POLICY_ALL, 0}; }
+    static TEventPolicy coalesce(int ms) { return {EVENT_POLICY_COALESCE, ms}; }
+    static TEventPolicy lastInBurst(int ms) { return {EVENT_POLICY_LAST_IN_BURST, ms}; }
+    static TEventPolicy sample(int k) { return {EVENT_POLICY_SAMPLE, k}; }
+};
+
+/// Counters of an event delivery policy
+struct TEventPolicyStats {
+    uint64_t delivered;  ///< events passed on to the handlers
+    uint64_t suppressed; ///< events dropped by the policy
+};
+
+/** \brief Event flight recorder [ C++ Only ]
+ *
+ *  The last capacity() events, recorded lock-free into a ring of fixed-size slots: a writer claims a slot with one
+ *  atomic increment, then stamps it with its position once written, so a reader skips the slots being written.
+ *  Recording an event costs a few tens of nanoseconds, TGSCore keeps one recording all the events it receives
+ *  (ref: TGSCore::eventRecorder()).
+ */
+class TEventRecorder {
+  public:
+    /// Max length of an entity id recorded, longer ones are truncated
+    enum { MAX_ENTITY_ID = 47 };
+
+    /// A recorded event
+    struct TRecord {
+        uint64_t seq;                     ///< position in the recording
+        int64_t time;                     ///< nanoseconds since the recorder was created (monotonic)
+        int eventId;                      ///< ref: TGSCore::getEventName()
+        uint64_t thread;                  ///< hash of the firing thread's id
+        char entityId[MAX_ENTITY_ID + 1]; ///< source entity of an entity event, empty otherwise
+    };
+
+  private:
+    struct TSlot {
+        std::atomic<uint64_t> seq; //position + 1, 0 while being written
+        std::atomic<int64_t> time;
+        std::atomic<int> eventId;
+        std::atomic<uint64_t> thread;
+        std::atomic<uint64_t> entityId[(MAX_ENTITY_ID + 1) / 8];
+    };
+
+    std::unique_ptr<TSlot[]> _slots;
+    uint64_t _mask;
+    std::atomic<uint64_t> _next;
+    std::chrono::steady_clock::time_point _start;
+
+    TEventRecorder(const TEventRecorder &) = delete;
+    TEventRecorder &operator=(const TEventRecorder &) = delete;
+
+  public:
+    /// capacity: events kept, rounded up to a power of 2
+    explicit TEventRecorder(int capacity = 1024);
+
+    int capacity() const { return (int)(_mask + 1); }
+    /// Total events recorded so far
+    uint64_t recorded() const { return _next.load(std::memory_order_relaxed); }
+
+    void record(int eventId, const char *entityId);
+    /// The events kept, oldest first
+    std::vector<TRecord> records() const;
+    /// The events kept, one line each
+    std::string dump() const;
+    /// Writes dump() to a file, returns false if it cannot be written
+    bool dump(const char *fileName) const;
+};
+
+/** \brief Event journal [ C++ Only ]
+ *
+ *  A binary file of the events received by TGSCore (ref: TGSCore::startEventJournal()). Each event is one record:
+ *  the time elapsed since the previous event, event id, event type, source entity id and user event data, with the
+ *  integers written as varints, so a heartbeat takes a few bytes plus its entity id.
+ *
+ *  Replayed into a TGSApp by TGSApp::replayEvents(), which needs no wrapped binary.
+ */
+class TEventJournal {
+  public:
+    /// A journaled event
+    struct TEntry {
+        uint64_t delay;                  ///< microseconds since the previous event
+        unsigned int eventId;            ///< ref: TGSCore::getEventName()
+        TEventType type;                 ///< event type
+        std::string entityId;            ///< source entity of an entity event, empty otherwise
+        std::vector<unsigned char> data; ///< user event data
+    };
+
+  private:
+    FILE *_file;
+    bool _writing;
+    uint64_t _size; //file size when opened for reading
+    std::atomic<bool> _failed; //a write failed, nothing is written any more
+    std::mutex _lock;
+    std::chrono::steady_clock::time_point _last;
+    uint64_t _count;
+
+    TEventJournal(const TEventJournal &) = delete;
+    TEventJournal &operator=(const TEventJournal &) = delete;
+
+    uint64_t bytesLeft();
+
+  public:
+    /** \brief Opens a journal
+     *
+     * \param fileName journal file
+     * \param writing true: creates (or truncates) the file to write events to, false: opens it to read them back
+     *
+     * raises gs5_error if the file cannot be opened, or is not a journal.
+     */
+    TEventJournal(const char *fileName, bool writing);
+    ~TEventJournal();
+
+    /// Appends an event, safe to call from any thread; returns false if it cannot be written (e.g. the disk is full)
+    bool write(unsigned int eventId, TEventType type, const char *entityId, const void *data, unsigned int dataSize);
+    /// Writes the buffered events to the file, returns false if any event could not be written
+    bool flush();
+    /// Has a write failed?
+    bool failed() const { return _failed.load(); }
+    /// Reads the next event, returns false at the end of the journal; raises gs5_error if it is truncated
+    bool read(TEntry &entry);
+    /// Events written or read so far
+    uint64_t count() const { return _count; }
+};
+
+/** \brief Asynchronous user event poster [ C++ Only ]
+ *
+ *  post() copies the event data into a pooled buffer (size classes of 64, 256, 1K and 4K bytes, larger data is
+ *  allocated on the heap) and links it into a lock-free queue, so the posting thread neither waits for the handlers
+ *  nor takes a lock. A poster thread takes the events out in order, posts them to gsCore synchronously and returns
+ *  the buffers to the pool once the handlers are done with them.
+ *
+ *  Used by TGSCore::postUserEventAsync().
+ */
+class TUserEventPoster {
+  public:
+    /// Counters
+    struct TStats {
+        uint64_t posted;    ///< events posted
+        uint64_t delivered; ///< events delivered to gsCore
+        uint64_t unpooled;  ///< events whose data is allocated on the heap (too large or the pool is used up)
+    };
+
+  private:
+    struct TBuffer;
+    struct TSizeClass;
+
+    std::unique_ptr<TSizeClass[]> _classes;
+    std::unique_ptr<TBuffer> _stub;
+    std::atomic<TBuffer *> _head; //last posted
+    TBuffer *_tail;               //next to deliver, poster thread only
+
+    std::thread _thread;
+    std::mutex _lock;
+    std::condition_variable _cv;
+    std::atomic<bool> _started;
+    std::atomic<bool> _sleeping;
+    bool _stop;
+    std::atomic<uint64_t> _posted;
+    std::atomic<uint64_t> _delivered;
+    std::atomic<uint64_t> _unpooled;
+
+    void start();
+    TBuffer *acquire(unsigned int size);
+    void release(TBuffer *buf);
+    TBuffer *pop();
+    void proc();
+
+    TUserEventPoster(const TUserEventPoster &) = delete;
+    TUserEventPoster &operator=(const TUserEventPoster &) = delete;
+
+  public:
+    TUserEventPoster();
+    ~TUserEventPoster();
+
+    /// Posts an event, the data is copied. Posted synchronously once stopped.
+    void post(unsigned int eventId, const void *data, unsigned int dataSize);
+    /// Waits until the events posted so far are delivered (returns at once if called by a handler)
+    void flush();
+    /// Delivers the pending events, then stops the poster thread
+    void stop();
+    TStats stats() const;
+};
+
+/** \brief Set of event ids [ C++ Only ]
+ *
+ *  One 64-bit word per event type, bit n stands for event id (type base + n). The last bit stands for the ids beyond,
+ *  which are kept in an exact list unless all ids of the type are added. The user event ids are counted from
+ *  GS_USER_EVENT.
+ *
+ *  \code
+ *  TEventMask mask{EVENT_ENTITY_ACCESS_HEARTBEAT, EVENT_ENTITY_ACTION_APPLIED};
+ *  mask.add(EVENT_TYPE_LICENSE); //all license events
+ *  \endcode
+ */
+class TEventMask {
+  private:
+    static const unsigned int OVERFLOW_BIT = 63;
+
+    uint64_t _bits[4];
+    unsigned int _allBeyond;              //bit i: word i matches every id beyond the last bit
+    std::vector<unsigned int> _beyond;    //sorted ids beyond the last bit
+
+    static int word(unsigned int eventId) {
+        return eventId >= EVENT_TYPE_USER ? 3 : eventId >= EVENT_TYPE_ENTITY ? 2 : eventId >= EVENT_TYPE_LICENSE ? 1 : 0;
+    }
+    static unsigned int offset(unsigned int eventId) {
+        static const unsigned int bases[] = {EVENT_TYPE_APP, EVENT_TYPE_LICENSE, EVENT_TYPE_ENTITY, EVENT_TYPE_USER};
+        return eventId - bases[word(eventId)];
+    }
+    static uint64_t bit(unsigned int n) { return (uint64_t)1 << (n < OVERFLOW_BIT ? n : OVERFLOW_BIT); }
+
+    void addBeyond(unsigned int eventId) {
+        std::vector<unsigned int>::iterator it = std::lower_bound(_beyond.begin(), _beyond.end(), eventId);
+        if (it == _beyond.end() || *it != eventId)
+            _beyond.insert(it, eventId);
+    }
+
+  public:
+    /// Empty set
+    TEventMask() : _allBeyond(0) { _bits[0] = _bits[1] = _bits[2] = _bits[3] = 0; }
+    TEventMask(std::initializer_list<unsigned int> eventIds) : TEventMask() {
+        for (unsigned int id : eventIds)
+            add(id);
+    }
+    /// All events
+    static TEventMask all() {
+        TEventMask m;
+        m._bits[0] = m._bits[1] = m._bits[2] = m._bits[3] = ~(uint64_t)0;
+        m._allBeyond = 0xF;
+        return m;
+    }
+
+    TEventMask &add(unsigned int eventId) {
+        unsigned int n = offset(eventId);
+        _bits[word(eventId)] |= bit(n);
+        if (n >= OVERFLOW_BIT)
+            addBeyond(eventId);
+        return *this;
+    }
+    /// Adds all events of a type
+    TEventMask &add(TEventType type) {
+        _bits[word(type)] = ~(uint64_t)0;
+        _allBeyond |= 1u << word(type);
+        return *this;
+    }
+    TEventMask &operator|=(const TEventMask &m) {
+        for (int i = 0; i < 4; i++)
+            _bits[i] |= m._bits[i];
+        _allBeyond |= m._allBeyond;
+        for (unsigned int id : m._beyond)
+            addBeyond(id);
+        return *this;
+    }
+
+    bool test(unsigned int eventId) const {
+        int w = word(eventId);
+        unsigned int n = offset(eventId);
+        if ((_bits[w] & bit(n)) == 0)
+            return false;
+        if (n < OVERFLOW_BIT || (_allBeyond & (1u << w)) != 0)
+            return true;
+        return std::binary_search(_beyond.begin(), _beyond.end(), eventId);
+    }
+    bool empty() const { return (_bits[0] | _bits[1] | _bits[2] | _bits[3]) == 0; }
+};
+
+/** \brief License snapshot [ C++ Only ]
+ *
+ *  Every parameter (name, type, attribute and value) of one or all licenses, captured in one pass into flat arrays:
+ *  the parameters of all licenses are stored back to back, and all strings share a single buffer.
+ *
+ *  Two snapshots are compared by diff(), e.g. to find out what a license code has changed:
+ *
+ *  \code
+ *  LicenseSnapshot before = LicenseSnapshot::capture();
+ *  core->applyLicenseCode(code);
+ *  for (const LicenseSnapshot::TChange &c : before.diff(LicenseSnapshot::capture())) ...
+ *  \endcode
+ */
+class LicenseSnapshot {
+  public:
+    /// A captured license
+    struct TLicense {
+        unsigned int entityId;  ///< offset of the entity id (ref: str())
+        unsigned int licenseId; ///< offset of the license id (ref: str())
+        TLicenseStatus status;
+        int firstParam; ///< index of the first parameter in params()
+        int paramCount;
+    };
+    /// A captured parameter
+    struct TParam {
+        int license;  ///< index of the license in licenses()
+        unsigned int name; ///< offset of the name (ref: str())
+        var_type_t type;
+        int attr;
+        union {
+            int64_t i;        ///< VAR_TYPE_INT, VAR_TYPE_INT64, VAR_TYPE_BOOL, VAR_TYPE_TIME
+            double d;         ///< VAR_TYPE_FLOAT, VAR_TYPE_DOUBLE
+            unsigned int str; ///< VAR_TYPE_STRING, offset of the value (ref: str())
+        };
+    };
+
+    enum TChangeKind {
+        LICENSE_ADDED,   ///< license only in the later snapshot
+        LICENSE_REMOVED, ///< license only in the earlier snapshot
+        STATUS_CHANGED,
+        PARAM_ADDED,
+        PARAM_REMOVED,
+        VALUE_CHANGED ///< value, type or attribute changed
+    };
+    /// A difference between two snapshots, indexes are -1 where not applicable
+    struct TChange {
+        TChangeKind kind;
+        int licenseBefore; ///< index of the license in the earlier snapshot
+        int licenseAfter;  ///< index of the license in the later snapshot
+        int paramBefore;   ///< index of the parameter in the earlier snapshot
+        int paramAfter;    ///< index of the parameter in the later snapshot
+    };
+
+  private:
+    std::vector<TLicense> _licenses;
+    std::vector<TParam> _params;
+    std::string _strings;
+
+    unsigned int intern(const char *s);
+    void add(TLicenseHandle hLic, const char *entityId);
+
+    int findLicense(const char *entityId, int hint) const;
+    int findParam(const TLicense &lic, const char *name, int hint) const;
+    bool sameValue(const TParam &p, const LicenseSnapshot &other, const TParam &q) const;
+
+  public:
+    /// Captures all licenses of the application, in entity order
+    static LicenseSnapshot capture();
+    /// Captures a single license
+    static LicenseSnapshot capture(const License &license);
+
+    const std::vector<TLicense> &licenses() const { return _licenses; }
+    const std::vector<TParam> &params() const { return _params; }
+    /// String at an offset
+    const char *str(unsigned int offset) const { return _strings.c_str() + offset; }
+
+    /// Index of the license attached to an entity, -1 if not captured
+    int indexOf(entity_id_t entityId) const { return findLicense(entityId, 0); }
+    /// Index of a license parameter, -1 if not captured
+    int indexOf(int license, const char *name) const { return findParam(_licenses[license], name, 0); }
+
+    /// Differences from this snapshot to a later one
+    std::vector<TChange> diff(const LicenseSnapshot &after) const;
+};
+
+class RequestBuilder;
+class RequestTemplate;
+
+/// Counters of the request code cache (ref: TGSCore::requestCode())
+struct TRequestCodeStats {
+    uint64_t hits;   ///< codes taken from the cache
+    uint64_t misses; ///< codes built
+};
+
 typedef void (*TGSAppEventHandler)(unsigned int eventId, void *usrData);
 typedef void (*TGSLicenseEventHandler)(unsigned int eventId, void *usrData);
 typedef void (*TGSEntityEventHandler)(unsigned int eventId, TGSEntity *entity, void *usrData);
 typedef void (*TGSUserEventHandler)(unsigned int eventId, void *eventData, unsigned int eventDataSize, void *usrData);
+/// Event subscriber, entity: source of an entity event (NULL otherwise), eventData: data of a user event (ref: TGSCore::subscribe())
+typedef void (*TGSEventSubscriber)(unsigned int eventId, TGSEntity *entity, void *eventData, unsigned int eventDataSize, void *usrData);
 
 /** \brief GS5 Core Object
   *
@@ -648,9 +1609,100 @@ class TGSCore {
     TGSUserEventHandler _userEventHandler;
     void *_userEventUsrData;
 
+    //Entity registry, rebuilt on demand once the license has changed
+    mutable std::shared_ptr<const TEntityRegistry> _registry;
+    mutable std::mutex _registryLock;
+    std::atomic<unsigned int> _licenseGeneration; //bumped at EVENT_LICENSE_READY and EVENT_ENTITY_ACTION_APPLIED
+
+    //Entitlement bitmap, created at first use and replaced only if the number of entities changes
+    std::atomic<TEntitlementMap *> _entitlements;
+    std::vector<std::unique_ptr<TEntitlementMap>> _entitlementMaps; //all maps ever published, readers may still hold old ones
+    std::mutex _entitlementLock;
+    //reconciliation thread
+    std::thread _reconciler;
+    std::mutex _reconcileLock;
+    std::condition_variable _reconcileCV;
+    int _reconcileInterval;
+    bool _reconcileNow;
+    bool _reconcileStop;
+
+    TEntitlementMap *initEntitlements();
+    void updateEntitlement(TEntityHandle hEntity);
+    void reconcileProc();
+    void stopReconciler();
+
+    //Event dispatch, the queue is only set in EVENT_DISPATCH_THREAD / PUMP mode
+    std::shared_ptr<TEventQueue> _eventQueue;
+    std::thread _dispatcher;
+    std::atomic<std::thread::id> _deliveringThread; //dispatcher thread or the one in dispatchPending()
+    std::atomic<TEventDispatchMode> _dispatchMode; //written under _dispatchLock
+    std::mutex _dispatchLock;
+
+    void dispatchProc(std::shared_ptr<TEventQueue> queue);
+    void stopDispatchFromHandler();
+
+    //Subscribers, an immutable list replaced on each change. Lists replaced are freed once no event is being delivered.
+    struct TSubscriber;
+    struct TSubscriberList;
+    std::atomic<const TSubscriberList *> _subscribers;
+    std::vector<const TSubscriberList *> _retiredSubscribers;
+    std::atomic<int> _delivering; //events being delivered to the subscribers
+    std::mutex _subscribeLock;
+    int _lastSubscription;
+
+    void publishSubscribers(const TSubscriberList *list);
+
+    //Flight recorder, dumped on EVENT_LICENSE_FAIL and EVENT_APP_CLOCK_ROLLBACK
+    TEventRecorder _recorder;
+    std::string _recorderDumpFile;
+    std::mutex _recorderLock;
+
+    void recordEvent(int eventId, TEntityHandle hEntity);
+    void dumpRecorder();
+
+    //Event journal being written, nullptr: none
+    std::shared_ptr<TEventJournal> _journal;
+
+    void journalEvent(int eventId, TEventType type, TEventHandle hEvent);
+
+    TUserEventPoster _userEventPoster;
+
+    std::map<std::string, std::shared_ptr<const RequestTemplate>> _requestTemplates;
+    mutable std::mutex _requestTemplateLock;
+
+    //Request codes by (action id, target entity id or "" for all entities), dropped when the license generation or
+    //the epoch (bumped by invalidateRequestCodes()) moves on
+    std::map<std::pair<action_id_t, std::string>, std::string> _requestCodes;
+    unsigned int _requestCodesGeneration;
+    unsigned int _requestCodesEpoch;
+    std::atomic<unsigned int> _requestCodeEpoch;
+    TRequestCodeStats _requestCodeStats;
+    mutable std::mutex _requestCodeLock;
+
+    //Delivery policies of the event ids below EVENT_TYPE_ENTITY + 100, nullptr: deliver all
+    struct TPolicyState;
+    enum { MAX_POLICY_EVENT_ID = EVENT_TYPE_ENTITY + 100 };
+    std::atomic<TPolicyState *> _policies[MAX_POLICY_EVENT_ID];
+    std::vector<std::unique_ptr<TPolicyState>> _policyStates; //all states ever set, a delivery may still use a replaced one
+    //releases the events held by EVENT_POLICY_LAST_IN_BURST
+    std::thread _policyThread;
+    std::mutex _policyLock;
+    std::condition_variable _policyCV;
+    int _policyTick;
+    bool _policyStop;
+
+    bool admitEvent(TPolicyState &state, int key);
+    void releaseHeldEvents(bool all);
+    void policyProc();
+    void stopPolicyThread();
+    void deliver(const TQueuedEvent &evt);
+
     static void WINAPI s_monitorCallback(int eventId, TEventHandle hEvent, void *usrData);
 
     void onEvent(int eventId, TEventHandle hEvent);
+    TGSEntity *eventEntity(TEntityHandle hSource, entity_id_t entityId, std::shared_ptr<const TEntityRegistry> &reg,
+                           std::unique_ptr<TGSEntity> &owned);
+    void deliver(int eventId, TEventType type, TGSEntity *entity, void *data, unsigned int dataSize);
 
     TGSCore();
     ~TGSCore();
@@ -681,6 +1733,146 @@ class TGSCore {
     void setEntityEventHandler(TGSEntityEventHandler handler, void *usrData);
     void setUserEventHandler(TGSUserEventHandler handler, void *usrData);
 
+    /** @name Event Dispatch
+     *
+     *  By default the event handlers are called right from gsCore's monitor callback, so a slow handler (e.g. of
+     *  EVENT_ENTITY_ACCESS_HEARTBEAT) holds up gsCore's timer. In EVENT_DISPATCH_THREAD or EVENT_DISPATCH_PUMP mode the
+     *  callback only copies the event (id, type, source entity id, user event data) into a bounded queue, and the
+     *  handlers are called later from a dispatcher thread or from dispatchPending():
+     *
+     *  \code
+     *  core->setEventDispatch(EVENT_DISPATCH_PUMP, 256, EVENT_QUEUE_DROP_OLDEST);
+     *  ...
+     *  //game loop
+     *  core->dispatchPending();
+     *  \endcode
+     *
+     *  EVENT_LICENSE_LOADING and EVENT_ENTITY_TRY_ACCESS are always delivered synchronously, gsCore acts on what their
+     *  handlers do as soon as they return. User events posted synchronously (gsPostUserEvent()) are queued all the same.
+     */
+    //@{
+    /** \brief Sets how the event handlers are called
+     *
+     * \param mode dispatch mode
+     * \param capacity size of the event queue (EVENT_DISPATCH_THREAD / PUMP)
+     * \param backpressure what to do when the queue is full
+     *
+     * Events queued before are delivered first (the pending ones of EVENT_DISPATCH_PUMP by the calling thread). Must not
+     * be called from an event handler.
+     *
+     * EVENT_QUEUE_BLOCK is rejected (gs5_error) with EVENT_DISPATCH_PUMP: the events are fired by the very thread which
+     * pumps them (tickFromExternalTimer(), beginAccess()...), it would wait forever for room only it can make.
+     */
+    void setEventDispatch(TEventDispatchMode mode, int capacity = 1024, TEventBackpressure backpressure = EVENT_QUEUE_DROP_NEWEST);
+    /// Current dispatch mode
+    TEventDispatchMode eventDispatchMode() const { return _dispatchMode.load(); }
+    /// Delivers up to maxEvents (all if < 0) pending events from the calling thread (EVENT_DISPATCH_PUMP), returns the events delivered
+    int dispatchPending(int maxEvents = -1);
+    /// Counters of the event queue, all zero in EVENT_DISPATCH_SYNC mode
+    TEventQueueStats eventQueueStats() const;
+
+    /** \brief Sets how often the events of an id are delivered
+     *
+     * E.g. a heartbeat once a minute per entity at most:
+     *
+     * \code
+     * core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::coalesce(60000));
+     * \endcode
+     *
+     * Applies to the handlers and subscribers alike, for the app, license and entity events. The events held by
+     * EVENT_POLICY_LAST_IN_BURST are delivered from a background thread (or queued, ref: setEventDispatch()).
+     */
+    void setEventPolicy(unsigned int eventId, const TEventPolicy &policy);
+    /// Counters of the policy of an event id, all zero if every event is delivered
+    TEventPolicyStats eventPolicyStats(unsigned int eventId) const;
+    //@}
+
+    /** @name Event Subscription
+     *
+     *  Any number of subscribers, each receiving only the events it is interested in, beside the handlers above:
+     *
+     *  \code
+     *  int id = core->subscribe(onHeartBeat, this, TEventMask{EVENT_ENTITY_ACCESS_HEARTBEAT}, "dlc-1");
+     *  ...
+     *  core->unsubscribe(id);
+     *  \endcode
+     *
+     *  Events are delivered to the subscribers without taking a lock, (un)subscribing is safe from any thread including
+     *  from a subscriber. A subscriber removed is not called anymore, but a call already under way on another thread
+     *  may still be running when unsubscribe() returns.
+     */
+    //@{
+    /** \brief Adds a subscriber
+     *
+     * \param subscriber called on the events in mask
+     * \param usrData passed to the subscriber
+     * \param mask event ids
+     * \param entityId if set, only the entity events of this entity are delivered
+     * \return subscription id, for unsubscribe()
+     */
+    int subscribe(TGSEventSubscriber subscriber, void *usrData, const TEventMask &mask = TEventMask::all(), entity_id_t entityId = NULL);
+    /// Removes a subscriber, returns false if not subscribed
+    bool unsubscribe(int subscription);
+    //@}
+
+    /** @name Event Flight Recorder
+     *
+     *  The last 1024 events received (time, event id, source entity and firing thread) are always recorded, and
+     *  dumped when the license fails to load (EVENT_LICENSE_FAIL) or the clock is rolled back (EVENT_APP_CLOCK_ROLLBACK),
+     *  to find out what led there. They can be dumped on demand as well:
+     *
+     *  \code
+     *  core->eventRecorder().dump("events.log");
+     *  \endcode
+     */
+    //@{
+    /// The flight recorder
+    TEventRecorder &eventRecorder() { return _recorder; }
+    /// Sets the file the events are dumped to, by default they are traced (ref: trace())
+    void setEventRecorderDumpFile(const char *fileName);
+    //@}
+
+    /** @name Event Journal
+     *
+     *  Writes the events received to a file, to be replayed later into a TGSApp without the wrapped binary:
+     *
+     *  \code
+     *  core->startEventJournal("events.gsj");
+     *  ...
+     *  core->stopEventJournal();
+     *
+     *  app->replayEvents("events.gsj");
+     *  \endcode
+     */
+    //@{
+    /// Starts journaling the events to a file (ref: TEventJournal), replacing the journal being written if any
+    void startEventJournal(const char *fileName);
+    /** \brief Stops journaling, the file is closed once the events being journaled are written
+     *
+     * \return false if events could not be written to the journal (e.g. the disk is full), the failure is also traced
+     *         when it happens
+     */
+    bool stopEventJournal();
+    //@}
+
+    /** @name Asynchronous User Events */
+    //@{
+    /** \brief Posts a user event without waiting for its handlers
+     *
+     * The data is copied into a pooled buffer, released once the handlers have run. The handlers are called from
+     * a poster thread, in the order the events are posted. Safe to call from any thread, it never blocks.
+     *
+     * \see gsPostUserEvent(), TUserEventPoster
+     */
+    void postUserEventAsync(unsigned int eventId, const void *eventData = NULL, unsigned int eventDataSize = 0) {
+        _userEventPoster.post(eventId, eventData, eventDataSize);
+    }
+    /// Waits until the user events posted asynchronously so far are delivered
+    void flushUserEvents() { _userEventPoster.flush(); }
+    /// Counters of the user events posted asynchronously
+    TUserEventPoster::TStats userEventStats() const { return _userEventPoster.stats(); }
+    //@}
+
     /** @name License Initialization / Load APIs */
     //@{
     /**
@@ -759,6 +1951,49 @@ class TGSCore {
     TGSEntity *getEntityByIndex(int index) const;
     /// Get entity by its unique entity id
     TGSEntity *getEntityById(entity_id_t entityId) const;
+    /// Get entity by index, as a value object
+    Entity entity(int index) const;
+    /// Get entity by its unique entity id, as a value object
+    Entity entity(entity_id_t entityId) const;
+    /// Get entity by index, non-throwing
+    expected<Entity> tryEntity(int index) const;
+    /// Get entity by its unique entity id, non-throwing
+    expected<Entity> tryEntity(entity_id_t entityId) const;
+    /// Get the entity registry, built at the first call and after the license changes (ref: TEntityRegistry)
+    std::shared_ptr<const TEntityRegistry> entityRegistry() const;
+    /// Bumped whenever the license is (re)loaded or an action is applied, handles resolved before may be out of date
+    unsigned int licenseGeneration() const { return _licenseGeneration.load(); }
+    //@}
+
+    /** @name Entitlements
+     *
+     *  Entity attributes are cached in a TEntitlementMap, checking them from any thread does not call gsCore:
+     *
+     *  \code
+     *  int dlc = core->entityRegistry()->indexOf("dlc-1"); //once
+     *  ...
+     *  if (core->entityAttributes(dlc) & ENTITY_ATTRIBUTE_ACCESSIBLE) ...
+     *  \endcode
+     *
+     *  The map is updated on entity events, and reconciled with gsCore once the license is loaded and then periodically
+     *  (every second by default), to catch the changes no event is fired for.
+     */
+    //@{
+    /// Cached attributes of an entity by its index in entityRegistry(), 0 if out of range
+    unsigned int entityAttributes(int index) {
+        TEntitlementMap *m = _entitlements.load(std::memory_order_acquire);
+        if (m == nullptr)
+            m = initEntitlements();
+        return (index >= 0 && index < m->size()) ? m->get(index) : 0;
+    }
+    /// Cached attributes of an entity by its id, 0 if not found
+    unsigned int entityAttributes(entity_id_t entityId) {
+        return entityAttributes(entityRegistry()->indexOf(entityId));
+    }
+    /// Reads the attributes of all entities from gsCore now
+    void reconcileEntitlements();
+    /// Sets the period of reconciliation in milliseconds, 0: only when the license is loaded
+    void setEntitlementReconcileInterval(int ms);
     //@}
     /** @name "User Defined Variables" */
     //@{{{
@@ -790,9 +2025,25 @@ class TGSCore {
     TGSVariable *getVariableByName(const char *name) const;
     /// Get user defined variable by index ( 0 <= index < getTotalVariables() )
     TGSVariable *getVariableByIndex(int index) const;
+    /// Get user defined variable by its name, as a value object
+    Variable variable(const char *name) const;
+    /// Get user defined variable by index, as a value object
+    Variable variable(int index) const;
+    /// Get user defined variable by its name, non-throwing
+    expected<Variable> tryVariable(const char *name) const;
+    /// Get user defined variable by index, non-throwing
+    expected<Variable> tryVariable(int index) const;
     //@}}}
     /// Create a request object
     TGSRequest *createRequest();
+    /// Create a request, as a value object
+    Request request();
+    /// Starts building a request (ref: RequestBuilder)
+    RequestBuilder requestBuilder();
+    /// Registers a request template, replacing the one of the same name
+    void registerRequestTemplate(RequestTemplate &&requestTemplate);
+    /// Gets a registered request template, raises gs5_error if not registered
+    std::shared_ptr<const RequestTemplate> requestTemplate(const char *name) const;
 
     /// Apply license code
     bool applyLicenseCode(const char *code, const char *sn = NULL, const char *snRef = NULL);
@@ -879,6 +2130,13 @@ class TGSCore {
 
     ///Get the current SDK binary version
     static const char *SDKVersion();
+    /**
+    *	\brief Gets the apis exported by the SDK binary
+    *
+    *	Bit [ord] is set if the api of ordinal ord is available (ref: gsHasApi()), so the code can check
+    *	once for a feature missing in older SDK binaries.
+    */
+    static std::bitset<SDK_MAX_API_ORDINAL + 1> capabilities();
 
     ///Get product name
     const char *productName();
@@ -914,8 +2172,25 @@ class TGSCore {
     */
     void trace(const char *msg);
 
-    /** @name Commonly used request code helpers */
+    /** @name Commonly used request code helpers
+     *
+     *  The codes are cached, a code is built once and then reused until the license changes: it is loaded
+     *  (EVENT_LICENSE_READY), an action is applied (EVENT_ENTITY_ACTION_APPLIED), a license is locked or bound to an
+     *  entity through the SDK, or invalidateRequestCodes() is called.
+     */
     //@{
+    /** \brief Gets the request code of a single action
+     *
+     * \param actId action type id
+     * \param entityId target entity, NULL: all entities
+     *
+     * raises gs5_error if the action cannot be requested.
+     */
+    std::string requestCode(action_id_t actId, entity_id_t entityId = NULL);
+    /// Drops the cached request codes, for license changes made around the SDK (e.g. writing a license parameter directly)
+    void invalidateRequestCodes() { _requestCodeEpoch.fetch_add(1); }
+    /// Counters of the request code cache
+    TRequestCodeStats requestCodeStats() const;
     /// Get request code to fix license error ( all entities/licenses )
     std::string getFixRequestCode();
     /// Get request code to unlock the whole application ( all entities/licenses )
@@ -1061,6 +2336,9 @@ class TGSCore {
     std::string getPreliminarySN() {
         return gsGetPreliminarySN();
     }
+    string_view getPreliminarySNView() {
+        return gsGetPreliminarySN();
+    }
 
     //Revoke a single serial number, all those entities previously unlocked by this sn are locked
     bool revokeSN(const char *sn) {
@@ -1085,12 +2363,22 @@ class TGSCore {
 
         return gsMPUploadApp(preSN, TIMEOUT_WAIT_INFINITE);
     }
+    /// Same as uploadApp(), without copying the receipt
+    string_view uploadAppView(const char *preSN = NULL) {
+        assert(preSN || gsMPCanPreliminarySNResolved(NULL));
+
+        return gsMPUploadApp(preSN, TIMEOUT_WAIT_INFINITE);
+    }
 
     //Move the whole license manually / offline
     //Return: on success, a non-empty encrypted string contains the current license data.
     std::string exportApp() {
         return gsMPExportApp();
     }
+    /// Same as exportApp(), without copying the data
+    string_view exportAppView() {
+        return gsMPExportApp();
+    }
 
     //Code Exchange
     static TCodeExchange *beginCodeExchange() {
@@ -1101,6 +2389,238 @@ class TGSCore {
     }
 };
 
+/** @name License parameter references [ C++ Only ]
+ *
+ *  A ParamRef resolves a license parameter by name once and keeps its variable handle open, later get() / set()
+ *  calls go straight to the variable without looking the name up or allocating:
+ *
+ *  \code
+ *  ParamRef<int> tolerance(license, "rollbackTolerance");
+ *  ...
+ *  if (delta > tolerance.get()) ...
+ *  \endcode
+ *
+ *  The parameter is resolved again, on the next access, after it has been bound to another license (rebind()) or the
+ *  license has changed (TGSCore::licenseGeneration()); the access then raises gs5_error if it is not found.
+ *
+ *  The license is not owned by the reference, it must outlive it, and so must the TGSCore instance the reference
+ *  was resolved with.
+ */
+//@{
+/// Untyped part of ParamRef<T>
+class ParamRefBase {
+  private:
+    TLicenseHandle _license;
+    std::string _name;
+    unsigned int _generation;
+    TGSCore *_core; //set by the first resolve()
+
+  protected:
+    Variable _var;
+
+    ParamRefBase() : _license(INVALID_GS_HANDLE), _generation(0), _core(NULL) {}
+    ParamRefBase(TLicenseHandle license, const char *name);
+
+    /// Resolves the parameter again if out of date, raises gs5_error if not found
+    void refresh() {
+        if (stale())
+            resolve();
+    }
+    void resolve();
+
+  public:
+    /// Bound to a license?
+    explicit operator bool() const { return _license != INVALID_GS_HANDLE; }
+    /// Parameter name
+    const char *name() const { return _name.c_str(); }
+    /// Is the resolved variable out of date? (it is resolved again on next access)
+    bool stale() const;
+
+    /// Binds to the same parameter of another license, resolved on the next access
+    void rebind(const License &license) { rebind(license.handle()); }
+    void rebind(TGSLicense *license) { rebind(license->handle()); }
+    void rebind(TLicenseHandle license);
+};
+
+/// Value conversion of a ParamRef<T>, specialized for each supported type
+template <typename T>
+struct ParamTraits;
+
+template <>
+struct ParamTraits<int> {
+    static int get(const Variable &v) { return v.asInt(); }
+    static void set(Variable &v, int x) { v.fromInt(x); }
+};
+template <>
+struct ParamTraits<int64_t> {
+    static int64_t get(const Variable &v) { return v.asInt64(); }
+    static void set(Variable &v, int64_t x) { v.fromInt64(x); }
+};
+template <>
+struct ParamTraits<bool> {
+    static bool get(const Variable &v) { return v.asBool(); }
+    static void set(Variable &v, bool x) { v.fromBool(x); }
+};
+template <>
+struct ParamTraits<float> {
+    static float get(const Variable &v) { return v.asFloat(); }
+    static void set(Variable &v, float x) { v.fromFloat(x); }
+};
+template <>
+struct ParamTraits<double> {
+    static double get(const Variable &v) { return v.asDouble(); }
+    static void set(Variable &v, double x) { v.fromDouble(x); }
+};
+/// the string is owned by gsCore, valid until the next gsCore call from this thread (ref: gs::string_view)
+template <>
+struct ParamTraits<const char *> {
+    static const char *get(const Variable &v) { return v.asString(); }
+    static void set(Variable &v, const char *x) { v.fromString(x); }
+};
+
+/// Typed license parameter reference, T: int, int64_t, bool, float, double or const char* (ref: ParamTraits)
+template <typename T>
+class ParamRef : public ParamRefBase {
+  public:
+    ParamRef() {}
+    ParamRef(const License &license, const char *name) : ParamRefBase(license.handle(), name) {}
+    ParamRef(TGSLicense *license, const char *name) : ParamRefBase(license->handle(), name) {}
+
+    T get() {
+        refresh();
+        return ParamTraits<T>::get(_var);
+    }
+    void set(T v) {
+        refresh();
+        ParamTraits<T>::set(_var, v);
+    }
+};
+//@}
+
+/** \name Request Builder [ C++ Only ]
+ *
+ *  Composes a request from actions and their parameters in one expression, with no heap object in between:
+ *
+ *  \code
+ *  std::string code = core->requestBuilder()
+ *                         .action(ACT_SET_ENDDATE, "e2").param("endDate", t2030)
+ *                         .action(ACT_UNLOCK, "e3")
+ *                         .code();
+ *  \endcode
+ *
+ *  Requests made over and over again with different values are better described once by a template, whose actions
+ *  and parameters are looked up when it is defined:
+ *
+ *  \code
+ *  RequestTemplate extend("extend e2");
+ *  extend.action(ACT_SET_ENDDATE, "e2").param("endDate");
+ *  core->registerRequestTemplate(std::move(extend));
+ *  ...
+ *  std::string code = core->requestTemplate("extend e2")->code(t2030);
+ *  \endcode
+ */
+//@{
+/// Value of a request parameter, converted to the parameter type when set. An integer sets a time parameter as UTC time.
+class RequestValue {
+  public:
+    enum TKind { NONE, INT, INT64, BOOL, FLOAT, DOUBLE, STRING };
+
+  private:
+    TKind _kind;
+    union {
+        int64_t i;
+        float f;
+        double d;
+        const char *s;
+    } _v;
+
+  public:
+    RequestValue() : _kind(NONE) {}
+    RequestValue(int v) : _kind(INT) { _v.i = v; }
+    RequestValue(int64_t v) : _kind(INT64) { _v.i = v; }
+    RequestValue(bool v) : _kind(BOOL) { _v.i = v; }
+    RequestValue(float v) : _kind(FLOAT) { _v.f = v; }
+    RequestValue(double v) : _kind(DOUBLE) { _v.d = v; }
+    /// the string is not copied, it must outlive the value
+    RequestValue(const char *v) : _kind(STRING) { _v.s = v; }
+    RequestValue(const std::string &v) : _kind(STRING) { _v.s = v.c_str(); }
+
+    TKind kind() const { return _kind; }
+    /// Sets a parameter, varType: its type id (ref: \ref varType)
+    void setTo(Variable &var, var_type_t varType) const;
+};
+
+/// Fluent request composer (ref: TGSCore::requestBuilder())
+class RequestBuilder {
+  private:
+    Request _request;
+    Action _action; //last added
+
+  public:
+    explicit RequestBuilder(Request &&request) : _request(std::move(request)) {}
+
+    /// adds a global action targeting all entities
+    RequestBuilder &action(action_id_t actId);
+    /// adds an action targeting all licenses of an entity
+    RequestBuilder &action(action_id_t actId, const Entity &entity);
+    RequestBuilder &action(action_id_t actId, const char *entityId);
+    /// sets a parameter of the last action added, raises gs5_error if not found
+    RequestBuilder &param(const char *name, const RequestValue &value);
+
+    /// gets the request code, valid while the builder is alive and unchanged
+    const char *code() const { return _request.code(); }
+    /// gives up the request built
+    Request release() { return std::move(_request); }
+};
+
+/// Request described once, generated with different parameter values (ref: TGSCore::registerRequestTemplate())
+class RequestTemplate {
+  private:
+    struct TStep {
+        action_id_t actId;
+        std::string entityId; //empty: global action
+        int firstSlot;
+    };
+    struct TSlot {
+        int index; //parameter index in its action
+        var_type_t type;
+    };
+
+    std::string _name;
+    std::vector<TStep> _steps;
+    std::vector<TSlot> _slots;
+
+    //adds the action of a step to a request, raises gs5_error if not supported
+    static Action addAction(Request &request, const TStep &step);
+
+    std::string generate(const RequestValue *values, int count) const;
+
+  public:
+    explicit RequestTemplate(const char *name) : _name(name) {}
+
+    const char *name() const { return _name.c_str(); }
+
+    /// adds an action, raises gs5_error if it is not supported
+    RequestTemplate &action(action_id_t actId, const char *entityId = NULL);
+    /// adds a parameter of the last action added, whose value is given to code()
+    RequestTemplate &param(const char *name);
+    /// number of values taken by code()
+    int paramCount() const { return (int)_slots.size(); }
+
+    /** \brief Generates a request code
+     *
+     * \param values one for each param(), in the same order
+     *
+     * raises gs5_error if the number of values does not match. Safe to call from any thread.
+     */
+    template <typename... Args>
+    std::string code(const Args &...values) const {
+        const RequestValue v[] = {RequestValue(values)..., RequestValue()};
+        return generate(v, (int)sizeof...(Args));
+    }
+};
+//@}
+
 /**
   *  Built-In License Model Inspectors
   *
@@ -0,0 +1,378 @@
+#include "GS5_Discovery.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#include <limits.h>
+#endif
+
+#ifdef _LINUX_
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gs {
+
+namespace {
+
+typedef std::chrono::steady_clock clk;
+
+uint64_t ns_since(clk::time_point t0) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(clk::now() - t0).count();
+}
+
+#if defined(_WINDOWS_) || defined(_WIN_)
+const char *CORE_NAME = "gsCore.dll";
+const char PATH_SEP = '\\';
+const char *PLATFORM_DIR = sizeof(void *) == 4 ? "win32\\" : "win64\\";
+#elif defined(_MAC_)
+const char *CORE_NAME = "libgsCore.dylib";
+const char PATH_SEP = '/';
+#elif defined(_LINUX_)
+const char *CORE_NAME = "libgsCore.so";
+const char PATH_SEP = '/';
+const char *PLATFORM_DIR = sizeof(void *) == 4 ? "linux32/" : "linux64/";
+#else
+#error("Either _WIN_, _LINUX_ or _MAC_ must be defined to build SoftwareShield SDK-C!")
+#endif
+
+const int MAX_PROBES = 8;
+
+std::mutex s_lock;
+bool s_started = false; //discovery has started, the cache file cannot be changed anymore
+bool s_cacheSet = false;
+std::string s_cacheFile;
+int s_loadPolicy = -1; //not set: GS_SDK_CORE_LOAD
+
+sdk_core_probe s_probes[MAX_PROBES];
+std::string s_probePaths[MAX_PROBES];
+std::string s_corePath;
+sdk_core_discovery s_result;
+std::atomic<bool> s_done(false);
+
+void *openLib(const char *path) {
+#if defined(_WINDOWS_) || defined(_WIN_)
+    return LoadLibraryA(path); //imports are always bound eagerly
+#else
+    return dlopen(path, (s_loadPolicy & SDK_CORE_LOAD_NOW ? RTLD_NOW : RTLD_LAZY) | RTLD_LOCAL);
+#endif
+}
+
+//"lazy", "now", "prefault", separated by commas
+int parseLoadPolicy(const char *s) {
+    int policy = SDK_CORE_LOAD_LAZY;
+    std::string all(s);
+    size_t i = 0;
+    while (i <= all.size()) {
+        size_t j = all.find(',', i);
+        if (j == std::string::npos)
+            j = all.size();
+        std::string item = all.substr(i, j - i);
+        if (item == "now")
+            policy |= SDK_CORE_LOAD_NOW;
+        else if (item == "prefault")
+            policy |= SDK_CORE_LOAD_PREFAULT;
+        i = j + 1;
+    }
+    return policy;
+}
+
+volatile unsigned char s_pageSink;
+
+//Reads one byte per page so that every page of [begin, end) is faulted in
+void touchPages(const unsigned char *begin, const unsigned char *end, size_t pageSize) {
+    unsigned char sum = 0;
+    for (const volatile unsigned char *p = begin; p < end; p += pageSize)
+        sum += *p;
+    s_pageSink = sum;
+}
+
+#ifdef _LINUX_
+struct TImage {
+    const char *name;
+    size_t pageSize;
+};
+
+int prefaultSegments(struct dl_phdr_info *info, size_t, void *data) {
+    const TImage *image = (const TImage *)data;
+    if (info->dlpi_name == nullptr || strcmp(info->dlpi_name, image->name) != 0)
+        return 0;
+
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) &ph = info->dlpi_phdr[i];
+        if (ph.p_type != PT_LOAD || !(ph.p_flags & PF_R))
+            continue;
+        uintptr_t begin = (info->dlpi_addr + ph.p_vaddr) & ~(uintptr_t)(image->pageSize - 1);
+        uintptr_t end = info->dlpi_addr + ph.p_vaddr + ph.p_memsz;
+        madvise((void *)begin, end - begin, MADV_WILLNEED);
+        touchPages((const unsigned char *)begin, (const unsigned char *)end, image->pageSize);
+    }
+    return 1;
+}
+#endif
+
+//Pages in the whole image of a loaded gsCore
+void prefault(void *h, const std::string &path) {
+#if defined(_WINDOWS_) || defined(_WIN_)
+    (void)path;
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    const unsigned char *base = (const unsigned char *)h;
+    const IMAGE_NT_HEADERS *nt = (const IMAGE_NT_HEADERS *)(base + ((const IMAGE_DOS_HEADER *)h)->e_lfanew);
+    const unsigned char *end = base + nt->OptionalHeader.SizeOfImage;
+    MEMORY_BASIC_INFORMATION mbi;
+    for (const unsigned char *p = base; p < end && VirtualQuery(p, &mbi, sizeof(mbi)); p = (const unsigned char *)mbi.BaseAddress + mbi.RegionSize) {
+        if (mbi.State == MEM_COMMIT && !(mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD)))
+            touchPages(p, std::min(end, (const unsigned char *)mbi.BaseAddress + mbi.RegionSize), si.dwPageSize);
+    }
+#elif defined(_LINUX_)
+    //the file first, in one sequential read instead of a page fault per page
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0)
+            readahead(fd, 0, st.st_size);
+        close(fd);
+    }
+
+    Dl_info di;
+    void *api = dlsym(h, "gsGetVersion");
+    if (api && dladdr(api, &di)) {
+        TImage image = {di.dli_fname, (size_t)sysconf(_SC_PAGESIZE)};
+        dl_iterate_phdr(prefaultSegments, &image);
+    }
+#else
+    (void)h;
+    (void)path;
+#endif
+}
+
+//Tries loading gsCore from path, the attempt is recorded
+void *probe(const char *source, const std::string &path) {
+    auto t0 = clk::now();
+    void *h = openLib(path.c_str());
+    int n = s_result.probeCount;
+    if (n < MAX_PROBES) {
+        s_probePaths[n] = path;
+        s_probes[n].source = source;
+        s_probes[n].path = s_probePaths[n].c_str();
+        s_probes[n].elapsed = ns_since(t0);
+        s_probes[n].loaded = h != nullptr;
+        s_result.probeCount++;
+    }
+    return h;
+}
+
+//Appends a path separator if needed
+std::string asDir(const char *dir) {
+    std::string s(dir);
+    if (!s.empty() && s.back() != '/' && s.back() != PATH_SEP)
+        s += PATH_SEP;
+    return s;
+}
+
+//Directory of the module (lib or exe) linking the SDK, empty if unknown
+std::string moduleDir() {
+#if defined(_WINDOWS_) || defined(_WIN_)
+    HMODULE self = nullptr;
+    char buf[MAX_PATH];
+    if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)&s_result, &self))
+        return std::string();
+    DWORD n = GetModuleFileNameA(self, buf, sizeof(buf));
+    std::string path(buf, n);
+#else
+    char buf[PATH_MAX];
+    Dl_info di;
+    if (!dladdr(&s_result, &di) || realpath(di.dli_fname, buf) == nullptr)
+        return std::string();
+    std::string path(buf);
+#endif
+    return path.substr(0, path.find_last_of(PATH_SEP) + 1);
+}
+
+//Full path of a loaded gsCore, falls back to the path it was loaded from
+std::string corePath(void *h, const std::string &loadedFrom) {
+#if defined(_WINDOWS_) || defined(_WIN_)
+    char buf[MAX_PATH];
+    DWORD n = GetModuleFileNameA((HMODULE)h, buf, sizeof(buf));
+    if (n > 0 && n < sizeof(buf))
+        return std::string(buf, n);
+#else
+    char buf[PATH_MAX];
+    Dl_info di;
+    void *api = dlsym(h, "gsGetVersion");
+    if (api && dladdr(api, &di) && realpath(di.dli_fname, buf))
+        return buf;
+    if (realpath(loadedFrom.c_str(), buf))
+        return buf;
+#endif
+    return loadedFrom;
+}
+
+std::string readCache(const std::string &fileName) {
+    std::string path;
+    FILE *f = fopen(fileName.c_str(), "r");
+    if (f) {
+        char buf[4096];
+        if (fgets(buf, sizeof(buf), f)) {
+            path = buf;
+            while (!path.empty() && (path.back() == '\n' || path.back() == '\r'))
+                path.pop_back();
+        }
+        fclose(f);
+    }
+    return path;
+}
+
+//Replaces the cache file as a whole, so a concurrent launch never reads a partial path
+void writeCache(const std::string &fileName, const std::string &path) {
+    std::string tmp = fileName + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "w");
+    if (f == nullptr)
+        return;
+    bool ok = fprintf(f, "%s\n", path.c_str()) > 0;
+    ok = fclose(f) == 0 && ok;
+#if defined(_WINDOWS_) || defined(_WIN_)
+    ok = ok && MoveFileExA(tmp.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(tmp.c_str(), fileName.c_str()) == 0;
+#endif
+    if (!ok)
+        remove(tmp.c_str());
+}
+
+} // namespace
+
+bool TCoreDiscovery::setLoadPolicy(int policy) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    if (s_started)
+        return false;
+    s_loadPolicy = policy & (SDK_CORE_LOAD_NOW | SDK_CORE_LOAD_PREFAULT);
+    return true;
+}
+
+bool TCoreDiscovery::setCacheFile(const char *fileName) {
+    std::lock_guard<std::mutex> lock(s_lock);
+    if (s_started)
+        return false;
+    s_cacheFile = fileName ? fileName : "";
+    s_cacheSet = true;
+    return true;
+}
+
+void *TCoreDiscovery::load() {
+    std::lock_guard<std::mutex> lock(s_lock);
+    if (s_started)
+        return nullptr;
+    s_started = true;
+
+    auto t0 = clk::now();
+    memset(&s_result, 0, sizeof(s_result));
+    s_result.probes = s_probes;
+
+    if (!s_cacheSet) {
+        const char *p = getenv("GS_SDK_CORE_CACHE");
+        if (p)
+            s_cacheFile = p;
+    }
+    if (s_loadPolicy < 0) {
+        const char *p = getenv("GS_SDK_CORE_LOAD");
+        s_loadPolicy = p ? parseLoadPolicy(p) : SDK_CORE_LOAD_LAZY;
+    }
+
+    void *h = nullptr;
+    std::string cached;
+
+#ifdef _MAC_
+    //Mac wrapped core, if loaded, will set its image base in environment
+    const char *base = getenv("GS_CORE_BASE");
+    if (base) {
+        //Already loaded in memory
+        sscanf(base, "%p", &h);
+        s_probePaths[0] = base;
+        s_probes[0].source = "GS_CORE_BASE";
+        s_probes[0].path = s_probePaths[0].c_str();
+        s_probes[0].loaded = h != nullptr;
+        s_result.probeCount = 1;
+        s_corePath = base;
+        s_result.path = s_corePath.c_str();
+        s_result.elapsed = ns_since(t0);
+        s_done = true;
+        return h;
+    }
+#endif
+
+    if (!s_cacheFile.empty()) {
+        cached = readCache(s_cacheFile);
+        if (!cached.empty()) {
+            h = probe("cache", cached);
+            s_result.cached = h != nullptr;
+        }
+    }
+
+#ifndef _MAC_
+    //system library search path
+    if (!h)
+        h = probe("search path", CORE_NAME);
+
+    //environment variable "GS_SDK_BIN"
+    if (!h) {
+        const char *p = getenv("GS_SDK_BIN");
+        if (p && *p) {
+            std::string dir = asDir(p);
+            h = probe("GS_SDK_BIN", dir + CORE_NAME);
+            if (!h)
+                h = probe("GS_SDK_BIN", dir + PLATFORM_DIR + CORE_NAME);
+        }
+    }
+#endif
+
+    //side by side with *this* module (lib or exe)
+    if (!h) {
+        std::string dir = moduleDir();
+        if (!dir.empty())
+            h = probe("module directory", dir + CORE_NAME);
+    }
+
+    if (h) {
+        s_corePath = corePath(h, s_probePaths[s_result.probeCount - 1]);
+        if (!s_cacheFile.empty() && s_corePath != cached)
+            writeCache(s_cacheFile, s_corePath);
+
+        if (s_loadPolicy & SDK_CORE_LOAD_PREFAULT) {
+            auto t1 = clk::now();
+            prefault(h, s_corePath);
+            s_result.prefault = ns_since(t1);
+        }
+    }
+    s_result.path = s_corePath.c_str();
+    s_result.elapsed = ns_since(t0);
+    s_done = true;
+    return h;
+}
+
+const sdk_core_discovery *TCoreDiscovery::result() {
+    return s_done ? &s_result : nullptr;
+}
+
+void TCoreDiscovery::report() {
+    for (int i = 0; i < s_result.probeCount; i++) {
+        const sdk_core_probe &p = s_probes[i];
+        fprintf(stderr, "  %-16s %s: %s (%.1f us)\n", p.source, p.path, p.loaded ? "loaded" : "not found", p.elapsed / 1000.0);
+    }
+}
+
+} // namespace gs
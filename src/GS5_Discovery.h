@@ -0,0 +1,46 @@
+/*! \file GS5_Discovery.h
+	\brief gsCore library discovery (internal)
+
+	Locates and loads the gsCore library for GS5_Intf.cpp, every candidate location probed is timed.
+	The public accessors are sdk_get_core_discovery() / sdk_set_core_cache() declared in GS5_Intf.h.
+*/
+#ifndef _GS5_DISCOVERY_H_
+#define _GS5_DISCOVERY_H_
+
+#include "GS5_Intf.h"
+
+namespace gs {
+
+/**
+*  \brief gsCore locator
+*
+*  The candidates are probed in order until gsCore is loaded:
+*
+*  - the path in the cache file (if any);
+*  - the system library search path;
+*  - GS_SDK_BIN and GS_SDK_BIN/[platform];
+*  - the directory of the module linking the SDK.
+*
+*  The full path of the loaded gsCore is written back to the cache file, so that later launches load it
+*  directly without probing.
+*
+*  With SDK_CORE_LOAD_PREFAULT the image of gsCore is paged in right after loading, by the thread
+*  loading it (the warm-up thread if sdk_warm_up() is used).
+*/
+class TCoreDiscovery {
+  public:
+    /// Sets the cache file, fails once gsCore discovery has started
+    static bool setCacheFile(const char *fileName);
+    /// Sets the load policy (SDK_CORE_LOAD_xxx), fails once gsCore discovery has started
+    static bool setLoadPolicy(int policy);
+    /// Locates and loads gsCore, returns its module handle (nullptr if not found)
+    static void *load();
+    /// Result of load(), nullptr if gsCore has not been loaded by load()
+    static const sdk_core_discovery *result();
+    /// Prints all probed locations to stderr
+    static void report();
+};
+
+} // namespace gs
+
+#endif
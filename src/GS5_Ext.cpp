@@ -2,6 +2,11 @@
 #include "GS5.h"
 #include "GS5_Intf.h"
 
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace gs {
@@ -202,6 +207,58 @@ const char *TGSApp::getGameTitle() { //Game Iitle
 void TGSApp::sendUserEvent(unsigned int eventId, void *eventData, unsigned int eventDataSize) {
     gsPostUserEvent(eventId, true, eventData, eventDataSize);
 }
+void TGSApp::postUserEvent(unsigned int eventId, const void *eventData, unsigned int eventDataSize) {
+    _core->postUserEventAsync(eventId, eventData, eventDataSize);
+}
+
+int TGSApp::replayEvents(const char *fileName, bool realTime, int *unopened) {
+    TEventJournal journal(fileName, false);
+    TEventJournal::TEntry evt;
+    //entity objects opened so far, NULL if not found
+    std::map<std::string, std::unique_ptr<TGSEntity>> entities;
+    int replayed = 0;
+    int notOpened = 0;
+    while (journal.read(evt)) {
+        if (realTime && evt.delay > 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(evt.delay));
+
+        switch (evt.type) {
+        case EVENT_TYPE_APP:
+            OnAppEvent(evt.eventId);
+            break;
+        case EVENT_TYPE_LICENSE:
+            OnLicenseEvent(evt.eventId);
+            break;
+        case EVENT_TYPE_ENTITY: {
+            auto it = entities.find(evt.entityId);
+            if (it == entities.end()) {
+                TGSEntity *entity = NULL;
+                try {
+                    entity = _core->getEntityById(evt.entityId.c_str());
+                } catch (gs5_error &) {
+                }
+                it = entities.emplace(evt.entityId, std::unique_ptr<TGSEntity>(entity)).first;
+            }
+            if (it->second) {
+                OnEntityEvent(evt.eventId, it->second.get());
+            } else {
+                OnReplayedEntityEvent(evt.eventId, evt.entityId.c_str());
+                notOpened++;
+            }
+            break;
+        }
+        case EVENT_TYPE_USER:
+            OnUserEvent(evt.eventId, evt.data.empty() ? NULL : evt.data.data(), (unsigned int)evt.data.size());
+            break;
+        default:
+            continue;
+        }
+        replayed++;
+    }
+    if (unopened)
+        *unopened = notOpened;
+    return replayed;
+}
 //------- App Control --------
 void TGSApp::exitApp(int rc) {
     gsExitApp(rc);
@@ -119,6 +119,16 @@ class TGSApp {
 	*  It is recommended that subclass override individual event handlers instead of this one.
 	*/
     virtual void OnEntityEvent(unsigned int evtId, TGSEntity *entity);
+    /**
+	*  \brief Replayed Entity Events Handler
+	*  
+	*  \param evtId Entity Event Identifier
+	*  \param entityId Journaled id of the source entity
+	*  
+	*  Called by replayEvents() instead of OnEntityEvent() when the entity cannot be opened, e.g. no license is loaded.
+	*  The default method does nothing.
+	*/
+    virtual void OnReplayedEntityEvent(unsigned int evtId, const char *entityId) {}
     /**
 	* \brief User Event Handker
 	*
@@ -564,6 +574,33 @@ class TGSApp {
 	*/
     void sendUserEvent(unsigned int eventId, void *eventData = NULL, unsigned int eventDataSize = 0);
 
+    /** \brief Post User Defined Event (Asynchronous event posting)
+	*
+	* \param eventId User defined event id ( must >= GS_USER_EVENT )
+	* \param eventData [Optional] data buffer pointer associated with the event, NULL if no event data
+	* \param eventDataSize size of event data buffer, ignored if \a eventData is NULL
+	*
+	* Returns at once, the event data is copied and OnUserEvent() is called later from a poster thread.
+	* Game / render threads can post without stalling. (ref: TGSCore::postUserEventAsync())
+	*/
+    void postUserEvent(unsigned int eventId, const void *eventData = NULL, unsigned int eventDataSize = 0);
+
+    /** \brief Replays an event journal
+	*
+	* \param fileName journal written by TGSCore::startEventJournal()
+	* \param realTime true: waits between events as long as they were apart when journaled, false: replays them at once
+	* \param unopened [Optional] receives the number of entity events whose entity could not be opened, fed to
+	*        OnReplayedEntityEvent()
+	*
+	* \return number of events replayed
+	*
+	* The events are fed to OnAppEvent(), OnLicenseEvent(), OnEntityEvent() and OnUserEvent() on the calling thread,
+	* for reproducible handler tests and benchmarks without the wrapped binary. An entity event whose entity cannot be
+	* opened, e.g. no license is loaded, is fed to OnReplayedEntityEvent() with the journaled id. Raises gs5_error if
+	* the journal cannot be read.
+	*/
+    int replayEvents(const char *fileName, bool realTime = false, int *unopened = NULL);
+
     /**
 	* \brief Gets pointer to TGSCore instance 
 	* 
@@ -1,9 +1,13 @@
 #include "GS5_Intf.h"
+#include "GS5_Discovery.h"
+#include "GS5_Profile.h"
 
-#include <assert.h>
+#include <atomic>
+#include <mutex>
 #include <stdexcept>
 #include <string.h>
 #include <string>
+#include <thread>
 
 #ifdef _MSC_VER
 #include <Windows.h>
@@ -19,17 +23,70 @@ namespace gs {
 #define MIN_API_INDEX 2
 #define MAX_API_INDEX 162
 
-static void *apis[MAX_API_INDEX + 1];
-
 //: image base of gsCore
 static void *s_core = nullptr;
 static bool s_finished = false;
 
+//Warm-up thread started by sdk_warm_up(), joined by sdk_finish() or, if it is never called, when the program exits
+class TWarmUp {
+  private:
+    std::mutex _lock;
+    std::thread _thread;
+    bool _started = false;
+    bool _finished = false;
+
+  public:
+    ~TWarmUp() { finish(); }
+
+    void start(void (*proc)()) {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (_started || _finished)
+            return;
+        _started = true;
+        _thread = std::thread(proc);
+    }
+    //no warm-up is started afterwards
+    void finish() {
+        std::lock_guard<std::mutex> lock(_lock);
+        _finished = true;
+        if (_thread.joinable())
+            _thread.join();
+    }
+};
+
+static TWarmUp &warmUp() {
+    static TWarmUp s_warmUp;
+    return s_warmUp;
+}
+
+//api profiling is ever turned on, the result is dumped in sdk_finish()
+static std::atomic<bool> s_profiled(false);
+static std::string s_profileOutput; //empty: stderr
+
+//GS_SDK_PROFILE=1|<file> turns on api profiling at startup
+static struct TProfileEnv {
+    TProfileEnv() {
+        const char *p = getenv("GS_SDK_PROFILE");
+        if (p && *p && strcmp(p, "0") != 0) {
+            if (strcmp(p, "1") != 0)
+                s_profileOutput = p;
+            s_profiled = true;
+            TApiProfiler::setEnabled(true);
+        }
+    }
+} s_profileEnv;
+
 void sdk_finish() {
     if (s_finished)
         return;
     s_finished = true;
 
+    //the core cannot be unloaded while it is being loaded
+    warmUp().finish();
+
+    if (s_profiled)
+        TApiProfiler::dump(s_profileOutput.empty() ? nullptr : s_profileOutput.c_str());
+
     if (s_core) {
 #if defined(_WINDOWS_) || defined(_WIN_)
         FreeLibrary((HMODULE)s_core);
@@ -40,188 +97,299 @@ void sdk_finish() {
     }
 }
 
+#ifndef GS_SDK_STATIC_CORE
+static void *apis[MAX_API_INDEX + 1];
+
+//in-process api provider, set by sdk_set_api_provider() / sdk_set_api_table()
+static sdk_api_resolver s_resolver = nullptr;
+static void *s_resolverData = nullptr;
+
 //Resolve all gsCore apis dynamically, must be called before any other apis
 static void resolveAPIs(void) {
-    static bool inited = false;
-    if (inited)
-        return;
-
     memset(apis, 0, sizeof(apis));
 
+    s_core = TCoreDiscovery::load();
+    if (s_core == nullptr) {
+        fprintf(stderr, "gsCore cannot be loaded!\n");
+        TCoreDiscovery::report();
+        exit(-1);
+    }
+
 #if defined(_WINDOWS_) || defined(_WIN_)
+    for (int i = MIN_API_INDEX; i <= MAX_API_INDEX; i++) {
+        apis[i] = GetProcAddress((HMODULE)s_core, (const char *)i);
+    }
+#endif
+}
 
-    const char *core_dll = "gsCore.dll";
-    HMODULE h = LoadLibraryA(core_dll);
-    if (!h) {
-        //gsCore.dll is not in the dll search path.
-        //try searching environment variable "GS_SDK_BIN"
-        char *p = getenv("GS_SDK_BIN");
-        if (p) {
-            char buf[MAX_PATH];
-            strncpy(buf, p, sizeof(buf));
-            int i = strlen(buf);
-            if (i < sizeof(buf) - 1) {
-                if (buf[i - 1] != '/' && buf[i - 1] != '\\') {
-                    buf[i] = '\\';
-                    buf[i + 1] = 0;
-                }
-            }
-            //try GS_SDK_BIN/gsCore.dll
-            std::string dll_path = std::string(buf) + core_dll;
-            h = LoadLibraryA(dll_path.c_str());
-            if (!h) {
-                //try GS_SDK_BIN/[win32|win64]/gsCore.dll
-                dll_path = std::string(buf) + (sizeof(p) == 4 ? "win32\\" : "win64\\") + core_dll;
-                h = LoadLibraryA(dll_path.c_str());
-            }
-        }
+//gsCore is bound once, either loaded by resolveAPIs() or provided in process
+static std::once_flag s_coreLoaded;
+
+bool sdk_set_api_provider(sdk_api_resolver resolver, void *usrData) {
+    if (resolver == nullptr)
+        return false;
+
+    bool accepted = false;
+    std::call_once(s_coreLoaded, [&] {
+        s_resolver = resolver;
+        s_resolverData = usrData;
+        accepted = true;
+    });
+    return accepted;
+}
+
+namespace {
+struct TApiTable {
+    const sdk_api_entry *entries;
+    int count;
+};
+
+void *lookupApiTable(int, const char *apiName, void *usrData) {
+    const TApiTable *table = (const TApiTable *)usrData;
+    for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->entries[i].name, apiName) == 0)
+            return table->entries[i].fp;
     }
-    if (h) {
-        for (int i = MIN_API_INDEX; i <= MAX_API_INDEX; i++) {
-            apis[i] = GetProcAddress(h, (const char *)i);
-        }
+    return nullptr;
+}
+} // namespace
+
+bool sdk_set_api_table(const sdk_api_entry *table, int count) {
+    static TApiTable s_table;
+    if (table == nullptr || count <= 0)
+        return false;
+
+    bool accepted = false;
+    std::call_once(s_coreLoaded, [&] {
+        s_table.entries = table;
+        s_table.count = count;
+        s_resolver = lookupApiTable;
+        s_resolverData = &s_table;
+        accepted = true;
+    });
+    return accepted;
+}
+
+bool sdk_set_core_cache(const char *fileName) {
+    return TCoreDiscovery::setCacheFile(fileName);
+}
+
+bool sdk_set_core_load_policy(int policy) {
+    return TCoreDiscovery::setLoadPolicy(policy);
+}
+
+//Looks up an api in gsCore, returns nullptr if the api is not exported.
+static void *lookupApi(int ord, const char *apiName) {
+    std::call_once(s_coreLoaded, resolveAPIs);
+    if (s_resolver)
+        return s_resolver(ord, apiName, s_resolverData);
+#if defined(_WINDOWS_) || defined(_WIN_)
+    (void)apiName;
+    return apis[ord];
+#else
+    (void)ord;
+    return dlsym(s_core, apiName);
+#endif
+}
+
+#endif
+
+//Api binders indexed by ordinal, used by sdk_prebind()
+typedef bool (*TApiBinder)();
+static TApiBinder s_binders[MAX_API_INDEX + 1];
+//Api profiling switches indexed by ordinal, used by sdk_profile_enable()
+typedef void (*TApiProfileSwitch)(bool on);
+static TApiProfileSwitch s_profileSwitches[MAX_API_INDEX + 1];
+
+struct TApiRegistrar {
+    TApiRegistrar(int ord, const char *name, TApiBinder binder, TApiProfileSwitch profileSwitch) {
+        s_binders[ord] = binder;
+        s_profileSwitches[ord] = profileSwitch;
+        TApiProfiler::registerApi(ord, name);
     }
-    s_core = h;
-#elif defined(_MAC_)
-
-    void *h = nullptr;
-    //Mac wrapped core, if loaded, will set its image base in environment
-    char *p = getenv("GS_CORE_BASE");
-    if (p) {
-        //Already loaded in memory p;
-        sscanf(p, "%p", &h);
-        printf("GS_CORE_BASE = [%p]", h);
-    } else {
-        //Load it from the directory side by side with *this* module (lib or exe)
-        char buf[4096];
-
-        dl_info di;
-        const char *core = "libgsCore.dylib";
-        if (dladdr(&apis, &di)) {
-            std::string this_module = (const char *)realpath(di.dli_fname, buf);
-            size_t i = this_module.find_last_of('/');
-            buf[i + 1] = 0;
-            strncat(buf, core, sizeof(buf));
-        } else {
-            strbcpy(buf, core, sizeof(buf));
-        }
+};
 
-        printf("Loading Core lib [%s]...\n", buf);
-        h = dlopen(buf, RTLD_LAZY | RTLD_LOCAL);
-        if (h == nullptr) {
-            printf("ERROR: cannot load core lib [%s], abort!\n", buf);
-            exit(-1);
-        }
+//Serializes api binding with profiling switches
+static std::mutex s_bindLock;
+
+#ifndef GS_SDK_STATIC_CORE
+/**
+ * Per-api function pointer slot
+ *
+ * Each api wrapper jumps through its own slot. The slot initially points to a lazy trampoline which
+ * binds the api on its first call; once bound, the wrapper calls into gsCore directly without any check.
+ * While profiling, the slot points to a trampoline timing each call of the bound api instead.
+ *
+ * The slot is constant-initialized, so an api can be called safely even during static initialization.
+ */
+template <typename Api, typename F>
+struct TApiSlot;
+
+template <typename Api, typename R, typename... A>
+struct TApiSlot<Api, R(WINAPI *)(A...)> {
+    typedef R(WINAPI *Fapi)(A...);
+    static std::atomic<Fapi> fp;     //called by the api wrapper
+    static std::atomic<Fapi> target; //bound api in gsCore
+
+    static void bind(Fapi f) {
+        std::lock_guard<std::mutex> lock(s_bindLock);
+        target.store(f, std::memory_order_release);
+        fp.store(TApiProfiler::isEnabled() ? &profiled : f, std::memory_order_release);
     }
 
-    s_core = h;
-#elif defined(_LINUX_)
-    const char *core = "libgsCore.so";
-    void *h = dlopen(core, RTLD_LAZY | RTLD_LOCAL);
-    if (!h) {
-        char buf[4096];
-        //try searching environment variable "GS_SDK_BIN"
-        char *p = getenv("GS_SDK_BIN");
-        if (p) {
-            strncpy(buf, p, sizeof(buf));
-            size_t i = strlen(buf);
-            if (i < sizeof(buf) - 1) {
-                if (buf[i - 1] != '/') {
-                    buf[i] = '/';
-                    buf[i + 1] = 0;
-                }
-            }
-            //try GS_SDK_BIN/libgsCore.so
-            std::string dll_path = std::string(buf) + core;
-            h = dlopen(dll_path.c_str(), RTLD_LAZY | RTLD_LOCAL);
-
-            if (!h) {
-                //try GS_SDK_BIN/[win32|win64]/gsCore.dll
-                dll_path = std::string(buf) + (sizeof(p) == 4 ? "linux32/" : "linux64/") + core;
-                h = dlopen(dll_path.c_str(), RTLD_LAZY | RTLD_LOCAL);
-            }
-        }
-        //sdk core cannot be loaded in standard way, try searching it side by side
-        //with current executable
-
-        if (!h) {
-            Dl_info di;
-            if (dladdr(&apis, &di)) {
-                std::string this_module = (const char *)realpath(di.dli_fname, buf);
-                size_t i = this_module.find_last_of('/');
-                buf[i + 1] = 0;
-                strncat(buf, core, sizeof(buf));
-            } else {
-                strncpy(buf, core, sizeof(buf));
-            }
+    //binds on first call
+    static R WINAPI lazy(A... args) {
+        Fapi f = (Fapi)lookupApi(Api::index, Api::name());
+        bind(f ? f : &missing);
+        return fp.load(std::memory_order_acquire)(args...);
+    }
+    //binds in advance, returns false if the api is not exported by gsCore
+    static bool prebind() {
+        Fapi f = (Fapi)lookupApi(Api::index, Api::name());
+        bind(f ? f : &missing);
+        return f != nullptr;
+    }
+    //bound to an api not exported by gsCore (older version)
+    static R WINAPI missing(A...) {
+        return R();
+    }
 
-            printf("Loading Core lib [%s]...\n", buf);
-            h = dlopen(buf, RTLD_LAZY | RTLD_LOCAL);
-        }
+    static R WINAPI profiled(A... args) {
+        TApiTimer timer(Api::index, true);
+        return target.load(std::memory_order_acquire)(args...);
     }
-    s_core = h;
+    //called with s_bindLock held
+    static void profile(bool on) {
+        Fapi f = target.load(std::memory_order_acquire);
+        if (f)
+            fp.store(on ? &profiled : f, std::memory_order_release);
+    }
+};
+
+template <typename Api, typename R, typename... A>
+std::atomic<R(WINAPI *)(A...)> TApiSlot<Api, R(WINAPI *)(A...)>::fp(&TApiSlot<Api, R(WINAPI *)(A...)>::lazy);
+
+template <typename Api, typename R, typename... A>
+std::atomic<R(WINAPI *)(A...)> TApiSlot<Api, R(WINAPI *)(A...)>::target(nullptr);
 #else
-#error("Either _WIN_, _LINUX_ or _MAC_ must be defined to build SoftwareShield SDK-C!")
+//gsCore is linked in statically, there is nothing to load or provide
+bool sdk_set_api_provider(sdk_api_resolver, void *) { return false; }
+bool sdk_set_api_table(const sdk_api_entry *, int) { return false; }
+
+bool sdk_set_core_cache(const char *) { return false; }
+bool sdk_set_core_load_policy(int) { return false; }
+
+static bool linkedApi() { return true; }
 #endif
-    inited = true;
 
-    if (s_core == nullptr) {
-        fprintf(stderr, "gsCore cannot be loaded!\n");
-        exit(-1);
-    }
+const sdk_core_discovery *sdk_get_core_discovery() {
+    return TCoreDiscovery::result();
 }
 
-#ifdef _WINDOWS_
-#define RESOLVE_API(ord, apiName) \
-    {                             \
-        resolveAPIs();            \
-        assert(apis[ord]);        \
+void sdk_profile_enable(bool on) {
+    std::lock_guard<std::mutex> lock(s_bindLock);
+    if (on)
+        s_profiled = true;
+    TApiProfiler::setEnabled(on);
+    for (int i = MIN_API_INDEX; i <= MAX_API_INDEX; i++) {
+        if (s_profileSwitches[i])
+            s_profileSwitches[i](on);
     }
-#else
-//Unix..
-void resolveApi(int ord, const char *apiName) {
-    if (nullptr == s_core)
-        resolveAPIs();
+}
 
-    if (nullptr == apis[ord]) {
-        apis[ord] = dlsym(s_core, apiName);
-    }
-    assert(apis[ord]);
+bool sdk_profile_enabled() {
+    return TApiProfiler::isEnabled();
+}
+
+bool sdk_profile_get_stats(int ord, sdk_api_stats *stats) {
+    return TApiProfiler::getStats(ord, stats);
+}
+
+void sdk_profile_reset() {
+    TApiProfiler::reset();
+}
+
+void sdk_profile_dump(const char *fileName) {
+    TApiProfiler::dump(fileName);
+}
+
+//Capability bitmap, the bit of an api is set if it is exported by gsCore
+static uint64_t s_apiBitmap[(SDK_MAX_API_ORDINAL + 1) / 64];
+
+int sdk_prebind() {
+    static std::once_flag prebound;
+    static int total = 0;
+    std::call_once(prebound, [] {
+        for (int i = MIN_API_INDEX; i <= MAX_API_INDEX; i++) {
+            if (s_binders[i] && s_binders[i]()) {
+                s_apiBitmap[i / 64] |= (uint64_t)1 << (i % 64);
+                total++;
+            }
+        }
+    });
+    return total;
 }
 
-#define RESOLVE_API(ord, apiName) \
-    { resolveApi(ord, #apiName); }
+bool gsHasApi(int ord) {
+    if (ord < 0 || ord > SDK_MAX_API_ORDINAL)
+        return false;
+    sdk_prebind();
+    return (s_apiBitmap[ord / 64] >> (ord % 64)) & 1;
+}
+
+void sdk_warm_up() {
+    warmUp().start([] { sdk_prebind(); });
+}
+
+#ifdef GS_SDK_STATIC_CORE
+//Declares an api exported by the statically linked gsCore, it is called directly (and can be inlined by LTO)
+#define API_SLOT(ord, apiName, retType, params)       \
+    namespace core {                                  \
+    extern "C" retType WINAPI apiName params;         \
+    }                                                 \
+    enum { ord_##apiName = ord };                     \
+    static TApiRegistrar s_reg_##apiName(ord, #apiName, linkedApi, nullptr);
+
+//the timer lives until the end of the call expression, when profiling is off it only costs a flag check
+#define API_CALL(apiName) (TApiTimer(ord_##apiName, TApiProfiler::isEnabled()), core::apiName)
+#else
+//Declares the function pointer slot of an api
+#define API_SLOT(ord, apiName, retType, params)                          \
+    struct api_##apiName {                                                \
+        enum { index = ord };                                             \
+        static const char *name() { return #apiName; }                    \
+        typedef retType(WINAPI *Fapi) params;                             \
+    };                                                                    \
+    typedef TApiSlot<api_##apiName, api_##apiName::Fapi> slot_##apiName;  \
+    static TApiRegistrar s_reg_##apiName(ord, #apiName, slot_##apiName::prebind, slot_##apiName::profile);
+
+#define API_CALL(apiName) slot_##apiName::fp.load(std::memory_order_acquire)
 #endif
 
 #define FUNC_CALL(...) \
     (__VA_ARGS__);     \
     }
 
-#define BIND_FUNC(ord, retType, apiName, ...)     \
-    retType apiName(__VA_ARGS__) {                  \
-        RESOLVE_API(ord, apiName);                  \
-        typedef retType(WINAPI *Fapi)(__VA_ARGS__); \
-        return (*(Fapi)apis[ord])FUNC_CALL
-
-#define BIND_PROC(ord, apiName, ...)            \
-    void apiName(__VA_ARGS__) {                   \
-        RESOLVE_API(ord, apiName);                \
-        typedef void(WINAPI * Fapi)(__VA_ARGS__); \
-        (*(Fapi)apis[ord]) FUNC_CALL
+#define BIND_FUNC(ord, retType, apiName, ...)          \
+    API_SLOT(ord, apiName, retType, (__VA_ARGS__))     \
+    retType apiName(__VA_ARGS__) {                     \
+        return API_CALL(apiName)FUNC_CALL
 
+#define BIND_PROC(ord, apiName, ...)                   \
+    API_SLOT(ord, apiName, void, (__VA_ARGS__))        \
+    void apiName(__VA_ARGS__) {                        \
+        API_CALL(apiName)FUNC_CALL
 
-#define BIND_PROC0(ord, apiName)       \
-    void apiName() {                   \
-        RESOLVE_API(ord, apiName);     \
-        typedef void(WINAPI * Fapi)(); \
-        (*(Fapi)apis[ord])();          \
+#define BIND_PROC0(ord, apiName)   \
+    API_SLOT(ord, apiName, void, ()) \
+    void apiName() {               \
+        API_CALL(apiName)();       \
     }
 
 #define BIND_FUNC0(ord, retType, apiName) \
+    API_SLOT(ord, apiName, retType, ())   \
     retType apiName() {                   \
-        RESOLVE_API(ord, apiName);        \
-        typedef retType(WINAPI *Fapi)();  \
-        return (*(Fapi)apis[ord])();      \
+        return API_CALL(apiName)();       \
     }
 
 BIND_FUNC(3, int, gsInit, const char *productId, const char *origLic, const char *password, void *reserved)
@@ -374,6 +374,194 @@ typedef gs_handle_t(WINAPI *lm_create_callback)(void *usrData);
 // the last api called to explicitly release the internal resources used by SDK
 void sdk_finish();
 
+/**
+  * \brief Resolves all gsCore apis in advance (optional)
+  *
+  *  By default each api is bound lazily on its first call. Calling this api once at startup loads gsCore
+  *  and binds the whole api table, so the cost of symbol lookup never lands on a licensing call, and
+  *  all threads see a fully resolved table afterwards.
+  *
+  *  It is thread-safe and only the first call does the work.
+  *
+  * \return the number of apis bound.
+  */
+int sdk_prebind();
+
+/** @name Api capabilities
+ *
+ *  gsCore v5.x does not export all the apis of v6.x. An api not exported by the loaded gsCore can still be
+ *  called safely: it does nothing and returns a default value (0, false or NULL).
+ */
+//@{
+/// Highest api ordinal (ref: GS5_Intf.cpp)
+#define SDK_MAX_API_ORDINAL 255
+
+/**
+  * \brief Is an api exported by gsCore?
+  *
+  *  All apis are probed once, by the first call (see sdk_prebind()), afterwards it is only a bit test.
+  *
+  * \param ord ordinal of the api (ref: GS5_Intf.cpp)
+  */
+bool gsHasApi(int ord);
+//@}
+
+/** @name In-process gsCore */
+//@{
+/**
+  * \brief Resolves a gsCore api in process
+  *
+  * \param ord ordinal of the api (ref: GS5_Intf.cpp)
+  * \param apiName name of the api, such as "gsInit"
+  * \param usrData user data passed to sdk_set_api_provider()
+  *
+  * \return address of the api implementation, nullptr if it is not provided.
+  */
+typedef void *(*sdk_api_resolver)(int ord, const char *apiName, void *usrData);
+
+/**
+  * \brief Uses an in-process gsCore instead of loading it dynamically
+  *
+  *  The apis are then resolved by the provider, gsCore is never searched nor loaded.
+  *  It must be called before any other api, after that the api provider cannot be changed anymore.
+  *
+  * \return true if the provider is accepted, false if gsCore is already bound.
+  */
+bool sdk_set_api_provider(sdk_api_resolver resolver, void *usrData);
+
+/// Entry of an api table
+struct sdk_api_entry {
+    const char *name; ///< name of the api, such as "gsInit"
+    void *fp;         ///< address of the api implementation
+};
+
+/**
+  * \brief Uses a table of apis provided in process (a statically linked gsCore, a fake...)
+  *
+  *  Same as sdk_set_api_provider(), the apis are looked up in the table by name. The table is not
+  *  copied, it must stay valid as long as the apis are used.
+  *
+  * \return true if the table is accepted, false if gsCore is already bound.
+  */
+bool sdk_set_api_table(const sdk_api_entry *table, int count);
+//@}
+
+/** @name gsCore discovery
+ *
+ *  gsCore is searched in the system library path, then in GS_SDK_BIN (and its platform sub-folder), then
+ *  side by side with the module linking the SDK. Each location probed is timed.
+ *
+ *  When a cache file is given (sdk_set_core_cache() or environment variable GS_SDK_CORE_CACHE=<file>),
+ *  the full path of the loaded gsCore is saved to it, and later launches load that path first. A stale
+ *  cache only costs one failed probe, the file is then updated.
+ */
+//@{
+/// A location probed for gsCore
+struct sdk_core_probe {
+    const char *source; ///< why it is probed: "cache", "search path", "GS_SDK_BIN", "module directory"...
+    const char *path;   ///< path passed to the system loader
+    uint64_t elapsed;   ///< time spent loading (ns)
+    bool loaded;        ///< gsCore is loaded from this path
+};
+
+/// Result of gsCore discovery
+struct sdk_core_discovery {
+    const char *path;             ///< full path of the loaded gsCore, empty if not found
+    bool cached;                  ///< loaded from the path in the cache file
+    uint64_t elapsed;             ///< total discovery time (ns)
+    int probeCount;               ///< number of locations probed
+    const sdk_core_probe *probes; ///< locations probed, in order
+    uint64_t prefault;            ///< time spent prefaulting the gsCore image (ns), included in elapsed
+};
+
+/**
+  * \brief Sets the file caching the location of gsCore
+  *
+  *  It overrides GS_SDK_CORE_CACHE, an empty file name disables the cache.
+  *  It must be called before any other api.
+  *
+  * \return false if gsCore is already loaded (or never loaded, see sdk_set_api_provider())
+  */
+bool sdk_set_core_cache(const char *fileName);
+/// Gets how gsCore has been located, nullptr if gsCore is not loaded (yet) or is provided in process
+const sdk_core_discovery *sdk_get_core_discovery();
+//@}
+
+/** @name gsCore load policy
+ *
+ *  By default gsCore is loaded lazily: its symbols are relocated, and its pages are read from disk, when
+ *  they are first used, so these costs land on the first licensing calls. The policy is set either by
+ *  sdk_set_core_load_policy() or by environment variable GS_SDK_CORE_LOAD, a comma separated list of
+ *  "lazy", "now" and "prefault" (ex: GS_SDK_CORE_LOAD=now,prefault).
+ *
+ *  Combined with sdk_warm_up(), gsCore is then fully loaded before the first licensing call.
+ */
+//@{
+/// Symbols are relocated on first use (default)
+#define SDK_CORE_LOAD_LAZY 0
+/// All symbols are relocated when gsCore is loaded (RTLD_NOW)
+#define SDK_CORE_LOAD_NOW 1
+/// The gsCore image is read ahead and its pages are faulted in when it is loaded (Linux, Windows)
+#define SDK_CORE_LOAD_PREFAULT 2
+
+/**
+  * \brief Sets how gsCore is loaded
+  *
+  *  It overrides GS_SDK_CORE_LOAD, it must be called before any other api.
+  *
+  * \param policy SDK_CORE_LOAD_LAZY or a combination of SDK_CORE_LOAD_NOW and SDK_CORE_LOAD_PREFAULT
+  * \return false if gsCore is already loaded (or never loaded, see sdk_set_api_provider())
+  */
+bool sdk_set_core_load_policy(int policy);
+
+/**
+  * \brief Loads gsCore and binds all apis in a background thread
+  *
+  *  The warm-up runs while the app is starting, an api called meanwhile waits for gsCore to be loaded.
+  *  Only the first call starts the warm-up, sdk_finish() waits for it to complete (so does the program exit if
+  *  sdk_finish() is never called). Does nothing once sdk_finish() has been called.
+  */
+void sdk_warm_up();
+//@}
+
+/** @name Api profiling
+ *
+ *  Counts the calls and records a latency histogram of each gsCore api. Profiling is off by default,
+ *  it is turned on either by sdk_profile_enable() or by environment variable GS_SDK_PROFILE:
+ *
+ *  - GS_SDK_PROFILE=1: profiles the apis and dumps the result to stderr in sdk_finish();
+ *  - GS_SDK_PROFILE=<file>: profiles the apis and dumps the result to file in sdk_finish();
+ *
+ *  When profiling is off the api calls are not instrumented at all.
+ */
+//@{
+/// Latency statistics of a gsCore api, all durations in nanoseconds
+struct sdk_api_stats {
+    const char *name; ///< name of the api
+    uint64_t calls;   ///< total calls (all threads)
+    uint64_t total;   ///< total time spent in the api
+    uint64_t min, max;
+    uint64_t p50, p90, p99, p999; ///< percentiles (within 1/16 of the exact value)
+};
+
+/// Turns api profiling on / off, can be called at any time
+void sdk_profile_enable(bool on);
+/// Is api profiling on?
+bool sdk_profile_enabled();
+/**
+  * \brief Gets the statistics of an api
+  *
+  * \param ord ordinal of the api (ref: GS5_Intf.cpp)
+  * \param stats receives the statistics merged from all threads
+  * \return false if the api has not been called while profiling
+  */
+bool sdk_profile_get_stats(int ord, sdk_api_stats *stats);
+/// Clears all statistics
+void sdk_profile_reset();
+/// Dumps the statistics of all called apis (sorted by total time) to a file, or stderr if fileName is NULL; nothing if no call was recorded
+void sdk_profile_dump(const char *fileName = NULL);
+//@}
+
 /**
    * \brief One-time Initialization of gsCore
    *
@@ -0,0 +1,48 @@
+#include "GS5_LM.h"
+
+#include <cstring>
+
+namespace gs {
+
+//************** TLicenseModelBase *******************
+
+void TLicenseModelBase::bind(TLicenseHandle license, const char *lmId, const char *const *names, const var_type_t *types, Variable *vars, int count) {
+    if (license == INVALID_GS_HANDLE)
+        gs5_error::raise(GS_ERROR_INVALID_LICENSE, "License model [%s] is not bound to a license", lmId);
+    const char *id = gsGetLicenseId(license);
+    if (id == nullptr || strcmp(id, lmId) != 0)
+        gs5_error::raise(GS_ERROR_INVALID_LICENSE, "License [%s] is not of model [%s]", id ? id : "", lmId);
+
+    //read first, so that a license changing while resolving leaves the model stale
+    _generation = TGSCore::getInstance()->licenseGeneration();
+    _license = license;
+    for (int i = 0; i < count; i++)
+        vars[i].close();
+
+    //one pass over the license parameters, each name compared once here and never again
+    int found = 0;
+    int N = gsGetLicenseParamCount(license);
+    for (int k = 0; k < N && found < count; k++) {
+        Variable v(gsGetLicenseParamByIndex(license, k));
+        const char *name = gsGetVariableName(v.handle());
+        for (int i = 0; i < count; i++) {
+            if (!vars[i] && strcmp(name, names[i]) == 0) {
+                if (gsGetVariableType(v.handle()) != types[i])
+                    gs5_error::raise(GS_ERROR_INVALID_VALUE, "Parameter [%s] of [%s] is not of type [%s]", names[i], lmId, gsVariableTypeToString(types[i]));
+                vars[i] = std::move(v);
+                found++;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (!vars[i])
+            gs5_error::raise(GS_ERROR_INVALID_NAME, "Parameter [%s] not found in license [%s]", names[i], lmId);
+    }
+}
+
+bool TLicenseModelBase::stale() const {
+    return _license == INVALID_GS_HANDLE || _generation != TGSCore::getInstance()->licenseGeneration();
+}
+
+} // namespace gs
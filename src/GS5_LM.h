@@ -0,0 +1,264 @@
+/*! \file GS5_LM.h
+  \brief Built-in license model schemas [ C++ Only ]
+
+  The parameters of the built-in license models are described at compile time, a misspelled parameter does not
+  compile:
+
+  \code
+  TLicenseModel<lm::HardDate> hd(entity.license());
+  if (hd.get<lm::HardDate::timeEndEnabled>())
+      expire = hd.get<lm::HardDate::timeEnd>();
+  \endcode
+
+  A TLicenseModel resolves all of its parameters in one pass over the license parameters when bound, later reads
+  and writes index a variable handle directly.
+  */
+#ifndef _GS5_LM_H_
+#define _GS5_LM_H_
+
+#include <ctime>
+
+#include "GS5.h"
+
+namespace gs {
+
+/// Value type of a parameter by its variable type (ref: \ref varType)
+template <var_type_t VarType>
+struct TVarValue;
+
+template <>
+struct TVarValue<VAR_TYPE_INT> {
+    typedef int type;
+    static type get(const Variable &v) { return v.asInt(); }
+    static void set(Variable &v, type x) { v.fromInt(x); }
+};
+template <>
+struct TVarValue<VAR_TYPE_INT64> {
+    typedef int64_t type;
+    static type get(const Variable &v) { return v.asInt64(); }
+    static void set(Variable &v, type x) { v.fromInt64(x); }
+};
+template <>
+struct TVarValue<VAR_TYPE_FLOAT> {
+    typedef float type;
+    static type get(const Variable &v) { return v.asFloat(); }
+    static void set(Variable &v, type x) { v.fromFloat(x); }
+};
+template <>
+struct TVarValue<VAR_TYPE_DOUBLE> {
+    typedef double type;
+    static type get(const Variable &v) { return v.asDouble(); }
+    static void set(Variable &v, type x) { v.fromDouble(x); }
+};
+template <>
+struct TVarValue<VAR_TYPE_BOOL> {
+    typedef bool type;
+    static type get(const Variable &v) { return v.asBool(); }
+    static void set(Variable &v, type x) { v.fromBool(x); }
+};
+template <>
+struct TVarValue<VAR_TYPE_STRING> {
+    typedef const char *type;
+    static type get(const Variable &v) { return v.asString(); }
+    static void set(Variable &v, type x) { v.fromString(x); }
+};
+template <>
+struct TVarValue<VAR_TYPE_TIME> {
+    typedef time_t type;
+    static type get(const Variable &v) { return v.asUTCTime(); }
+    static void set(Variable &v, type x) { v.fromUTCTime(x); }
+};
+
+/// Parameter descriptor, a schema declares one subclass per parameter providing its name
+template <var_type_t VarType>
+struct TLMParam {
+    static constexpr var_type_t varType = VarType;
+    typedef typename TVarValue<VarType>::type type;
+};
+
+template <var_type_t VarType>
+constexpr var_type_t TLMParam<VarType>::varType;
+
+/// List of the parameter descriptors of a license model
+template <typename... Params>
+struct TLMParams {
+    static constexpr int count = sizeof...(Params);
+};
+
+namespace lm {
+
+/// Expire by hard date: valid in [timeBegin, timeEnd)
+struct HardDate {
+    static constexpr const char *id() { return "gs.lm.expire.hardDate.1"; }
+
+    struct timeBeginEnabled : TLMParam<VAR_TYPE_BOOL> {
+        static constexpr const char *name() { return "timeBeginEnabled"; }
+    };
+    struct timeBegin : TLMParam<VAR_TYPE_TIME> {
+        static constexpr const char *name() { return "timeBegin"; }
+    };
+    struct timeEndEnabled : TLMParam<VAR_TYPE_BOOL> {
+        static constexpr const char *name() { return "timeEndEnabled"; }
+    };
+    struct timeEnd : TLMParam<VAR_TYPE_TIME> {
+        static constexpr const char *name() { return "timeEnd"; }
+    };
+    /// clock rollback tolerated, in seconds
+    struct rollbackTolerance : TLMParam<VAR_TYPE_INT> {
+        static constexpr const char *name() { return "rollbackTolerance"; }
+    };
+    struct exitAppOnExpire : TLMParam<VAR_TYPE_BOOL> {
+        static constexpr const char *name() { return "exitAppOnExpire"; }
+    };
+
+    typedef TLMParams<timeBeginEnabled, timeBegin, timeEndEnabled, timeEnd, rollbackTolerance, exitAppOnExpire> params;
+};
+
+/// Expire by period: valid for periodInSeconds since the first access
+struct Period {
+    static constexpr const char *id() { return "gs.lm.expire.period.1"; }
+
+    struct periodInSeconds : TLMParam<VAR_TYPE_INT> {
+        static constexpr const char *name() { return "periodInSeconds"; }
+    };
+    struct timeFirstAccess : TLMParam<VAR_TYPE_TIME> {
+        static constexpr const char *name() { return "timeFirstAccess"; }
+    };
+    struct rollbackTolerance : TLMParam<VAR_TYPE_INT> {
+        static constexpr const char *name() { return "rollbackTolerance"; }
+    };
+    struct exitAppOnExpire : TLMParam<VAR_TYPE_BOOL> {
+        static constexpr const char *name() { return "exitAppOnExpire"; }
+    };
+
+    typedef TLMParams<periodInSeconds, timeFirstAccess, rollbackTolerance, exitAppOnExpire> params;
+};
+
+/// Expire by duration: valid until the time used reaches maxDurationInSeconds
+struct Duration {
+    static constexpr const char *id() { return "gs.lm.expire.duration.1"; }
+
+    struct maxDurationInSeconds : TLMParam<VAR_TYPE_INT> {
+        static constexpr const char *name() { return "maxDurationInSeconds"; }
+    };
+    struct usedDurationInSeconds : TLMParam<VAR_TYPE_INT> {
+        static constexpr const char *name() { return "usedDurationInSeconds"; }
+    };
+    struct exitAppOnExpire : TLMParam<VAR_TYPE_BOOL> {
+        static constexpr const char *name() { return "exitAppOnExpire"; }
+    };
+
+    typedef TLMParams<maxDurationInSeconds, usedDurationInSeconds, exitAppOnExpire> params;
+};
+
+/// Expire by access times: valid until usedTimes reaches maxAccessTimes
+struct AccessTime {
+    static constexpr const char *id() { return "gs.lm.expire.accessTime.1"; }
+
+    struct maxAccessTimes : TLMParam<VAR_TYPE_INT> {
+        static constexpr const char *name() { return "maxAccessTimes"; }
+    };
+    struct usedTimes : TLMParam<VAR_TYPE_INT> {
+        static constexpr const char *name() { return "usedTimes"; }
+    };
+    struct exitAppOnExpire : TLMParam<VAR_TYPE_BOOL> {
+        static constexpr const char *name() { return "exitAppOnExpire"; }
+    };
+
+    typedef TLMParams<maxAccessTimes, usedTimes, exitAppOnExpire> params;
+};
+
+} // namespace lm
+
+/// Index of a parameter descriptor in a parameter list, -1 if not found
+template <typename Param, typename... Params>
+struct TLMParamIndex;
+
+template <typename Param>
+struct TLMParamIndex<Param> {
+    static constexpr int value = -1;
+};
+template <typename Param, typename... Params>
+struct TLMParamIndex<Param, Param, Params...> {
+    static constexpr int value = 0;
+};
+template <typename Param, typename First, typename... Params>
+struct TLMParamIndex<Param, First, Params...> {
+    static constexpr int value = TLMParamIndex<Param, Params...>::value < 0 ? -1 : 1 + TLMParamIndex<Param, Params...>::value;
+};
+
+/// Untyped part of TLicenseModel
+class TLicenseModelBase {
+  private:
+    TLicenseHandle _license;
+    unsigned int _generation;
+
+  protected:
+    TLicenseModelBase() : _license(INVALID_GS_HANDLE), _generation(0) {}
+
+    /// Checks the license model id, then resolves the named parameters in a single pass, raises gs5_error on mismatch
+    void bind(TLicenseHandle license, const char *lmId, const char *const *names, const var_type_t *types, Variable *vars, int count);
+    /// Resolves the parameters again if the license has changed since bound
+    void refresh(const char *lmId, const char *const *names, const var_type_t *types, Variable *vars, int count) {
+        if (stale())
+            bind(_license, lmId, names, types, vars, count);
+    }
+
+  public:
+    /// Bound to a license?
+    explicit operator bool() const { return _license != INVALID_GS_HANDLE; }
+    /// Has the license changed since bound? (parameters are resolved again on next access)
+    bool stale() const;
+};
+
+/** \brief Typed accessor of a license model's parameters
+  *
+  * Schema: one of the gs::lm schemas (lm::HardDate...), the license is not owned and must outlive the accessor.
+  */
+template <typename Schema, typename List = typename Schema::params>
+class TLicenseModel;
+
+template <typename Schema, typename... Params>
+class TLicenseModel<Schema, TLMParams<Params...>> : public TLicenseModelBase {
+  private:
+    Variable _vars[sizeof...(Params)];
+
+    static const char *const *names() {
+        static const char *const n[] = {Params::name()...};
+        return n;
+    }
+    static const var_type_t *types() {
+        static const var_type_t t[] = {Params::varType...};
+        return t;
+    }
+
+    template <typename Param>
+    Variable &var() {
+        static_assert(TLMParamIndex<Param, Params...>::value >= 0, "parameter not defined by the license model");
+        refresh(Schema::id(), names(), types(), _vars, sizeof...(Params));
+        return _vars[TLMParamIndex<Param, Params...>::value];
+    }
+
+  public:
+    TLicenseModel() {}
+    explicit TLicenseModel(const License &license) { bind(license.handle()); }
+    explicit TLicenseModel(TGSLicense *license) { bind(license->handle()); }
+
+    /// Binds to a license of this model
+    void bind(TLicenseHandle license) {
+        TLicenseModelBase::bind(license, Schema::id(), names(), types(), _vars, sizeof...(Params));
+    }
+
+    template <typename Param>
+    typename Param::type get() {
+        return TVarValue<Param::varType>::get(var<Param>());
+    }
+    template <typename Param>
+    void set(typename Param::type v) {
+        TVarValue<Param::varType>::set(var<Param>(), v);
+    }
+};
+
+} // namespace gs
+
+#endif
@@ -0,0 +1,229 @@
+#include "GS5_Profile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace gs {
+
+#define MAX_API_ORDINAL 255
+
+namespace {
+/**
+ * HDR-style histogram: values below 16 ns are counted exactly, above that each power of two is
+ * split into 16 linear buckets, so a recorded value is within 1/16 of the real one.
+ */
+const int SUB_BITS = 4;
+const int SUB_COUNT = 1 << SUB_BITS;
+const int MAX_EXP = 40; //~18 minutes, longer calls are clamped
+const int TOTAL_BUCKETS = SUB_COUNT + (MAX_EXP - SUB_BITS + 1) * SUB_COUNT;
+
+int log2u64(uint64_t v) {
+    int r = 0;
+    for (int shift = 32; shift > 0; shift >>= 1) {
+        if (v >> shift) {
+            v >>= shift;
+            r += shift;
+        }
+    }
+    return r;
+}
+
+int bucketOf(uint64_t v) {
+    if (v < (uint64_t)SUB_COUNT)
+        return (int)v;
+    int e = log2u64(v);
+    if (e > MAX_EXP) {
+        e = MAX_EXP;
+        v = ~(uint64_t)0 >> (63 - MAX_EXP);
+    }
+    return SUB_COUNT + (e - SUB_BITS) * SUB_COUNT + (int)((v >> (e - SUB_BITS)) - SUB_COUNT);
+}
+
+//middle of the value range of a bucket
+uint64_t valueOf(int bucket) {
+    if (bucket < SUB_COUNT)
+        return bucket;
+    int k = bucket - SUB_COUNT;
+    int shift = k / SUB_COUNT;
+    uint64_t low = (uint64_t)(k % SUB_COUNT + SUB_COUNT) << shift;
+    return low + (((uint64_t)1 << shift) >> 1);
+}
+
+//Counter written by its owner thread only, read by any thread
+struct TCounter {
+    std::atomic<uint64_t> v;
+
+    TCounter() : v(0) {}
+    uint64_t get() const { return v.load(std::memory_order_relaxed); }
+    void set(uint64_t x) { v.store(x, std::memory_order_relaxed); }
+    void add(uint64_t x) { set(get() + x); }
+};
+
+struct THistogram {
+    TCounter calls, total, min, max;
+    TCounter buckets[TOTAL_BUCKETS];
+
+    THistogram() { min.set(~(uint64_t)0); }
+
+    void add(uint64_t ns) {
+        calls.add(1);
+        total.add(ns);
+        if (ns < min.get())
+            min.set(ns);
+        if (ns > max.get())
+            max.set(ns);
+        buckets[bucketOf(ns)].add(1);
+    }
+
+    void clear() {
+        calls.set(0);
+        total.set(0);
+        min.set(~(uint64_t)0);
+        max.set(0);
+        for (TCounter &b : buckets)
+            b.set(0);
+    }
+};
+
+//Per-thread statistics, histograms are allocated on the first call of an api
+struct TShard {
+    std::atomic<THistogram *> apis[MAX_API_ORDINAL + 1];
+
+    TShard() {
+        for (auto &api : apis)
+            api.store(nullptr, std::memory_order_relaxed);
+    }
+};
+
+//All shards ever created, a shard outlives its thread so that its statistics are kept
+std::mutex s_shardLock;
+std::vector<TShard *> s_shards;
+
+thread_local TShard *t_shard = nullptr;
+
+const char *s_apiNames[MAX_API_ORDINAL + 1];
+
+TShard *newShard() {
+    TShard *shard = new TShard();
+    std::lock_guard<std::mutex> lock(s_shardLock);
+    s_shards.push_back(shard);
+    return shard;
+}
+
+std::vector<TShard *> shards() {
+    std::lock_guard<std::mutex> lock(s_shardLock);
+    return s_shards;
+}
+
+} // namespace
+
+std::atomic<bool> TApiProfiler::s_enabled(false);
+
+void TApiProfiler::registerApi(int ord, const char *name) {
+    if (ord >= 0 && ord <= MAX_API_ORDINAL)
+        s_apiNames[ord] = name;
+}
+
+void TApiProfiler::record(int ord, uint64_t ns) {
+    TShard *shard = t_shard;
+    if (shard == nullptr)
+        shard = t_shard = newShard();
+
+    THistogram *h = shard->apis[ord].load(std::memory_order_relaxed);
+    if (h == nullptr) {
+        h = new THistogram();
+        shard->apis[ord].store(h, std::memory_order_release);
+    }
+    h->add(ns);
+}
+
+bool TApiProfiler::getStats(int ord, sdk_api_stats *stats) {
+    if (ord < 0 || ord > MAX_API_ORDINAL || stats == nullptr)
+        return false;
+
+    std::vector<uint64_t> buckets(TOTAL_BUCKETS, 0);
+    memset(stats, 0, sizeof(*stats));
+    stats->name = s_apiNames[ord] ? s_apiNames[ord] : "";
+    stats->min = ~(uint64_t)0;
+
+    for (TShard *shard : shards()) {
+        THistogram *h = shard->apis[ord].load(std::memory_order_acquire);
+        if (h == nullptr || h->calls.get() == 0)
+            continue;
+        stats->calls += h->calls.get();
+        stats->total += h->total.get();
+        stats->min = std::min(stats->min, h->min.get());
+        stats->max = std::max(stats->max, h->max.get());
+        for (int i = 0; i < TOTAL_BUCKETS; i++)
+            buckets[i] += h->buckets[i].get();
+    }
+    if (stats->calls == 0) {
+        stats->min = 0;
+        return false;
+    }
+
+    //percentiles
+    struct {
+        double q;
+        uint64_t *v;
+    } pcts[] = {{0.5, &stats->p50}, {0.9, &stats->p90}, {0.99, &stats->p99}, {0.999, &stats->p999}};
+
+    uint64_t total = 0;
+    for (uint64_t n : buckets)
+        total += n;
+
+    uint64_t seen = 0;
+    size_t k = 0;
+    for (int i = 0; i < TOTAL_BUCKETS && k < sizeof(pcts) / sizeof(pcts[0]); i++) {
+        seen += buckets[i];
+        while (k < sizeof(pcts) / sizeof(pcts[0]) && seen > 0 && seen >= pcts[k].q * total) {
+            //clamped to the exact range observed
+            *pcts[k].v = std::max(stats->min, std::min(stats->max, valueOf(i)));
+            k++;
+        }
+    }
+    return true;
+}
+
+void TApiProfiler::reset() {
+    for (TShard *shard : shards()) {
+        for (auto &api : shard->apis) {
+            THistogram *h = api.load(std::memory_order_acquire);
+            if (h)
+                h->clear();
+        }
+    }
+}
+
+void TApiProfiler::dump(const char *fileName) {
+    std::vector<sdk_api_stats> all;
+    for (int ord = 0; ord <= MAX_API_ORDINAL; ord++) {
+        sdk_api_stats stats;
+        if (getStats(ord, &stats))
+            all.push_back(stats);
+    }
+    //nothing recorded, e.g. the statistics were reset
+    if (all.empty())
+        return;
+    std::sort(all.begin(), all.end(), [](const sdk_api_stats &a, const sdk_api_stats &b) { return a.total > b.total; });
+
+    FILE *f = fileName ? fopen(fileName, "w") : stderr;
+    if (f == nullptr)
+        return;
+
+    fprintf(f, "gsCore api profile (%d threads)\n", (int)shards().size());
+    fprintf(f, "%-36s %10s %12s %10s %10s %10s %10s %10s %10s\n", "api", "calls", "total(us)", "mean(ns)", "p50", "p90", "p99", "p99.9", "max");
+    for (const sdk_api_stats &s : all) {
+        fprintf(f, "%-36s %10llu %12.1f %10llu %10llu %10llu %10llu %10llu %10llu\n", s.name, (unsigned long long)s.calls, s.total / 1000.0,
+                (unsigned long long)(s.total / s.calls), (unsigned long long)s.p50, (unsigned long long)s.p90, (unsigned long long)s.p99,
+                (unsigned long long)s.p999, (unsigned long long)s.max);
+    }
+
+    if (f != stderr)
+        fclose(f);
+}
+
+} // namespace gs
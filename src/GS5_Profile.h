@@ -0,0 +1,63 @@
+/*! \file GS5_Profile.h
+	\brief gsCore api profiler (internal)
+
+	Counts the calls and records the latency of each gsCore api, used by the api wrappers in GS5_Intf.cpp.
+	The public switches are sdk_profile_xxx() declared in GS5_Intf.h.
+*/
+#ifndef _GS5_PROFILE_H_
+#define _GS5_PROFILE_H_
+
+#include "GS5_Intf.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace gs {
+
+/**
+*  \brief Api call profiler
+*
+*  Every thread records into its own shard, so recording a call never contends with other threads;
+*  the shards are only merged when the statistics are read.
+*/
+class TApiProfiler {
+  private:
+    static std::atomic<bool> s_enabled;
+
+  public:
+    /// Is profiling enabled?
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool on) { s_enabled.store(on, std::memory_order_relaxed); }
+
+    /// Registers the name of an api ordinal
+    static void registerApi(int ord, const char *name);
+    /// Records a call of api ord lasting ns nanoseconds
+    static void record(int ord, uint64_t ns);
+
+    static bool getStats(int ord, sdk_api_stats *stats);
+    static void reset();
+    static void dump(const char *fileName);
+};
+
+/// Times an api call, the duration is recorded when the timer goes out of scope
+class TApiTimer {
+  private:
+    typedef std::chrono::steady_clock clk;
+
+    int _ord;
+    clk::time_point _start;
+
+  public:
+    TApiTimer(int ord, bool on) : _ord(on ? ord : -1) {
+        if (on)
+            _start = clk::now();
+    }
+    ~TApiTimer() {
+        if (_ord >= 0)
+            TApiProfiler::record(_ord, std::chrono::duration_cast<std::chrono::nanoseconds>(clk::now() - _start).count());
+    }
+};
+
+} // namespace gs
+
+#endif
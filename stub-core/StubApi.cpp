@@ -0,0 +1,933 @@
+//Flat gsCore api exported by the stub core
+//
+//Every api of GS5_Intf.h is exported with C linkage, just like the real gsCore which is resolved by name.
+
+#include "StubCore.h"
+#include "gsCoreStub.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace stub;
+
+using gs::action_id_t;
+using gs::activate_cb;
+using gs::entity_id_t;
+using gs::gs_handle_t;
+using gs::gs5_monitor_callback;
+using gs::license_id_t;
+using gs::lm_create_callback;
+using gs::lm_destroy_callback;
+using gs::lm_finishAccess_callback;
+using gs::lm_isValid_callback;
+using gs::lm_onAction_callback;
+using gs::lm_startAccess_callback;
+using gs::ping_cb;
+using gs::testsn_cb;
+using gs::TActionHandle;
+using gs::TCodeExchangeHandle;
+using gs::TEntityHandle;
+using gs::TEventHandle;
+using gs::TEventSourceHandle;
+using gs::TLicenseHandle;
+using gs::TMonitorHandle;
+using gs::TMPHandle;
+using gs::TRequestHandle;
+using gs::TVarHandle;
+using gs::var_type_t;
+using gs::vm_mask_t;
+
+#define GS_EXPORT extern "C" __attribute__((visibility("default")))
+
+namespace {
+
+const char *STUB_VERSION = "5.4.0-stub";
+
+Core &core() { return Core::instance(); }
+
+template <typename T>
+T *handle(gs_handle_t h) {
+    T *p = cast<T>(h);
+    if (p == nullptr)
+        setLastError(STUB_ERROR_INVALID_HANDLE, "Invalid handle");
+    return p;
+}
+
+bool readable(Variable *v) {
+    if (!v->readable()) {
+        setLastError(STUB_ERROR_NOT_SUPPORTED, "Variable is not readable");
+        return false;
+    }
+    return true;
+}
+
+bool writable(Variable *v) {
+    if (!v->writable()) {
+        setLastError(STUB_ERROR_NOT_SUPPORTED, "Variable is not writable");
+        return false;
+    }
+    return true;
+}
+
+//A parameter handle of an action keeps the action alive
+TVarHandle openParam(Variable *v) {
+    if (v && v->owner)
+        v->owner->retain();
+    return v;
+}
+
+void addParam(gs_handle_t hLic, const char *paramName, TVarType type, const char *initValue, int permission) {
+    License *lic = handle<License>(hLic);
+    if (lic && paramName)
+        lic->addParam(paramName, type, permission, initValue);
+}
+
+} // namespace
+
+//----------- Initialize ------------
+GS_EXPORT int gsInit(const char *productId, const char *, const char *, void *) {
+    return core().init(productId);
+}
+
+GS_EXPORT int gsInitEx(const char *productId, const unsigned char *, int, const char *, void *) {
+    return core().init(productId);
+}
+
+GS_EXPORT int gsCleanUp() {
+    core().cleanUp();
+    return 0;
+}
+
+GS_EXPORT const char *gsGetVersion() { return STUB_VERSION; }
+
+GS_EXPORT void gsCloseHandle(gs_handle_t handle) {
+    Object *p = (Object *)handle;
+    if (p == nullptr || p->magic != Object::MAGIC)
+        return;
+    if (p->kind == OBJ_VARIABLE) {
+        Object *owner = static_cast<Variable *>(p)->owner;
+        if (owner)
+            owner->release();
+        return;
+    }
+    p->release();
+}
+
+GS_EXPORT void gsFlush() {}
+
+GS_EXPORT const char *gsGetLastErrorMessage() { return lastErrorMessage(); }
+GS_EXPORT int gsGetLastErrorCode() { return lastErrorCode(); }
+GS_EXPORT void gsSetLastErrorInfo(int errCode, const char *errMsg) { setLastError(errCode, errMsg); }
+
+GS_EXPORT int gsGetBuildId() { return core().buildId(); }
+GS_EXPORT const char *gsGetProductName() { return core().productName().c_str(); }
+GS_EXPORT const char *gsGetProductId() { return core().productId().c_str(); }
+
+//----------- Entity ------------
+GS_EXPORT int gsGetEntityCount() { return core().entityCount(); }
+
+GS_EXPORT TEntityHandle gsOpenEntityByIndex(int index) {
+    Entity *e = core().entity(index);
+    if (e == nullptr)
+        setLastError(STUB_ERROR_GENERIC, "Invalid entity index");
+    return e;
+}
+
+GS_EXPORT TEntityHandle gsOpenEntityById(entity_id_t entityId) {
+    Entity *e = core().entity(entityId);
+    if (e == nullptr)
+        setLastError(STUB_ERROR_GENERIC, "Invalid entity id");
+    return e;
+}
+
+GS_EXPORT unsigned int gsGetEntityAttributes(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e ? e->attributes() : 0;
+}
+
+GS_EXPORT entity_id_t gsGetEntityId(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e ? e->id.c_str() : "";
+}
+
+GS_EXPORT const char *gsGetEntityName(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e ? e->name.c_str() : "";
+}
+
+GS_EXPORT const char *gsGetEntityDescription(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e ? e->description.c_str() : "";
+}
+
+GS_EXPORT bool gsBeginAccessEntity(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e && core().beginAccess(e);
+}
+
+GS_EXPORT bool gsEndAccessEntity(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e && core().endAccess(e);
+}
+
+//----------- License ------------
+GS_EXPORT int gsGetLicenseCount(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return (e && e->license.load()) ? 1 : 0;
+}
+
+GS_EXPORT TLicenseHandle gsOpenLicenseByIndex(TEntityHandle hEntity, int index) {
+    Entity *e = handle<Entity>(hEntity);
+    return (e && index == 0) ? e->license.load() : nullptr;
+}
+
+GS_EXPORT TLicenseHandle gsOpenLicenseById(TEntityHandle hEntity, license_id_t licenseId) {
+    Entity *e = handle<Entity>(hEntity);
+    License *lic = e ? e->license.load() : nullptr;
+    return (lic && licenseId && lic->id == licenseId) ? lic : nullptr;
+}
+
+GS_EXPORT bool gsHasLicense(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e && e->license.load() != nullptr;
+}
+
+GS_EXPORT TLicenseHandle gsOpenLicense(TEntityHandle hEntity) {
+    Entity *e = handle<Entity>(hEntity);
+    return e ? e->license.load() : nullptr;
+}
+
+GS_EXPORT license_id_t gsGetLicenseId(TLicenseHandle hLicense) {
+    License *lic = handle<License>(hLicense);
+    return lic ? lic->id.c_str() : "";
+}
+
+GS_EXPORT const char *gsGetLicenseName(TLicenseHandle hLicense) {
+    License *lic = handle<License>(hLicense);
+    return lic ? lic->name.c_str() : "";
+}
+
+GS_EXPORT const char *gsGetLicenseDescription(TLicenseHandle hLicense) {
+    License *lic = handle<License>(hLicense);
+    return lic ? lic->description.c_str() : "";
+}
+
+GS_EXPORT gs::TLicenseStatus gsGetLicenseStatus(TLicenseHandle hLicense) {
+    License *lic = handle<License>(hLicense);
+    return lic ? (gs::TLicenseStatus)lic->status.load() : gs::STATUS_INVALID;
+}
+
+GS_EXPORT bool gsIsLicenseValid(TLicenseHandle hLicense) {
+    License *lic = handle<License>(hLicense);
+    if (lic == nullptr)
+        return false;
+    switch (lic->status.load()) {
+    case gs::STATUS_UNLOCKED:
+        return true;
+    case gs::STATUS_ACTIVE:
+        return lic->isValid();
+    default:
+        return false;
+    }
+}
+
+GS_EXPORT TEntityHandle gsGetLicensedEntity(TLicenseHandle hLic) {
+    License *lic = handle<License>(hLic);
+    return lic ? lic->entity.load() : nullptr;
+}
+
+GS_EXPORT void gsLockLicense(TLicenseHandle hLic) {
+    License *lic = handle<License>(hLic);
+    if (lic)
+        lic->status = gs::STATUS_LOCKED;
+}
+
+GS_EXPORT int gsGetLicenseParamCount(TLicenseHandle hLicense) {
+    License *lic = handle<License>(hLicense);
+    return lic ? (int)lic->params.size() : 0;
+}
+
+GS_EXPORT TVarHandle gsGetLicenseParamByIndex(TLicenseHandle hLicense, int index) {
+    License *lic = handle<License>(hLicense);
+    if (lic == nullptr || index < 0 || index >= (int)lic->params.size())
+        return nullptr;
+    return lic->params[index].get();
+}
+
+GS_EXPORT TVarHandle gsGetLicenseParamByName(TLicenseHandle hLicense, const char *name) {
+    License *lic = handle<License>(hLicense);
+    return (lic && name) ? lic->param(name) : nullptr;
+}
+
+GS_EXPORT int gsGetActionInfoCount(TLicenseHandle hLicense) {
+    License *lic = handle<License>(hLicense);
+    return lic ? (int)lic->actions().size() : 0;
+}
+
+GS_EXPORT const char *gsGetActionInfoByIndex(TLicenseHandle hLicense, int index, action_id_t *actionId) {
+    License *lic = handle<License>(hLicense);
+    if (lic == nullptr || index < 0 || index >= (int)lic->actions().size())
+        return "";
+    action_id_t id = lic->actions()[index];
+    if (actionId)
+        *actionId = id;
+
+    std::unique_ptr<Request> req(new Request());
+    Action act(id, "", req.get());
+    return tls_str(act.whatToDo.substr(0, act.whatToDo.find(' ')));
+}
+
+//----------- Action ------------
+GS_EXPORT const char *gsGetActionName(TActionHandle hAct) {
+    Action *act = handle<Action>(hAct);
+    return act ? tls_str(act->whatToDo.substr(0, act->whatToDo.find(' '))) : "";
+}
+
+GS_EXPORT action_id_t gsGetActionId(TActionHandle hAct) {
+    Action *act = handle<Action>(hAct);
+    return act ? act->id : 0;
+}
+
+GS_EXPORT const char *gsGetActionDescription(TActionHandle hAct) {
+    Action *act = handle<Action>(hAct);
+    return act ? act->whatToDo.c_str() : "";
+}
+
+GS_EXPORT const char *gsGetActionString(TActionHandle hAct) {
+    Action *act = handle<Action>(hAct);
+    return act ? act->whatToDo.c_str() : "";
+}
+
+GS_EXPORT int gsGetActionParamCount(TActionHandle hAct) {
+    Action *act = handle<Action>(hAct);
+    return act ? (int)act->params.size() : 0;
+}
+
+GS_EXPORT TVarHandle gsGetActionParamByName(TActionHandle hAct, const char *paramName) {
+    Action *act = handle<Action>(hAct);
+    return (act && paramName) ? openParam(act->param(paramName)) : nullptr;
+}
+
+GS_EXPORT TVarHandle gsGetActionParamByIndex(TActionHandle hAct, int index) {
+    Action *act = handle<Action>(hAct);
+    if (act == nullptr || index < 0 || index >= (int)act->params.size())
+        return nullptr;
+    return openParam(act->params[index].get());
+}
+
+//----------- Variable ------------
+GS_EXPORT TVarHandle gsAddVariable(const char *varName, gs::TVarType varType, int attr, const char *initValStr) {
+    return varName ? core().addVariable(varName, varType, attr, initValStr) : nullptr;
+}
+
+GS_EXPORT bool gsRemoveVariable(const char *varName) {
+    return varName && core().removeVariable(varName);
+}
+
+GS_EXPORT TVarHandle gsGetVariable(const char *varName) {
+    return varName ? core().variable(varName) : nullptr;
+}
+
+GS_EXPORT int gsGetTotalVariables() { return core().variableCount(); }
+
+GS_EXPORT TVarHandle gsGetVariableByIndex(int index) { return core().variable(index); }
+
+GS_EXPORT const char *gsGetVariableName(TVarHandle hVar) {
+    Variable *v = handle<Variable>(hVar);
+    return v ? v->name.c_str() : "";
+}
+
+GS_EXPORT gs::TVarType gsGetVariableType(TVarHandle hVar) {
+    Variable *v = handle<Variable>(hVar);
+    return v ? v->value.type() : gs::VAR_TYPE_INT;
+}
+
+GS_EXPORT const char *gsVariableTypeToString(var_type_t paramType) {
+    return typeName((TVarType)paramType);
+}
+
+GS_EXPORT int gsGetVariableAttr(TVarHandle hVar) {
+    Variable *v = handle<Variable>(hVar);
+    return v ? v->attr : 0;
+}
+
+GS_EXPORT bool gsIsVariableValid(TVarHandle hVar) {
+    return cast<Variable>(hVar) != nullptr;
+}
+
+namespace {
+struct TAttrChar {
+    int attr;
+    char ch;
+};
+const TAttrChar s_attrChars[] = {
+    {VAR_ATTR_READ, 'r'},
+    {VAR_ATTR_WRITE, 'w'},
+    {VAR_ATTR_PERSISTENT, 'p'},
+    {VAR_ATTR_SECURE, 's'},
+    {VAR_ATTR_REMOTE, 'R'},
+    {VAR_ATTR_HIDDEN, 'h'},
+    {VAR_ATTR_SYSTEM, 'S'},
+};
+} // namespace
+
+GS_EXPORT const char *gsVariableAttrToString(int permit, char *buf, int bufSize) {
+    if (buf == nullptr || bufSize <= 0)
+        return "";
+    int n = 0;
+    for (const TAttrChar &a : s_attrChars) {
+        if ((permit & a.attr) && n + 1 < bufSize)
+            buf[n++] = a.ch;
+    }
+    buf[n] = 0;
+    return buf;
+}
+
+GS_EXPORT int gsVariableAttrFromString(const char *permitStr) {
+    int attr = 0;
+    for (const char *p = permitStr; p && *p; p++) {
+        for (const TAttrChar &a : s_attrChars) {
+            if (*p == a.ch)
+                attr |= a.attr;
+        }
+    }
+    return attr;
+}
+
+GS_EXPORT const char *gsGetVariableValueAsString(TVarHandle hVar) {
+    Variable *v = handle<Variable>(hVar);
+    return (v && readable(v)) ? tls_str(v->value.asString()) : "";
+}
+
+GS_EXPORT bool gsSetVariableValueFromString(TVarHandle hVar, const char *valstr) {
+    Variable *v = handle<Variable>(hVar);
+    return v && writable(v) && v->value.fromString(valstr);
+}
+
+GS_EXPORT bool gsGetVariableValueAsInt(TVarHandle hVar, int &val) {
+    Variable *v = handle<Variable>(hVar);
+    int64_t i;
+    if (v == nullptr || !readable(v) || !v->value.asInt64(i))
+        return false;
+    val = (int)i;
+    return true;
+}
+
+GS_EXPORT bool gsSetVariableValueFromInt(TVarHandle hVar, int val) {
+    Variable *v = handle<Variable>(hVar);
+    return v && writable(v) && v->value.fromInt64(val);
+}
+
+GS_EXPORT bool gsGetVariableValueAsInt64(TVarHandle hVar, int64_t &val) {
+    Variable *v = handle<Variable>(hVar);
+    return v && readable(v) && v->value.asInt64(val);
+}
+
+GS_EXPORT bool gsSetVariableValueFromInt64(TVarHandle hVar, int64_t val) {
+    Variable *v = handle<Variable>(hVar);
+    return v && writable(v) && v->value.fromInt64(val);
+}
+
+GS_EXPORT bool gsGetVariableValueAsFloat(TVarHandle hVar, float &val) {
+    Variable *v = handle<Variable>(hVar);
+    double d;
+    if (v == nullptr || !readable(v) || !v->value.asDouble(d))
+        return false;
+    val = (float)d;
+    return true;
+}
+
+GS_EXPORT bool gsSetVariableValueFromFloat(TVarHandle hVar, float val) {
+    Variable *v = handle<Variable>(hVar);
+    return v && writable(v) && v->value.fromDouble(val);
+}
+
+GS_EXPORT bool gsGetVariableValueAsDouble(TVarHandle hVar, double &val) {
+    Variable *v = handle<Variable>(hVar);
+    return v && readable(v) && v->value.asDouble(val);
+}
+
+GS_EXPORT bool gsSetVariableValueFromDouble(TVarHandle hVar, double val) {
+    Variable *v = handle<Variable>(hVar);
+    return v && writable(v) && v->value.fromDouble(val);
+}
+
+GS_EXPORT bool gsGetVariableValueAsTime(TVarHandle hVar, time_t &val) {
+    Variable *v = handle<Variable>(hVar);
+    int64_t i;
+    if (v == nullptr || !readable(v) || !v->value.asInt64(i))
+        return false;
+    val = (time_t)i;
+    return true;
+}
+
+GS_EXPORT bool gsSetVariableValueFromTime(TVarHandle hVar, time_t val) {
+    Variable *v = handle<Variable>(hVar);
+    return v && writable(v) && v->value.fromInt64(val);
+}
+
+//----------- Request ------------
+GS_EXPORT TRequestHandle gsCreateRequest() { return new Request(); }
+
+GS_EXPORT TActionHandle gsAddRequestAction(TRequestHandle hReq, action_id_t actId, TLicenseHandle hLic) {
+    Request *req = handle<Request>(hReq);
+    if (req == nullptr)
+        return nullptr;
+    Entity *e = nullptr;
+    if (hLic) {
+        License *lic = handle<License>(hLic);
+        if (lic == nullptr || (e = lic->entity.load()) == nullptr)
+            return nullptr;
+    }
+    return core().addAction(req, actId, e ? e->id.c_str() : nullptr);
+}
+
+GS_EXPORT TActionHandle gsAddRequestActionEx(TRequestHandle hReq, action_id_t actId, const char *entityId, const char *) {
+    Request *req = handle<Request>(hReq);
+    return req ? core().addAction(req, actId, entityId) : nullptr;
+}
+
+GS_EXPORT const char *gsGetRequestCode(TRequestHandle hReq) {
+    Request *req = handle<Request>(hReq);
+    return req ? core().requestCode(req) : "";
+}
+
+GS_EXPORT bool gsApplyLicenseCode(const char *licenseCode) {
+    return core().applyLicenseCode(licenseCode);
+}
+
+GS_EXPORT bool gsApplyLicenseCodeEx(const char *licenseCode, const char *, const char *) {
+    return core().applyLicenseCode(licenseCode);
+}
+
+//----------- Time Engine ------------
+GS_EXPORT void gsTurnOnInternalTimer() { core().turnOnTimer(); }
+GS_EXPORT void gsTurnOffInternalTimer() { core().turnOffTimer(); }
+GS_EXPORT bool gsIsInternalTimerActive() { return core().isTimerActive(); }
+GS_EXPORT void gsTickFromExternalTimer() { core().tick(); }
+GS_EXPORT void gsPauseTimeEngine() { core().pauseEngine(); }
+GS_EXPORT void gsResumeTimeEngine() { core().resumeEngine(); }
+GS_EXPORT bool gsIsTimeEngineActive() { return core().isEngineActive(); }
+
+//----------- Event ------------
+GS_EXPORT TMonitorHandle gsCreateMonitorEx(gs5_monitor_callback cbMonitor, void *usrData, const char *monitorName) {
+    return cbMonitor ? core().addMonitor(cbMonitor, usrData, monitorName) : nullptr;
+}
+
+GS_EXPORT int gsGetEventId(TEventHandle hEvent) {
+    Event *evt = handle<Event>(hEvent);
+    return evt ? evt->id : -1;
+}
+
+GS_EXPORT gs::TEventType gsGetEventType(TEventHandle hEvent) {
+    Event *evt = handle<Event>(hEvent);
+    return evt ? evt->type() : gs::EVENT_TYPE_APP;
+}
+
+GS_EXPORT TEventSourceHandle gsGetEventSource(TEventHandle hEvent) {
+    Event *evt = handle<Event>(hEvent);
+    return evt ? evt->source : nullptr;
+}
+
+GS_EXPORT void gsPostUserEvent(unsigned int evtId, bool bSync, void *usrData, unsigned int usrDataSize) {
+    core().postUserEvent(evtId, bSync, usrData, usrDataSize);
+}
+
+GS_EXPORT void *gsGetUserEventData(TEventHandle hEvent, unsigned int *usrDataSize) {
+    Event *evt = handle<Event>(hEvent);
+    if (usrDataSize)
+        *usrDataSize = evt ? evt->dataSize : 0;
+    return evt ? (void *)evt->data : nullptr;
+}
+
+//----------- HTML UI / Application ------------
+GS_EXPORT bool gsRenderHTML(const char *, const char *, int, int) { return false; }
+GS_EXPORT bool gsRenderHTMLEx(const char *, const char *, int, int, bool, bool, bool) { return false; }
+
+GS_EXPORT bool gsRunInWrappedMode() { return false; }
+GS_EXPORT bool gsRunInsideVM(vm_mask_t) { return false; }
+GS_EXPORT bool gsIsDebugVersion() { return false; }
+
+GS_EXPORT void gsTrace(const char *msg) {
+    if (msg)
+        fprintf(stderr, "gsCore-stub: %s\n", msg);
+}
+
+GS_EXPORT void gsExitApp(int rc) { exit(rc); }
+GS_EXPORT void gsTerminateApp(int rc) { _Exit(rc); }
+GS_EXPORT void gsPlayApp() {}
+GS_EXPORT void gsRestartApp() {}
+GS_EXPORT bool gsIsRestartedApp() { return false; }
+GS_EXPORT void gsPauseApp() {}
+GS_EXPORT void gsResumeAndExitApp() {}
+
+GS_EXPORT const char *gsGetAppRootPath() { return ""; }
+GS_EXPORT const char *gsGetAppCommandLine() { return ""; }
+GS_EXPORT const char *gsGetAppMainExe() { return ""; }
+
+GS_EXPORT void gsSetAppVar(const char *name, const char *val) { core().setAppVar(name, val); }
+GS_EXPORT const char *gsGetAppVar(const char *name) { return core().appVar(name); }
+
+GS_EXPORT bool gsIsFirstPass() { return true; }
+GS_EXPORT bool gsIsGamePass() { return true; }
+GS_EXPORT bool gsIsLastPass() { return true; }
+GS_EXPORT bool gsIsFirstGameExe() { return true; }
+GS_EXPORT bool gsIsLastGameExe() { return true; }
+GS_EXPORT bool gsIsMainThread() { return core().isMainThread(); }
+
+GS_EXPORT bool gsIsNodeLocked() { return false; }
+GS_EXPORT bool gsIsFingerPrintMatched() { return true; }
+GS_EXPORT const char *gsGetUniqueNodeId() { return "stub-node"; }
+GS_EXPORT bool gsIsAppFirstLaunched() { return false; }
+
+//----------- Custom License Model ------------
+GS_EXPORT TLicenseHandle gsCreateCustomLicense(const char *licId, const char *licName, const char *description, void *usrData,
+                                               lm_isValid_callback cbIsValid, lm_startAccess_callback cbStartAccess,
+                                               lm_finishAccess_callback cbFinishAccess, lm_onAction_callback cbOnAction,
+                                               lm_destroy_callback cbDestroy) {
+    CustomLM lm = {usrData, cbIsValid, cbStartAccess, cbFinishAccess, cbOnAction, cbDestroy};
+    return core().createCustomLicense(licId, licName, description, lm);
+}
+
+GS_EXPORT bool gsBindLicense(TEntityHandle hEntity, TLicenseHandle hLic) {
+    Entity *e = handle<Entity>(hEntity);
+    License *lic = handle<License>(hLic);
+    return e && lic && core().bindLicense(e, lic);
+}
+
+GS_EXPORT TLicenseHandle gsCreateLicense(const char *licId) {
+    return licId ? core().createLicense(licId) : nullptr;
+}
+
+GS_EXPORT void gsRegisterCustomLicense(const char *licId, lm_create_callback createLM, void *usrData) {
+    if (licId && createLM)
+        core().registerCustomLM(licId, createLM, usrData);
+}
+
+GS_EXPORT void gsAddLicenseParamStr(TLicenseHandle hLic, const char *paramName, const char *initValue, int permission) {
+    addParam(hLic, paramName, gs::VAR_TYPE_STRING, initValue ? initValue : "", permission);
+}
+
+GS_EXPORT void gsAddLicenseParamInt(TLicenseHandle hLic, const char *paramName, int initValue, int permission) {
+    addParam(hLic, paramName, gs::VAR_TYPE_INT, std::to_string(initValue).c_str(), permission);
+}
+
+GS_EXPORT void gsAddLicenseParamInt64(TLicenseHandle hLic, const char *paramName, int64_t initValue, int permission) {
+    addParam(hLic, paramName, gs::VAR_TYPE_INT64, std::to_string(initValue).c_str(), permission);
+}
+
+GS_EXPORT void gsAddLicenseParamBool(TLicenseHandle hLic, const char *paramName, bool initValue, int permission) {
+    addParam(hLic, paramName, gs::VAR_TYPE_BOOL, initValue ? "1" : "0", permission);
+}
+
+GS_EXPORT void gsAddLicenseParamFloat(TLicenseHandle hLic, const char *paramName, float initValue, int permission) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.9g", initValue);
+    addParam(hLic, paramName, gs::VAR_TYPE_FLOAT, buf, permission);
+}
+
+GS_EXPORT void gsAddLicenseParamTime(TLicenseHandle hLic, const char *paramName, time_t initValue, int permission) {
+    addParam(hLic, paramName, gs::VAR_TYPE_TIME, std::to_string((int64_t)initValue).c_str(), permission);
+}
+
+GS_EXPORT void gsAddLicenseParamDouble(TLicenseHandle hLic, const char *paramName, double initValue, int permission) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.17g", initValue);
+    addParam(hLic, paramName, gs::VAR_TYPE_DOUBLE, buf, permission);
+}
+
+//----------- Online activation (no server, answered from the data file) ------------
+GS_EXPORT bool gsIsServerAlive(int) { return false; }
+
+GS_EXPORT void gsIsServerAliveAsync(ping_cb pcb, void *userData, int) {
+    if (pcb)
+        pcb(false, userData);
+}
+
+GS_EXPORT bool gsApplySN(const char *sn, int *pRetCode, const char **ppSNRef, int) {
+    bool ok = core().applySN(sn);
+    if (pRetCode)
+        *pRetCode = ok ? 0 : lastErrorCode();
+    if (ppSNRef)
+        *ppSNRef = ok ? sn : "";
+    return ok;
+}
+
+GS_EXPORT void gsApplySNAsync(const char *sn, activate_cb activateCB, void *userData, int) {
+    bool ok = core().applySN(sn);
+    if (activateCB)
+        activateCB(sn, ok, ok ? 0 : lastErrorCode(), ok ? sn : "", userData);
+}
+
+GS_EXPORT bool gsIsSNValid(const char *sn, int) { return core().isSNValid(sn); }
+
+GS_EXPORT void gsIsSNValidAsync(const char *sn, testsn_cb cb, void *userData, int) {
+    if (cb)
+        cb(core().isSNValid(sn), userData);
+}
+
+GS_EXPORT bool gsRevokeApp(int, const char *sn) { return core().revokeSN(sn); }
+GS_EXPORT bool gsRevokeSN(int, const char *sn) { return sn && core().revokeSN(sn); }
+
+GS_EXPORT int gsGetTotalUnlockSNs() { return core().unlockSNCount(); }
+GS_EXPORT const char *gsGetUnlockSNByIndex(int index) { return core().unlockSN(index); }
+GS_EXPORT int gsGetTotalEntitiesUnlockedBySN(const char *sn) { return core().entitiesUnlockedBySN(sn); }
+GS_EXPORT const char *gsGetEntityIdUnlockedBySN(const char *sn, int index) { return core().entityUnlockedBySN(sn, index); }
+GS_EXPORT const char *gsGetSNByUnlockedEntityId(const char *entityId) { return core().snByUnlockedEntity(entityId); }
+GS_EXPORT const char *gsGetPreliminarySN() { return ""; }
+
+//----------- Move ------------
+GS_EXPORT TMPHandle gsMPCreate(int) { return new MovePackage(); }
+
+GS_EXPORT void gsMPAddEntity(TMPHandle hMP, const char *entityId) {
+    MovePackage *mp = handle<MovePackage>(hMP);
+    if (mp && entityId && core().entity(entityId))
+        mp->entityIds.push_back(entityId);
+}
+
+GS_EXPORT const char *gsMPExport(TMPHandle hMP) {
+    MovePackage *mp = handle<MovePackage>(hMP);
+    return mp ? core().exportPackage(mp) : "";
+}
+
+GS_EXPORT const char *gsMPUpload(TMPHandle, const char *, int) { return ""; }
+
+GS_EXPORT TMPHandle gsMPOpen(const char *mpStr) {
+    if (mpStr == nullptr)
+        return nullptr;
+    MovePackage *mp = new MovePackage();
+    mp->data = mpStr;
+    return mp;
+}
+
+GS_EXPORT bool gsMPImportOnline(TMPHandle hMP, const char *, int) {
+    MovePackage *mp = handle<MovePackage>(hMP);
+    return mp && core().importPackage(mp->data);
+}
+
+GS_EXPORT const char *gsMPGetImportOfflineRequestCode(TMPHandle hMP) {
+    MovePackage *mp = handle<MovePackage>(hMP);
+    return mp ? tls_str(mp->data) : "";
+}
+
+GS_EXPORT bool gsMPImportOffline(TMPHandle hMP, const char *) {
+    MovePackage *mp = handle<MovePackage>(hMP);
+    return mp && core().importPackage(mp->data);
+}
+
+GS_EXPORT const char *gsMPUploadApp(const char *, int) { return ""; }
+
+GS_EXPORT const char *gsMPExportApp() {
+    std::unique_ptr<MovePackage> mp(new MovePackage());
+    for (int i = 0; i < core().entityCount(); i++)
+        mp->entityIds.push_back(core().entity(i)->id);
+    return tls_str(core().exportPackage(mp.get()));
+}
+
+GS_EXPORT bool gsMPCanPreliminarySNResolved(TMPHandle) { return false; }
+GS_EXPORT bool gsMPIsTooBigToUpload(TMPHandle) { return false; }
+
+//----------- Code Exchange ------------
+GS_EXPORT TCodeExchangeHandle gsCodeExchangeBegin() { return new CodeExchange(); }
+
+GS_EXPORT const char *gsCodeExchangeGetLicenseCode(gs_handle_t hCodeExchange, const char *, int, const char *sn, const char *requestCode) {
+    CodeExchange *ce = handle<CodeExchange>(hCodeExchange);
+    if (ce == nullptr)
+        return "";
+    if (!core().isSNValid(sn)) {
+        ce->errorCode = STUB_ERROR_INVALID_CODE;
+        ce->errorMessage = "Invalid serial number";
+        return "";
+    }
+    //stub request codes are accepted as license codes
+    ce->licenseCode = requestCode ? requestCode : "";
+    return ce->licenseCode.c_str();
+}
+
+GS_EXPORT int gsCodeExchangeGetErrorCode(gs_handle_t hCodeExchange) {
+    CodeExchange *ce = handle<CodeExchange>(hCodeExchange);
+    return ce ? ce->errorCode : STUB_ERROR_INVALID_HANDLE;
+}
+
+GS_EXPORT const char *gsCodeExchangeGetErrorMessage(gs_handle_t hCodeExchange) {
+    CodeExchange *ce = handle<CodeExchange>(hCodeExchange);
+    return ce ? ce->errorMessage.c_str() : "";
+}
+
+//----------- Test hooks ------------
+namespace {
+#define API_ENTRY(apiName) \
+    { #apiName, (void *)&apiName }
+
+const gs::sdk_api_entry s_apiTable[] = {
+    API_ENTRY(gsInit),
+    API_ENTRY(gsInitEx),
+    API_ENTRY(gsCleanUp),
+    API_ENTRY(gsGetVersion),
+    API_ENTRY(gsCloseHandle),
+    API_ENTRY(gsFlush),
+    API_ENTRY(gsGetLastErrorMessage),
+    API_ENTRY(gsGetLastErrorCode),
+    API_ENTRY(gsSetLastErrorInfo),
+    API_ENTRY(gsGetBuildId),
+    API_ENTRY(gsGetProductName),
+    API_ENTRY(gsGetProductId),
+    API_ENTRY(gsGetEntityCount),
+    API_ENTRY(gsOpenEntityByIndex),
+    API_ENTRY(gsOpenEntityById),
+    API_ENTRY(gsGetEntityAttributes),
+    API_ENTRY(gsGetEntityId),
+    API_ENTRY(gsGetEntityName),
+    API_ENTRY(gsGetEntityDescription),
+    API_ENTRY(gsBeginAccessEntity),
+    API_ENTRY(gsEndAccessEntity),
+    API_ENTRY(gsGetLicenseCount),
+    API_ENTRY(gsOpenLicenseByIndex),
+    API_ENTRY(gsOpenLicenseById),
+    API_ENTRY(gsHasLicense),
+    API_ENTRY(gsOpenLicense),
+    API_ENTRY(gsGetLicenseId),
+    API_ENTRY(gsGetLicenseName),
+    API_ENTRY(gsGetLicenseDescription),
+    API_ENTRY(gsGetLicenseStatus),
+    API_ENTRY(gsIsLicenseValid),
+    API_ENTRY(gsGetLicensedEntity),
+    API_ENTRY(gsLockLicense),
+    API_ENTRY(gsGetLicenseParamCount),
+    API_ENTRY(gsGetLicenseParamByIndex),
+    API_ENTRY(gsGetLicenseParamByName),
+    API_ENTRY(gsGetActionInfoCount),
+    API_ENTRY(gsGetActionInfoByIndex),
+    API_ENTRY(gsGetActionName),
+    API_ENTRY(gsGetActionId),
+    API_ENTRY(gsGetActionDescription),
+    API_ENTRY(gsGetActionString),
+    API_ENTRY(gsGetActionParamCount),
+    API_ENTRY(gsGetActionParamByName),
+    API_ENTRY(gsGetActionParamByIndex),
+    API_ENTRY(gsAddVariable),
+    API_ENTRY(gsRemoveVariable),
+    API_ENTRY(gsGetVariable),
+    API_ENTRY(gsGetTotalVariables),
+    API_ENTRY(gsGetVariableByIndex),
+    API_ENTRY(gsGetVariableName),
+    API_ENTRY(gsGetVariableType),
+    API_ENTRY(gsVariableTypeToString),
+    API_ENTRY(gsGetVariableAttr),
+    API_ENTRY(gsIsVariableValid),
+    API_ENTRY(gsVariableAttrToString),
+    API_ENTRY(gsVariableAttrFromString),
+    API_ENTRY(gsGetVariableValueAsString),
+    API_ENTRY(gsSetVariableValueFromString),
+    API_ENTRY(gsGetVariableValueAsInt),
+    API_ENTRY(gsSetVariableValueFromInt),
+    API_ENTRY(gsGetVariableValueAsInt64),
+    API_ENTRY(gsSetVariableValueFromInt64),
+    API_ENTRY(gsGetVariableValueAsFloat),
+    API_ENTRY(gsSetVariableValueFromFloat),
+    API_ENTRY(gsGetVariableValueAsDouble),
+    API_ENTRY(gsSetVariableValueFromDouble),
+    API_ENTRY(gsGetVariableValueAsTime),
+    API_ENTRY(gsSetVariableValueFromTime),
+    API_ENTRY(gsCreateRequest),
+    API_ENTRY(gsAddRequestAction),
+    API_ENTRY(gsAddRequestActionEx),
+    API_ENTRY(gsGetRequestCode),
+    API_ENTRY(gsApplyLicenseCode),
+    API_ENTRY(gsApplyLicenseCodeEx),
+    API_ENTRY(gsTurnOnInternalTimer),
+    API_ENTRY(gsTurnOffInternalTimer),
+    API_ENTRY(gsIsInternalTimerActive),
+    API_ENTRY(gsTickFromExternalTimer),
+    API_ENTRY(gsPauseTimeEngine),
+    API_ENTRY(gsResumeTimeEngine),
+    API_ENTRY(gsIsTimeEngineActive),
+    API_ENTRY(gsCreateMonitorEx),
+    API_ENTRY(gsGetEventId),
+    API_ENTRY(gsGetEventType),
+    API_ENTRY(gsGetEventSource),
+    API_ENTRY(gsPostUserEvent),
+    API_ENTRY(gsGetUserEventData),
+    API_ENTRY(gsRenderHTML),
+    API_ENTRY(gsRenderHTMLEx),
+    API_ENTRY(gsRunInWrappedMode),
+    API_ENTRY(gsRunInsideVM),
+    API_ENTRY(gsIsDebugVersion),
+    API_ENTRY(gsTrace),
+    API_ENTRY(gsExitApp),
+    API_ENTRY(gsTerminateApp),
+    API_ENTRY(gsPlayApp),
+    API_ENTRY(gsRestartApp),
+    API_ENTRY(gsIsRestartedApp),
+    API_ENTRY(gsPauseApp),
+    API_ENTRY(gsResumeAndExitApp),
+    API_ENTRY(gsGetAppRootPath),
+    API_ENTRY(gsGetAppCommandLine),
+    API_ENTRY(gsGetAppMainExe),
+    API_ENTRY(gsSetAppVar),
+    API_ENTRY(gsGetAppVar),
+    API_ENTRY(gsIsFirstPass),
+    API_ENTRY(gsIsGamePass),
+    API_ENTRY(gsIsLastPass),
+    API_ENTRY(gsIsFirstGameExe),
+    API_ENTRY(gsIsLastGameExe),
+    API_ENTRY(gsIsMainThread),
+    API_ENTRY(gsIsNodeLocked),
+    API_ENTRY(gsIsFingerPrintMatched),
+    API_ENTRY(gsGetUniqueNodeId),
+    API_ENTRY(gsIsAppFirstLaunched),
+    API_ENTRY(gsCreateCustomLicense),
+    API_ENTRY(gsBindLicense),
+    API_ENTRY(gsCreateLicense),
+    API_ENTRY(gsRegisterCustomLicense),
+    API_ENTRY(gsAddLicenseParamStr),
+    API_ENTRY(gsAddLicenseParamInt),
+    API_ENTRY(gsAddLicenseParamInt64),
+    API_ENTRY(gsAddLicenseParamBool),
+    API_ENTRY(gsAddLicenseParamFloat),
+    API_ENTRY(gsAddLicenseParamTime),
+    API_ENTRY(gsAddLicenseParamDouble),
+    API_ENTRY(gsIsServerAlive),
+    API_ENTRY(gsIsServerAliveAsync),
+    API_ENTRY(gsApplySN),
+    API_ENTRY(gsApplySNAsync),
+    API_ENTRY(gsIsSNValid),
+    API_ENTRY(gsIsSNValidAsync),
+    API_ENTRY(gsRevokeApp),
+    API_ENTRY(gsRevokeSN),
+    API_ENTRY(gsGetTotalUnlockSNs),
+    API_ENTRY(gsGetUnlockSNByIndex),
+    API_ENTRY(gsGetTotalEntitiesUnlockedBySN),
+    API_ENTRY(gsGetEntityIdUnlockedBySN),
+    API_ENTRY(gsGetSNByUnlockedEntityId),
+    API_ENTRY(gsGetPreliminarySN),
+    API_ENTRY(gsMPCreate),
+    API_ENTRY(gsMPAddEntity),
+    API_ENTRY(gsMPExport),
+    API_ENTRY(gsMPUpload),
+    API_ENTRY(gsMPOpen),
+    API_ENTRY(gsMPImportOnline),
+    API_ENTRY(gsMPGetImportOfflineRequestCode),
+    API_ENTRY(gsMPImportOffline),
+    API_ENTRY(gsMPUploadApp),
+    API_ENTRY(gsMPExportApp),
+    API_ENTRY(gsMPCanPreliminarySNResolved),
+    API_ENTRY(gsMPIsTooBigToUpload),
+    API_ENTRY(gsCodeExchangeBegin),
+    API_ENTRY(gsCodeExchangeGetLicenseCode),
+    API_ENTRY(gsCodeExchangeGetErrorCode),
+    API_ENTRY(gsCodeExchangeGetErrorMessage),
+};
+} // namespace
+
+GS_EXPORT const gs::sdk_api_entry *gsStubGetApiTable(int *count) {
+    if (count)
+        *count = sizeof(s_apiTable) / sizeof(s_apiTable[0]);
+    return s_apiTable;
+}
+
+GS_EXPORT void gsStubFireEvent(int evtId, const char *entityId) {
+    core().fire(evtId, entityId ? core().entity(entityId) : nullptr);
+}
+
+GS_EXPORT void gsStubSetClock(time_t t) { core().setClock(t); }
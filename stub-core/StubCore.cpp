@@ -0,0 +1,1300 @@
+#include "StubCore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <dlfcn.h>
+
+namespace stub {
+
+//************** Errors ****************
+namespace {
+thread_local int t_errCode = 0;
+thread_local std::string t_errMsg;
+thread_local std::string t_str;
+
+const char *LM_HARDDATE = "gs.lm.expire.hardDate.1";
+const char *LM_PERIOD = "gs.lm.expire.period.1";
+const char *LM_DURATION = "gs.lm.expire.duration.1";
+const char *LM_ACCESSTIME = "gs.lm.expire.accessTime.1";
+const char *LM_ALWAYSLOCK = "gs.lm.alwaysLock.1";
+
+const int PARAM_RW = LM_PARAM_READ | LM_PARAM_WRITE;
+
+struct TActionInfo {
+    gs::action_id_t id;
+    const char *name;
+    const char *paramName; //LM-specific action parameter
+    TVarType paramType;
+};
+
+const TActionInfo s_actions[] = {
+    {ACT_UNLOCK, "unlock", nullptr, gs::VAR_TYPE_INT},
+    {ACT_LOCK, "lock", nullptr, gs::VAR_TYPE_INT},
+    {ACT_SET_PARAM, "setParam", nullptr, gs::VAR_TYPE_INT},
+    {ACT_ENABLE_PARAM, "enableParam", nullptr, gs::VAR_TYPE_INT},
+    {ACT_DISABLE_PARAM, "disableParam", nullptr, gs::VAR_TYPE_INT},
+    {ACT_ENABLE_COPYPROTECTION, "enableCopyProtection", nullptr, gs::VAR_TYPE_INT},
+    {ACT_DISABLE_COPYPROTECTION, "disableCopyProtection", nullptr, gs::VAR_TYPE_INT},
+    {ACT_ENABLE_ALLEXPIRATION, "enableAllExpiration", nullptr, gs::VAR_TYPE_INT},
+    {ACT_DISABLE_ALLEXPIRATION, "disableAllExpiration", nullptr, gs::VAR_TYPE_INT},
+    {ACT_RESET_ALLEXPIRATION, "resetAllExpiration", nullptr, gs::VAR_TYPE_INT},
+    {ACT_CLEAN, "clean", nullptr, gs::VAR_TYPE_INT},
+    {ACT_DUMMY, "dummy", nullptr, gs::VAR_TYPE_INT},
+    {ACT_PUSH, "push", nullptr, gs::VAR_TYPE_INT},
+    {ACT_PULL, "pull", nullptr, gs::VAR_TYPE_INT},
+    {ACT_NAG_ON, "nagOn", nullptr, gs::VAR_TYPE_INT},
+    {ACT_NAG_OFF, "nagOff", nullptr, gs::VAR_TYPE_INT},
+    {ACT_ONE_SHOT, "oneShot", nullptr, gs::VAR_TYPE_INT},
+    {ACT_SHELFTIME, "shelfTime", nullptr, gs::VAR_TYPE_INT},
+    {ACT_FIX, "fix", nullptr, gs::VAR_TYPE_INT},
+    {ACT_REVOKE, "revoke", nullptr, gs::VAR_TYPE_INT},
+
+    {ACT_ADD_ACCESSTIME, "addAccessTime", "addedAccessTime", gs::VAR_TYPE_INT},
+    {ACT_SET_ACCESSTIME, "setAccessTime", "newAccessTime", gs::VAR_TYPE_INT},
+    {ACT_SET_STARTDATE, "setStartDate", "startDate", gs::VAR_TYPE_TIME},
+    {ACT_SET_ENDDATE, "setEndDate", "endDate", gs::VAR_TYPE_TIME},
+    {ACT_SET_SESSIONTIME, "setSessionTime", "newSessionTime", gs::VAR_TYPE_INT},
+    {ACT_SET_EXPIRE_PERIOD, "setExpirePeriod", "newPeriodInSeconds", gs::VAR_TYPE_INT},
+    {ACT_ADD_EXPIRE_PERIOD, "addExpirePeriod", "addedPeriodInSeconds", gs::VAR_TYPE_INT},
+    {ACT_SET_EXPIRE_DURATION, "setExpireDuration", "newDurationInSeconds", gs::VAR_TYPE_INT},
+    {ACT_ADD_EXPIRE_DURATION, "addExpireDuration", "addedDurationInSeconds", gs::VAR_TYPE_INT},
+};
+
+const TActionInfo *actionInfo(gs::action_id_t id) {
+    for (const TActionInfo &a : s_actions) {
+        if (a.id == id)
+            return &a;
+    }
+    return nullptr;
+}
+
+const TActionInfo *actionInfo(const std::string &name) {
+    for (const TActionInfo &a : s_actions) {
+        if (name == a.name)
+            return &a;
+    }
+    return nullptr;
+}
+
+bool isGenericAction(gs::action_id_t id) {
+    return id <= ACT_REVOKE;
+}
+
+struct TTypeName {
+    TVarType type;
+    const char *name;
+};
+const TTypeName s_types[] = {
+    {gs::VAR_TYPE_INT, "int"},
+    {gs::VAR_TYPE_INT64, "int64"},
+    {gs::VAR_TYPE_FLOAT, "float"},
+    {gs::VAR_TYPE_DOUBLE, "double"},
+    {gs::VAR_TYPE_BOOL, "bool"},
+    {gs::VAR_TYPE_STRING, "string"},
+    {gs::VAR_TYPE_TIME, "time"},
+};
+
+bool typeFromName(const std::string &name, TVarType &type) {
+    for (const TTypeName &t : s_types) {
+        if (name == t.name) {
+            type = t.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string trim(const std::string &s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos)
+        return "";
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+std::vector<std::string> split(const std::string &s, char sep) {
+    std::vector<std::string> r;
+    std::string item;
+    std::istringstream in(s);
+    while (std::getline(in, item, sep))
+        r.push_back(item);
+    return r;
+}
+
+//escapes separators of request code
+std::string escape(const std::string &s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '%' || c == ',' || c == ';' || c == '=' || c == '@') {
+            char buf[4];
+            snprintf(buf, sizeof(buf), "%%%02X", (unsigned char)c);
+            r += buf;
+        } else {
+            r += c;
+        }
+    }
+    return r;
+}
+
+std::string unescape(const std::string &s) {
+    std::string r;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '%' && i + 2 < s.size()) {
+            r += (char)strtol(s.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            r += s[i];
+        }
+    }
+    return r;
+}
+
+const char *REQUEST_CODE_PREFIX = "RQ1;";
+const char *MOVE_PACKAGE_PREFIX = "MP1;";
+
+} // namespace
+
+void setLastError(int code, const char *msg) {
+    t_errCode = code;
+    t_errMsg = msg ? msg : "";
+}
+int lastErrorCode() { return t_errCode; }
+const char *lastErrorMessage() { return t_errMsg.c_str(); }
+
+const char *tls_str(const std::string &s) {
+    t_str = s;
+    return t_str.c_str();
+}
+
+const char *typeName(TVarType type) {
+    for (const TTypeName &t : s_types) {
+        if (type == t.type)
+            return t.name;
+    }
+    return "";
+}
+
+//************** Value ****************
+bool Value::isInteger() const {
+    return _type == gs::VAR_TYPE_INT || _type == gs::VAR_TYPE_INT64 || _type == gs::VAR_TYPE_BOOL || _type == gs::VAR_TYPE_TIME;
+}
+
+std::string Value::asString() const {
+    if (isInteger())
+        return std::to_string(_i.load(std::memory_order_relaxed));
+    if (isFloat()) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%g", _d.load(std::memory_order_relaxed));
+        return buf;
+    }
+    std::lock_guard<std::mutex> lock(_lock);
+    return _s;
+}
+
+bool Value::asInt64(int64_t &v) const {
+    if (isInteger()) {
+        v = _i.load(std::memory_order_relaxed);
+        return true;
+    }
+    if (isFloat()) {
+        v = (int64_t)_d.load(std::memory_order_relaxed);
+        return true;
+    }
+    std::string s = asString();
+    char *end = nullptr;
+    v = strtoll(s.c_str(), &end, 0);
+    return !s.empty() && *end == 0;
+}
+
+bool Value::asDouble(double &v) const {
+    if (isFloat()) {
+        v = _d.load(std::memory_order_relaxed);
+        return true;
+    }
+    if (isInteger()) {
+        v = (double)_i.load(std::memory_order_relaxed);
+        return true;
+    }
+    std::string s = asString();
+    char *end = nullptr;
+    v = strtod(s.c_str(), &end);
+    return !s.empty() && *end == 0;
+}
+
+bool Value::fromString(const char *s) {
+    if (s == nullptr)
+        return false;
+    if (isInteger()) {
+        char *end = nullptr;
+        int64_t v = strtoll(s, &end, 0);
+        if (*s == 0 || *end != 0)
+            return false;
+        return fromInt64(v);
+    }
+    if (isFloat()) {
+        char *end = nullptr;
+        double v = strtod(s, &end);
+        if (*s == 0 || *end != 0)
+            return false;
+        return fromDouble(v);
+    }
+    std::lock_guard<std::mutex> lock(_lock);
+    _s = s;
+    return true;
+}
+
+bool Value::fromInt64(int64_t v) {
+    if (_type == gs::VAR_TYPE_BOOL)
+        v = (v != 0);
+    if (isInteger()) {
+        _i.store(v, std::memory_order_relaxed);
+        return true;
+    }
+    if (isFloat())
+        return fromDouble((double)v);
+    return fromString(std::to_string(v).c_str());
+}
+
+bool Value::fromDouble(double v) {
+    if (isFloat()) {
+        _d.store(v, std::memory_order_relaxed);
+        return true;
+    }
+    if (isInteger())
+        return fromInt64((int64_t)v);
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%g", v);
+    return fromString(buf);
+}
+
+void Value::assign(const Value &src) {
+    fromString(src.asString().c_str());
+}
+
+//************** Variable ****************
+Variable::Variable(const std::string &varName, TVarType type, int attribute, bool param, Object *ownerObj)
+    : Object(OBJ_VARIABLE, ownerObj != nullptr), name(varName), attr(attribute), isParam(param), value(type), owner(ownerObj) {
+}
+
+Variable::~Variable() {}
+
+//************** License ****************
+License::License(const std::string &licId)
+    : Object(OBJ_LICENSE, false), id(licId), name(licId), status(gs::STATUS_ACTIVE), initStatus(gs::STATUS_ACTIVE), entity(nullptr) {
+    //built-in parameters
+    if (id == LM_HARDDATE) {
+        name = "Expire By Hard Date";
+        addParam("timeBeginEnabled", gs::VAR_TYPE_BOOL, PARAM_RW, "0");
+        addParam("timeBegin", gs::VAR_TYPE_TIME, PARAM_RW, "0");
+        addParam("timeEndEnabled", gs::VAR_TYPE_BOOL, PARAM_RW, "0");
+        addParam("timeEnd", gs::VAR_TYPE_TIME, PARAM_RW, "0");
+        addParam("rollbackTolerance", gs::VAR_TYPE_INT, PARAM_RW, "0");
+    } else if (id == LM_PERIOD) {
+        name = "Expire By Period";
+        addParam("periodInSeconds", gs::VAR_TYPE_INT, PARAM_RW, "0");
+        addParam("timeFirstAccess", gs::VAR_TYPE_TIME, PARAM_RW, "0");
+        addParam("rollbackTolerance", gs::VAR_TYPE_INT, PARAM_RW, "0");
+    } else if (id == LM_DURATION) {
+        name = "Expire By Duration";
+        addParam("maxDurationInSeconds", gs::VAR_TYPE_INT, PARAM_RW, "0");
+        addParam("usedDurationInSeconds", gs::VAR_TYPE_INT, PARAM_RW, "0");
+    } else if (id == LM_ACCESSTIME) {
+        name = "Expire By Access Times";
+        addParam("maxAccessTimes", gs::VAR_TYPE_INT, PARAM_RW, "0");
+        addParam("usedTimes", gs::VAR_TYPE_INT, PARAM_RW, "0");
+    }
+    if (id == LM_HARDDATE || id == LM_PERIOD || id == LM_DURATION || id == LM_ACCESSTIME)
+        addParam("exitAppOnExpire", gs::VAR_TYPE_BOOL, PARAM_RW, "1");
+}
+
+Variable *License::addParam(const std::string &paramName, TVarType type, int attr, const char *initValue) {
+    Variable *p = param(paramName.c_str());
+    if (p == nullptr) {
+        p = new Variable(paramName, type, attr, true);
+        params.emplace_back(p);
+        paramIndex[paramName] = p;
+    }
+    if (initValue)
+        p->value.fromString(initValue);
+    return p;
+}
+
+void License::commitInitValues() {
+    initValues.clear();
+    for (auto &p : params)
+        initValues.push_back(p->value.asString());
+    initStatus = (TLicenseStatus)status.load();
+}
+
+void License::reset() {
+    for (size_t i = 0; i < params.size() && i < initValues.size(); i++)
+        params[i]->value.fromString(initValues[i].c_str());
+    status = initStatus;
+}
+
+Variable *License::param(const char *paramName) const {
+    auto it = paramIndex.find(paramName);
+    return it == paramIndex.end() ? nullptr : it->second;
+}
+
+int64_t License::paramInt(const char *paramName, int64_t def) const {
+    Variable *p = param(paramName);
+    int64_t v;
+    if (p && p->value.asInt64(v))
+        return v;
+    return def;
+}
+
+void License::setParamInt(const char *paramName, int64_t v) {
+    Variable *p = param(paramName);
+    if (p)
+        p->value.fromInt64(v);
+}
+
+bool License::isValid() const {
+    if (custom)
+        return custom->isValid ? custom->isValid(custom->usrData) : false;
+
+    int64_t now = Core::instance().now();
+    if (id == LM_HARDDATE) {
+        if (paramInt("timeBeginEnabled") && now < paramInt("timeBegin"))
+            return false;
+        if (paramInt("timeEndEnabled") && now >= paramInt("timeEnd"))
+            return false;
+        return true;
+    }
+    if (id == LM_PERIOD) {
+        int64_t t0 = paramInt("timeFirstAccess");
+        return t0 == 0 || now < t0 + paramInt("periodInSeconds");
+    }
+    if (id == LM_DURATION)
+        return paramInt("usedDurationInSeconds") < paramInt("maxDurationInSeconds");
+    if (id == LM_ACCESSTIME) {
+        Entity *e = entity.load();
+        int64_t used = paramInt("usedTimes");
+        int64_t max = paramInt("maxAccessTimes");
+        return (e && e->accessCount > 0) ? used <= max : used < max;
+    }
+    if (id == LM_ALWAYSLOCK)
+        return false;
+    return true;
+}
+
+void License::onAccessStarted() {
+    if (custom) {
+        if (custom->startAccess)
+            custom->startAccess(custom->usrData);
+        return;
+    }
+    if (id == LM_PERIOD && paramInt("timeFirstAccess") == 0)
+        setParamInt("timeFirstAccess", Core::instance().now());
+    else if (id == LM_ACCESSTIME)
+        setParamInt("usedTimes", paramInt("usedTimes") + 1);
+}
+
+void License::onAccessEnded() {
+    if (custom && custom->finishAccess)
+        custom->finishAccess(custom->usrData);
+}
+
+void License::onTick(int64_t elapsedSeconds) {
+    if (!custom && id == LM_DURATION && elapsedSeconds > 0)
+        setParamInt("usedDurationInSeconds", paramInt("usedDurationInSeconds") + elapsedSeconds);
+}
+
+const std::vector<gs::action_id_t> &License::actions() const {
+    static const std::vector<gs::action_id_t> generic = {ACT_UNLOCK, ACT_LOCK};
+    static const std::vector<gs::action_id_t> hardDate = {ACT_UNLOCK, ACT_LOCK, ACT_SET_STARTDATE, ACT_SET_ENDDATE};
+    static const std::vector<gs::action_id_t> period = {ACT_UNLOCK, ACT_LOCK, ACT_SET_EXPIRE_PERIOD, ACT_ADD_EXPIRE_PERIOD};
+    static const std::vector<gs::action_id_t> duration = {ACT_UNLOCK, ACT_LOCK, ACT_SET_EXPIRE_DURATION, ACT_ADD_EXPIRE_DURATION};
+    static const std::vector<gs::action_id_t> accessTime = {ACT_UNLOCK, ACT_LOCK, ACT_ADD_ACCESSTIME, ACT_SET_ACCESSTIME};
+
+    if (id == LM_HARDDATE)
+        return hardDate;
+    if (id == LM_PERIOD)
+        return period;
+    if (id == LM_DURATION)
+        return duration;
+    if (id == LM_ACCESSTIME)
+        return accessTime;
+    return generic;
+}
+
+//************** Entity ****************
+bool Entity::isAccessible() const {
+    License *lic = license.load();
+    if (lic == nullptr)
+        return true;
+    switch (lic->status.load()) {
+    case gs::STATUS_UNLOCKED:
+        return true;
+    case gs::STATUS_ACTIVE:
+        return lic->isValid();
+    default:
+        return false;
+    }
+}
+
+unsigned int Entity::attributes() const {
+    unsigned int attr = 0;
+    License *lic = license.load();
+    bool accessible = isAccessible();
+    if (accessible)
+        attr |= ENTITY_ATTRIBUTE_ACCESSIBLE;
+    if (lic) {
+        int status = lic->status.load();
+        if (status == gs::STATUS_UNLOCKED)
+            attr |= ENTITY_ATTRIBUTE_UNLOCKED;
+        else if (status == gs::STATUS_LOCKED || !accessible)
+            attr |= ENTITY_ATTRIBUTE_LOCKED;
+    }
+    if (accessCount > 0)
+        attr |= ENTITY_ATTRIBUTE_ACCESSING;
+    if (autoStart)
+        attr |= ENTITY_ATTRIBUTE_AUTOSTART;
+    return attr;
+}
+
+//************** Request / Action ****************
+Action::Action(gs::action_id_t actId, const std::string &targetEntityId, Object *req)
+    : Object(OBJ_ACTION, true), id(actId), entityId(targetEntityId), request(req) {
+    const TActionInfo *info = actionInfo(actId);
+    if (info && info->paramName)
+        params.emplace_back(new Variable(info->paramName, info->paramType, PARAM_RW, true, this));
+
+    whatToDo = std::string(info ? info->name : "unknown") + " " + (entityId.empty() ? "all entities" : entityId);
+}
+
+Action::~Action() {}
+
+Variable *Action::param(const char *paramName) const {
+    for (auto &p : params) {
+        if (p->name == paramName)
+            return p.get();
+    }
+    return nullptr;
+}
+
+Request::~Request() {
+    for (Action *act : actions)
+        act->release();
+}
+
+TEventType Event::type() const {
+    if ((unsigned int)id >= GS_USER_EVENT)
+        return gs::EVENT_TYPE_USER;
+    if (id >= EVENT_IDBASE_ENTITY)
+        return gs::EVENT_TYPE_ENTITY;
+    if (id >= EVENT_IDBASE_LICENSE)
+        return gs::EVENT_TYPE_LICENSE;
+    return gs::EVENT_TYPE_APP;
+}
+
+//************** Core ****************
+Core &Core::instance() {
+    static Core core;
+    return core;
+}
+
+Core::Core() : _buildId(0), _timerOnInit(false), _timerInterval(1000), _fixedClock(0), _inited(false), _totalMonitors(0),
+               _timerActive(false), _enginePaused(false), _timerStop(false), _eventStop(false) {
+    const char *dataFile = getenv("GS_STUB_CORE_DATA");
+    std::string defaultFile;
+    if (dataFile == nullptr) {
+        //gsCore-stub.ini side by side with this module
+        Dl_info di;
+        if (dladdr((void *)&Core::instance, &di) && di.dli_fname) {
+            defaultFile = di.dli_fname;
+            size_t i = defaultFile.find_last_of('/');
+            defaultFile = (i == std::string::npos ? std::string() : defaultFile.substr(0, i + 1)) + "gsCore-stub.ini";
+            dataFile = defaultFile.c_str();
+        }
+    }
+    if (dataFile)
+        load(dataFile);
+}
+
+Core::~Core() {
+    cleanUp();
+}
+
+time_t Core::now() const {
+    int64_t t = _fixedClock.load(std::memory_order_relaxed);
+    return t ? (time_t)t : time(nullptr);
+}
+
+bool Core::parseAction(const std::string &spec, ActionSpec &act) {
+    //<action> [entityId] [name=value ...]
+    std::vector<std::string> items;
+    for (const std::string &s : split(spec, ' ')) {
+        if (!s.empty())
+            items.push_back(s);
+    }
+    if (items.empty())
+        return false;
+
+    const TActionInfo *info = actionInfo(items[0]);
+    if (info)
+        act.id = info->id;
+    else
+        act.id = (gs::action_id_t)atoi(items[0].c_str());
+
+    for (size_t i = 1; i < items.size(); i++) {
+        size_t k = items[i].find('=');
+        if (k == std::string::npos)
+            act.entityId = items[i];
+        else
+            act.params.push_back(std::make_pair(items[i].substr(0, k), items[i].substr(k + 1)));
+    }
+    return act.id != 0;
+}
+
+void Core::load(const char *dataFile) {
+    std::ifstream in(dataFile);
+    if (!in)
+        return;
+    _dataFile = dataFile;
+
+    std::string section, line;
+    Entity *e = nullptr;
+    std::vector<ActionSpec> *acts = nullptr;
+    std::string codeValue;
+    int lineNo = 0;
+
+    auto warn = [&](const char *msg) {
+        fprintf(stderr, "gsCore-stub: %s:%d: %s\n", dataFile, lineNo, msg);
+    };
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';')
+            continue;
+
+        if (line[0] == '[') {
+            section = trim(line.substr(1, line.find(']') - 1));
+            e = nullptr;
+            acts = nullptr;
+            if (section == "entity") {
+                e = new Entity();
+                e->index = (int)_entities.size();
+                _entities.emplace_back(e);
+            }
+            continue;
+        }
+
+        size_t k = line.find('=');
+        if (k == std::string::npos) {
+            warn("key = value expected");
+            continue;
+        }
+        std::string key = trim(line.substr(0, k));
+        std::string val = trim(line.substr(k + 1));
+
+        if (section == "product") {
+            if (key == "id")
+                _productId = val;
+            else if (key == "name")
+                _productName = val;
+            else if (key == "build")
+                _buildId = atoi(val.c_str());
+        } else if (section == "core") {
+            if (key == "timer")
+                _timerOnInit = (val == "on");
+            else if (key == "timer_interval")
+                _timerInterval = std::max(1, atoi(val.c_str()));
+            else if (key == "clock")
+                _fixedClock = strtoll(val.c_str(), nullptr, 0);
+        } else if (section == "entity" && e) {
+            License *lic = e->license.load();
+            if (key == "id")
+                e->id = val;
+            else if (key == "name")
+                e->name = val;
+            else if (key == "description")
+                e->description = val;
+            else if (key == "autostart")
+                e->autoStart = (val == "true" || val == "1");
+            else if (key == "license") {
+                lic = new License(val);
+                lic->entity = e;
+                _licenses.emplace_back(lic);
+                e->license = lic;
+            } else if (key == "status" && lic) {
+                lic->status = (val == "unlocked") ? gs::STATUS_UNLOCKED : (val == "locked") ? gs::STATUS_LOCKED : gs::STATUS_ACTIVE;
+            } else if (key.compare(0, 6, "param.") == 0 && lic) {
+                //param.<name> = [type] value
+                std::string name = key.substr(6);
+                TVarType type = gs::VAR_TYPE_STRING;
+                size_t i = val.find(' ');
+                std::string first = val.substr(0, i);
+                if (typeFromName(first, type))
+                    val = (i == std::string::npos) ? "" : trim(val.substr(i + 1));
+                else if (Variable *p = lic->param(name.c_str()))
+                    type = p->value.type();
+
+                Variable *p = lic->param(name.c_str());
+                if (p && p->value.type() != type)
+                    warn("parameter type mismatch");
+                else
+                    lic->addParam(name, type, PARAM_RW, val.c_str());
+            } else {
+                warn("unknown entity key");
+            }
+        } else if (section == "code" || section == "sn") {
+            if (key == "value") {
+                acts = &(section == "code" ? _codes : _sns)[val];
+            } else if (key == "action" && acts) {
+                ActionSpec act;
+                if (parseAction(val, act))
+                    acts->push_back(act);
+                else
+                    warn("invalid action");
+            } else {
+                warn("value expected before action");
+            }
+        }
+    }
+
+    for (auto &ent : _entities) {
+        _entityIndex[ent->id] = ent.get();
+        if (License *lic = ent->license.load())
+            lic->commitInitValues();
+    }
+}
+
+int Core::init(const char *productId) {
+    if (!_productId.empty() && productId && _productId != productId) {
+        setLastError(STUB_ERROR_INVALID_PRODUCT, "Invalid product id");
+        fire(EVENT_LICENSE_FAIL);
+        return -1;
+    }
+    if (_inited)
+        return 0;
+
+    _mainThread = std::this_thread::get_id();
+
+    fire(EVENT_LICENSE_LOADING);
+    //instantiates custom license models registered while loading
+    for (auto &e : _entities) {
+        License *lic = e->license.load();
+        if (lic == nullptr || lic->custom)
+            continue;
+        bool registered;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_lock);
+            registered = _customLMs.count(lic->id) > 0;
+        }
+        if (registered) {
+            License *custom = createLicense(lic->id.c_str());
+            if (custom)
+                bindLicense(e.get(), custom);
+        }
+    }
+    _inited = true;
+    fire(EVENT_LICENSE_READY);
+
+    if (_timerOnInit)
+        turnOnTimer();
+    return 0;
+}
+
+void Core::cleanUp() {
+    stopTimer();
+    {
+        std::lock_guard<std::mutex> lock(_eventLock);
+        _eventStop = true;
+    }
+    _eventCV.notify_all();
+    if (_eventThread.joinable())
+        _eventThread.join();
+    _eventStop = false;
+
+    if (_inited.exchange(false)) {
+        std::lock_guard<std::recursive_mutex> lock(_lock);
+        for (auto &lic : _licenses) {
+            if (lic->custom && lic->custom->destroy) {
+                lic->custom->destroy(lic->custom->usrData);
+                lic->custom->destroy = nullptr;
+            }
+        }
+    }
+}
+
+Entity *Core::entity(int index) const {
+    if (index < 0 || index >= (int)_entities.size())
+        return nullptr;
+    return _entities[index].get();
+}
+
+Entity *Core::entity(const char *entityId) const {
+    if (entityId == nullptr)
+        return nullptr;
+    auto it = _entityIndex.find(entityId);
+    return it == _entityIndex.end() ? nullptr : it->second;
+}
+
+bool Core::beginAccess(Entity *e) {
+    fire(EVENT_ENTITY_TRY_ACCESS, e);
+    if (!e->isAccessible()) {
+        fire(EVENT_ENTITY_ACCESS_INVALID, e);
+        return false;
+    }
+    if (e->accessCount.fetch_add(1) == 0) {
+        e->lastTick = now();
+        if (License *lic = e->license.load())
+            lic->onAccessStarted();
+        fire(EVENT_ENTITY_ACCESS_STARTED, e);
+    }
+    return true;
+}
+
+bool Core::endAccess(Entity *e) {
+    int n = e->accessCount.load();
+    do {
+        if (n <= 0)
+            return false;
+    } while (!e->accessCount.compare_exchange_weak(n, n - 1));
+
+    if (n == 1) {
+        fire(EVENT_ENTITY_ACCESS_ENDING, e);
+        if (License *lic = e->license.load())
+            lic->onAccessEnded();
+        fire(EVENT_ENTITY_ACCESS_ENDED, e);
+    }
+    return true;
+}
+
+//---- custom license models ----
+void Core::registerCustomLM(const char *licId, gs::lm_create_callback createLM, void *usrData) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    _customLMs[licId] = std::make_pair(createLM, usrData);
+}
+
+License *Core::createCustomLicense(const char *licId, const char *licName, const char *description, const CustomLM &lm) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    License *lic = new License(licId ? licId : "");
+    lic->name = licName ? licName : "";
+    lic->description = description ? description : "";
+    lic->custom.reset(new CustomLM(lm));
+    _licenses.emplace_back(lic);
+    return lic;
+}
+
+License *Core::createLicense(const char *licId) {
+    gs::lm_create_callback createLM = nullptr;
+    void *usrData = nullptr;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_lock);
+        auto it = _customLMs.find(licId);
+        if (it != _customLMs.end()) {
+            createLM = it->second.first;
+            usrData = it->second.second;
+        }
+    }
+    if (createLM)
+        return cast<License>(createLM(usrData));
+
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    License *lic = new License(licId);
+    lic->commitInitValues();
+    _licenses.emplace_back(lic);
+    return lic;
+}
+
+bool Core::bindLicense(Entity *e, License *lic) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    if (lic->entity.load() != nullptr && lic->entity.load() != e)
+        return false;
+    lic->commitInitValues();
+    lic->entity = e;
+    e->license = lic;
+    return true;
+}
+
+//---- variables ----
+Variable *Core::addVariable(const char *varName, TVarType varType, int attr, const char *initValStr) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    Variable *v = variable(varName);
+    if (v)
+        return v;
+    v = new Variable(varName, varType, attr, false);
+    if (initValStr)
+        v->value.fromString(initValStr);
+    _vars.emplace_back(v);
+    return v;
+}
+
+bool Core::removeVariable(const char *varName) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    for (auto it = _vars.begin(); it != _vars.end(); ++it) {
+        if ((*it)->name == varName) {
+            //keeps it alive, there might be open handles
+            _removedVars.push_back(std::move(*it));
+            _vars.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+Variable *Core::variable(const char *varName) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    for (auto &v : _vars) {
+        if (v->name == varName)
+            return v.get();
+    }
+    return nullptr;
+}
+
+Variable *Core::variable(int index) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    if (index < 0 || index >= (int)_vars.size())
+        return nullptr;
+    return _vars[index].get();
+}
+
+int Core::variableCount() {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    return (int)_vars.size();
+}
+
+//---- requests / license codes ----
+Action *Core::addAction(Request *req, gs::action_id_t actId, const char *entityId) {
+    const TActionInfo *info = actionInfo(actId);
+    if (info == nullptr) {
+        setLastError(STUB_ERROR_INVALID_ACTION, "Invalid action id");
+        return nullptr;
+    }
+    if (entityId) {
+        Entity *e = entity(entityId);
+        if (e == nullptr) {
+            setLastError(STUB_ERROR_INVALID_ACTION, "Invalid entity id");
+            return nullptr;
+        }
+        if (!isGenericAction(actId)) {
+            License *lic = e->license.load();
+            if (lic == nullptr)
+                return nullptr;
+            const std::vector<gs::action_id_t> &acts = lic->actions();
+            if (std::find(acts.begin(), acts.end(), actId) == acts.end()) {
+                setLastError(STUB_ERROR_INVALID_ACTION, "Action not supported by license");
+                return nullptr;
+            }
+        }
+    } else if (!isGenericAction(actId)) {
+        setLastError(STUB_ERROR_INVALID_ACTION, "Action must target an entity");
+        return nullptr;
+    }
+
+    Action *act = new Action(actId, entityId ? entityId : "", req);
+    req->retain(); //released by action
+    req->actions.push_back(act);
+    act->retain(); //held by request
+    return act;
+}
+
+const char *Core::requestCode(Request *req) {
+    std::string code = REQUEST_CODE_PREFIX;
+    for (size_t i = 0; i < req->actions.size(); i++) {
+        Action *act = req->actions[i];
+        if (i)
+            code += ';';
+        code += std::to_string(act->id) + "@" + (act->entityId.empty() ? "*" : escape(act->entityId));
+        for (auto &p : act->params)
+            code += "," + escape(p->name) + "=" + escape(p->value.asString());
+    }
+    req->code = code;
+    return req->code.c_str();
+}
+
+bool Core::applyLicenseCode(const char *code) {
+    if (code == nullptr) {
+        setLastError(STUB_ERROR_INVALID_CODE, "Invalid license code");
+        return false;
+    }
+    auto it = _codes.find(code);
+    if (it != _codes.end())
+        return applyActions(it->second);
+
+    //request codes generated by the stub are approved as they are
+    size_t n = strlen(REQUEST_CODE_PREFIX);
+    if (strncmp(code, REQUEST_CODE_PREFIX, n) == 0) {
+        std::vector<ActionSpec> acts;
+        for (const std::string &item : split(code + n, ';')) {
+            std::vector<std::string> parts = split(item, ',');
+            if (parts.empty())
+                continue;
+            size_t k = parts[0].find('@');
+            if (k == std::string::npos)
+                break;
+            ActionSpec act;
+            act.id = (gs::action_id_t)atoi(parts[0].substr(0, k).c_str());
+            std::string target = parts[0].substr(k + 1);
+            if (target != "*")
+                act.entityId = unescape(target);
+            for (size_t i = 1; i < parts.size(); i++) {
+                size_t j = parts[i].find('=');
+                if (j != std::string::npos)
+                    act.params.push_back(std::make_pair(unescape(parts[i].substr(0, j)), unescape(parts[i].substr(j + 1))));
+            }
+            acts.push_back(act);
+        }
+        return applyActions(acts);
+    }
+    setLastError(STUB_ERROR_INVALID_CODE, "Invalid license code");
+    return false;
+}
+
+void Core::reset() {
+    for (auto &e : _entities) {
+        if (License *lic = e->license.load())
+            lic->reset();
+    }
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    _unlockSNs.clear();
+}
+
+void Core::applyAction(const ActionSpec &act, std::vector<Entity *> &affected) {
+    std::vector<Entity *> targets;
+    if (act.entityId.empty()) {
+        for (auto &e : _entities)
+            targets.push_back(e.get());
+    } else if (Entity *e = entity(act.entityId.c_str())) {
+        targets.push_back(e);
+    }
+
+    if (act.id == ACT_CLEAN) {
+        reset();
+        for (auto &e : _entities)
+            targets.push_back(e.get());
+    }
+
+    for (Entity *e : targets) {
+        License *lic = e->license.load();
+        if (lic == nullptr)
+            continue;
+
+        auto value = [&](const char *name, int64_t def) -> int64_t {
+            for (auto &p : act.params) {
+                if (p.first == name)
+                    return strtoll(p.second.c_str(), nullptr, 0);
+            }
+            return def;
+        };
+
+        switch (act.id) {
+        case ACT_UNLOCK:
+            lic->status = gs::STATUS_UNLOCKED;
+            break;
+        case ACT_LOCK:
+            lic->status = gs::STATUS_LOCKED;
+            break;
+        case ACT_SET_STARTDATE:
+            lic->setParamInt("timeBeginEnabled", 1);
+            lic->setParamInt("timeBegin", value("startDate", 0));
+            break;
+        case ACT_SET_ENDDATE:
+            lic->setParamInt("timeEndEnabled", 1);
+            lic->setParamInt("timeEnd", value("endDate", 0));
+            break;
+        case ACT_SET_ACCESSTIME:
+            lic->setParamInt("maxAccessTimes", value("newAccessTime", 0));
+            break;
+        case ACT_ADD_ACCESSTIME:
+            lic->setParamInt("maxAccessTimes", lic->paramInt("maxAccessTimes") + value("addedAccessTime", 0));
+            break;
+        case ACT_SET_EXPIRE_PERIOD:
+            lic->setParamInt("periodInSeconds", value("newPeriodInSeconds", 0));
+            break;
+        case ACT_ADD_EXPIRE_PERIOD:
+            lic->setParamInt("periodInSeconds", lic->paramInt("periodInSeconds") + value("addedPeriodInSeconds", 0));
+            break;
+        case ACT_SET_EXPIRE_DURATION:
+            lic->setParamInt("maxDurationInSeconds", value("newDurationInSeconds", 0));
+            break;
+        case ACT_ADD_EXPIRE_DURATION:
+            lic->setParamInt("maxDurationInSeconds", lic->paramInt("maxDurationInSeconds") + value("addedDurationInSeconds", 0));
+            break;
+        }
+
+        if (lic->custom && lic->custom->onAction) {
+            std::unique_ptr<Request> req(new Request());
+            Action *a = addAction(req.get(), act.id, e->id.c_str());
+            if (a) {
+                for (auto &p : act.params) {
+                    if (Variable *v = a->param(p.first.c_str()))
+                        v->value.fromString(p.second.c_str());
+                }
+                lic->custom->onAction(a, lic->custom->usrData);
+                a->release();
+            }
+            req.release()->release();
+        }
+
+        if (std::find(affected.begin(), affected.end(), e) == affected.end())
+            affected.push_back(e);
+    }
+}
+
+bool Core::applyActions(const std::vector<ActionSpec> &acts) {
+    std::vector<Entity *> affected;
+    for (const ActionSpec &act : acts)
+        applyAction(act, affected);
+
+    for (Entity *e : affected)
+        fire(EVENT_ENTITY_ACTION_APPLIED, e);
+    return true;
+}
+
+//---- serial numbers ----
+bool Core::isSNValid(const char *sn) {
+    return sn && _sns.count(sn) > 0;
+}
+
+bool Core::applySN(const char *sn) {
+    if (!isSNValid(sn)) {
+        setLastError(STUB_ERROR_INVALID_CODE, "Invalid serial number");
+        return false;
+    }
+    const std::vector<ActionSpec> &acts = _sns[sn];
+    std::vector<std::string> ids;
+    for (const ActionSpec &act : acts) {
+        if (act.id != ACT_UNLOCK)
+            continue;
+        if (act.entityId.empty()) {
+            for (auto &e : _entities)
+                ids.push_back(e->id);
+        } else {
+            ids.push_back(act.entityId);
+        }
+    }
+    {
+        std::lock_guard<std::recursive_mutex> lock(_lock);
+        _unlockSNs.push_back(std::make_pair(sn, ids));
+    }
+    return applyActions(acts);
+}
+
+bool Core::revokeSN(const char *sn) {
+    std::vector<ActionSpec> acts;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_lock);
+        for (auto it = _unlockSNs.begin(); it != _unlockSNs.end(); ++it) {
+            if (sn == nullptr || it->first == sn) {
+                for (const std::string &id : it->second) {
+                    ActionSpec act;
+                    act.id = ACT_LOCK;
+                    act.entityId = id;
+                    acts.push_back(act);
+                }
+            }
+        }
+        if (sn == nullptr)
+            _unlockSNs.clear();
+        else {
+            _unlockSNs.erase(std::remove_if(_unlockSNs.begin(), _unlockSNs.end(),
+                                            [sn](const std::pair<std::string, std::vector<std::string>> &p) { return p.first == sn; }),
+                             _unlockSNs.end());
+        }
+    }
+    return !acts.empty() && applyActions(acts);
+}
+
+int Core::unlockSNCount() {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    return (int)_unlockSNs.size();
+}
+
+const char *Core::unlockSN(int index) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    if (index < 0 || index >= (int)_unlockSNs.size())
+        return "";
+    return _unlockSNs[index].first.c_str();
+}
+
+int Core::entitiesUnlockedBySN(const char *sn) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    for (auto &p : _unlockSNs) {
+        if (sn && p.first == sn)
+            return (int)p.second.size();
+    }
+    return 0;
+}
+
+const char *Core::entityUnlockedBySN(const char *sn, int index) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    for (auto &p : _unlockSNs) {
+        if (sn && p.first == sn && index >= 0 && index < (int)p.second.size())
+            return p.second[index].c_str();
+    }
+    return "";
+}
+
+const char *Core::snByUnlockedEntity(const char *entityId) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    for (auto &p : _unlockSNs) {
+        for (const std::string &id : p.second) {
+            if (entityId && id == entityId)
+                return p.first.c_str();
+        }
+    }
+    return "";
+}
+
+//---- move ----
+const char *Core::exportPackage(MovePackage *mp) {
+    std::vector<ActionSpec> acts;
+    mp->data = MOVE_PACKAGE_PREFIX;
+    for (size_t i = 0; i < mp->entityIds.size(); i++) {
+        if (i)
+            mp->data += ',';
+        mp->data += escape(mp->entityIds[i]);
+
+        ActionSpec act;
+        act.id = ACT_LOCK;
+        act.entityId = mp->entityIds[i];
+        acts.push_back(act);
+    }
+    applyActions(acts);
+    return mp->data.c_str();
+}
+
+bool Core::importPackage(const std::string &data) {
+    size_t n = strlen(MOVE_PACKAGE_PREFIX);
+    if (data.compare(0, n, MOVE_PACKAGE_PREFIX) != 0)
+        return false;
+    std::vector<ActionSpec> acts;
+    for (const std::string &id : split(data.substr(n), ',')) {
+        ActionSpec act;
+        act.id = ACT_UNLOCK;
+        act.entityId = unescape(id);
+        acts.push_back(act);
+    }
+    return applyActions(acts);
+}
+
+//---- session variables ----
+void Core::setAppVar(const char *name, const char *val) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    _appVars[name ? name : ""] = val ? val : "";
+}
+
+const char *Core::appVar(const char *name) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    auto it = _appVars.find(name ? name : "");
+    return it == _appVars.end() ? "" : tls_str(it->second);
+}
+
+//---- events ----
+Monitor *Core::addMonitor(gs::gs5_monitor_callback cb, void *usrData, const char *name) {
+    std::lock_guard<std::recursive_mutex> lock(_lock);
+    int n = _totalMonitors.load();
+    if (n >= MAX_MONITORS)
+        return nullptr;
+    _monitors[n].reset(new Monitor(cb, usrData, name));
+    _totalMonitors.store(n + 1, std::memory_order_release);
+    return _monitors[n].get();
+}
+
+void Core::fire(int eventId, Entity *source, const void *data, unsigned int dataSize) {
+    Event evt(eventId, source, data, dataSize);
+    int n = _totalMonitors.load(std::memory_order_acquire);
+    for (int i = 0; i < n; i++) {
+        Monitor *m = _monitors[i].get();
+        m->cb(eventId, &evt, m->usrData);
+    }
+}
+
+void Core::postUserEvent(unsigned int eventId, bool sync, const void *data, unsigned int dataSize) {
+    if (sync) {
+        fire((int)eventId, nullptr, data, data ? dataSize : 0);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_eventLock);
+    std::vector<char> buf;
+    if (data)
+        buf.assign((const char *)data, (const char *)data + dataSize);
+    _pendingEvents.push_back(std::make_pair(eventId, std::move(buf)));
+    if (!_eventThread.joinable())
+        _eventThread = std::thread(&Core::eventProc, this);
+    _eventCV.notify_one();
+}
+
+void Core::eventProc() {
+    std::unique_lock<std::mutex> lock(_eventLock);
+    for (;;) {
+        _eventCV.wait(lock, [this] { return _eventStop || !_pendingEvents.empty(); });
+        if (_pendingEvents.empty())
+            return; //stopping
+        std::pair<unsigned int, std::vector<char>> evt = std::move(_pendingEvents.front());
+        _pendingEvents.pop_front();
+
+        lock.unlock();
+        fire((int)evt.first, nullptr, evt.second.empty() ? nullptr : evt.second.data(), (unsigned int)evt.second.size());
+        lock.lock();
+    }
+}
+
+void Core::tick() {
+    if (_enginePaused)
+        return;
+    int64_t t = now();
+    for (auto &e : _entities) {
+        if (e->accessCount.load() <= 0)
+            continue;
+        int64_t elapsed = t - e->lastTick.exchange(t);
+        if (License *lic = e->license.load())
+            lic->onTick(elapsed);
+        fire(EVENT_ENTITY_ACCESS_HEARTBEAT, e.get());
+        if (!e->isAccessible())
+            fire(EVENT_ENTITY_ACCESS_INVALID, e.get());
+    }
+}
+
+//---- time engine ----
+void Core::timerProc() {
+    std::unique_lock<std::mutex> lock(_timerLock);
+    while (!_timerStop) {
+        if (_timerCV.wait_for(lock, std::chrono::milliseconds(_timerInterval), [this] { return _timerStop; }))
+            break;
+        lock.unlock();
+        tick();
+        lock.lock();
+    }
+}
+
+void Core::turnOnTimer() {
+    std::lock_guard<std::mutex> lock(_timerLock);
+    if (_timerActive)
+        return;
+    _timerStop = false;
+    _timerActive = true;
+    _timer = std::thread(&Core::timerProc, this);
+}
+
+void Core::stopTimer() {
+    {
+        std::lock_guard<std::mutex> lock(_timerLock);
+        if (!_timerActive)
+            return;
+        _timerStop = true;
+        _timerActive = false;
+    }
+    _timerCV.notify_all();
+    if (_timer.joinable() && _timer.get_id() != std::this_thread::get_id())
+        _timer.join();
+    else if (_timer.joinable())
+        _timer.detach();
+}
+
+void Core::turnOffTimer() {
+    stopTimer();
+}
+
+} // namespace stub
@@ -0,0 +1,441 @@
+/*! \file StubCore.h
+  \brief In-memory model of the stand-in gsCore
+
+  The stub core implements the flat gsCore api (see GS5_Intf.h) on top of an in-memory model of
+  entities, licenses, variables, requests and events, loaded from a small data file (see readme.md).
+
+  It is only meant for testing and profiling the SDK-C layer, no license data is decrypted and no
+  network access is ever made.
+  */
+#ifndef _GS_STUB_CORE_H_
+#define _GS_STUB_CORE_H_
+
+#include <GS5_Intf.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace stub {
+
+using gs::TEventType;
+using gs::TLicenseStatus;
+using gs::TVarType;
+
+/// Error codes reported by the stub core (gsGetLastErrorCode)
+enum TStubError {
+    STUB_ERROR_GENERIC = -1,
+    STUB_ERROR_INVALID_HANDLE = -2,
+    STUB_ERROR_INVALID_ACTION = -3,
+    STUB_ERROR_INVALID_PRODUCT = -4,
+    STUB_ERROR_INVALID_CODE = -5,
+    STUB_ERROR_NOT_SUPPORTED = -6
+};
+
+/// Object kind, every handle given out by the stub core points to an Object
+enum TObjKind {
+    OBJ_ENTITY,
+    OBJ_LICENSE,
+    OBJ_VARIABLE,
+    OBJ_REQUEST,
+    OBJ_ACTION,
+    OBJ_EVENT,
+    OBJ_MONITOR,
+    OBJ_MOVE_PACKAGE,
+    OBJ_CODE_EXCHANGE
+};
+
+/** \brief Base of all handle objects
+ *
+ * Model objects (entities, licenses, parameters, variables, monitors) live as long as the core, closing
+ * their handles does nothing. Transient objects (requests, actions, move packages...) are reference counted
+ * and destroyed when the last handle is closed.
+ */
+struct Object {
+    static const uint32_t MAGIC = 0x47534F42; //"GSOB"
+
+    uint32_t magic;
+    TObjKind kind;
+    bool transient;
+    std::atomic<int> refs;
+
+    Object(TObjKind k, bool isTransient) : magic(MAGIC), kind(k), transient(isTransient), refs(1) {}
+    virtual ~Object() { magic = 0; }
+
+    void retain() {
+        if (transient)
+            refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    void release() {
+        if (transient && refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+};
+
+/// Casts a handle to an object of expected kind, nullptr if the handle is invalid
+template <typename T>
+T *cast(gs::gs_handle_t h) {
+    Object *p = (Object *)h;
+    if (p == nullptr || p->magic != Object::MAGIC || p->kind != T::KIND)
+        return nullptr;
+    return static_cast<T *>(p);
+}
+
+/** \brief Typed value of a variable / parameter
+ *
+ * Numeric values are kept in atomics so they can be read from any thread without locking.
+ */
+class Value {
+  private:
+    TVarType _type;
+    std::atomic<int64_t> _i;
+    std::atomic<double> _d;
+    mutable std::mutex _lock;
+    std::string _s;
+
+  public:
+    explicit Value(TVarType type) : _type(type), _i(0), _d(0) {}
+
+    TVarType type() const { return _type; }
+
+    bool isInteger() const;
+    bool isFloat() const { return _type == gs::VAR_TYPE_FLOAT || _type == gs::VAR_TYPE_DOUBLE; }
+
+    std::string asString() const;
+    bool asInt64(int64_t &v) const;
+    bool asDouble(double &v) const;
+
+    bool fromString(const char *s);
+    bool fromInt64(int64_t v);
+    bool fromDouble(double v);
+
+    void assign(const Value &src);
+};
+
+/// User defined variable, license parameter or action parameter
+struct Variable : public Object {
+    static const TObjKind KIND = OBJ_VARIABLE;
+
+    std::string name;
+    int attr;
+    bool isParam; //license / action parameter: attr uses LM_PARAM_XXX
+    Value value;
+    Object *owner; //retained transient owner (action) if any
+
+    Variable(const std::string &varName, TVarType type, int attribute, bool param, Object *ownerObj = nullptr);
+    ~Variable();
+
+    bool readable() const { return isParam ? (attr & LM_PARAM_READ) != 0 : (attr & VAR_ATTR_READ) != 0; }
+    bool writable() const { return isParam ? (attr & LM_PARAM_WRITE) != 0 : (attr & VAR_ATTR_WRITE) != 0; }
+};
+
+struct Entity;
+
+/// Custom license model callbacks (gsCreateCustomLicense)
+struct CustomLM {
+    void *usrData;
+    gs::lm_isValid_callback isValid;
+    gs::lm_startAccess_callback startAccess;
+    gs::lm_finishAccess_callback finishAccess;
+    gs::lm_onAction_callback onAction;
+    gs::lm_destroy_callback destroy;
+};
+
+/// License attached to an entity
+struct License : public Object {
+    static const TObjKind KIND = OBJ_LICENSE;
+
+    std::string id, name, description;
+    std::atomic<int> status; //TLicenseStatus
+    TLicenseStatus initStatus;
+    std::atomic<Entity *> entity;
+
+    std::vector<std::unique_ptr<Variable>> params;
+    std::vector<std::string> initValues; //initial parameter values, restored by ACT_CLEAN
+    std::unordered_map<std::string, Variable *> paramIndex;
+
+    std::unique_ptr<CustomLM> custom;
+
+    explicit License(const std::string &licId);
+
+    Variable *addParam(const std::string &paramName, TVarType type, int attr, const char *initValue = nullptr);
+    void commitInitValues();
+    Variable *param(const char *paramName) const;
+
+    int64_t paramInt(const char *paramName, int64_t def = 0) const;
+    void setParamInt(const char *paramName, int64_t v);
+
+    //license model logic
+    bool isValid() const;
+    void onAccessStarted();
+    void onAccessEnded();
+    void onTick(int64_t elapsedSeconds);
+
+    //actions appliable to this license
+    const std::vector<gs::action_id_t> &actions() const;
+
+    void reset();
+};
+
+/// Entity
+struct Entity : public Object {
+    static const TObjKind KIND = OBJ_ENTITY;
+
+    int index;
+    std::string id, name, description;
+    bool autoStart;
+    std::atomic<License *> license;
+    std::atomic<int> accessCount;
+    std::atomic<int64_t> lastTick;
+
+    Entity() : Object(OBJ_ENTITY, false), index(0), autoStart(false), license(nullptr), accessCount(0), lastTick(0) {}
+
+    unsigned int attributes() const;
+    bool isAccessible() const;
+};
+
+/// Action of a request
+struct Action : public Object {
+    static const TObjKind KIND = OBJ_ACTION;
+
+    gs::action_id_t id;
+    std::string entityId; //empty: global action
+    std::vector<std::unique_ptr<Variable>> params;
+    Object *request;
+    std::string whatToDo;
+
+    Action(gs::action_id_t actId, const std::string &targetEntityId, Object *req);
+    ~Action();
+
+    Variable *param(const char *paramName) const;
+};
+
+/// Request
+struct Request : public Object {
+    static const TObjKind KIND = OBJ_REQUEST;
+
+    std::vector<Action *> actions;
+    std::string code;
+
+    Request() : Object(OBJ_REQUEST, true) {}
+    ~Request();
+};
+
+/// Event being dispatched, lives on the stack of the dispatching thread
+struct Event : public Object {
+    static const TObjKind KIND = OBJ_EVENT;
+
+    int id;
+    Entity *source;
+    const void *data;
+    unsigned int dataSize;
+
+    Event(int evtId, Entity *src, const void *evtData = nullptr, unsigned int evtDataSize = 0)
+        : Object(OBJ_EVENT, false), id(evtId), source(src), data(evtData), dataSize(evtDataSize) {}
+
+    TEventType type() const;
+};
+
+/// Event monitor
+struct Monitor : public Object {
+    static const TObjKind KIND = OBJ_MONITOR;
+
+    gs::gs5_monitor_callback cb;
+    void *usrData;
+    std::string name;
+
+    Monitor(gs::gs5_monitor_callback callback, void *data, const char *monitorName)
+        : Object(OBJ_MONITOR, false), cb(callback), usrData(data), name(monitorName ? monitorName : "") {}
+};
+
+/// Move package
+struct MovePackage : public Object {
+    static const TObjKind KIND = OBJ_MOVE_PACKAGE;
+
+    std::vector<std::string> entityIds;
+    std::string data;
+
+    MovePackage() : Object(OBJ_MOVE_PACKAGE, true) {}
+};
+
+/// Code exchange session
+struct CodeExchange : public Object {
+    static const TObjKind KIND = OBJ_CODE_EXCHANGE;
+
+    int errorCode;
+    std::string errorMessage;
+    std::string licenseCode;
+
+    CodeExchange() : Object(OBJ_CODE_EXCHANGE, true), errorCode(0) {}
+};
+
+/// Action to apply when a license code (or serial number) is accepted
+struct ActionSpec {
+    gs::action_id_t id;
+    std::string entityId;
+    std::vector<std::pair<std::string, std::string>> params;
+};
+
+/** \brief The stand-in core
+ *
+ * The model structure (entities, licenses, parameters) is fixed once the data file is loaded, so all
+ * read-only apis are lock free. Only structural changes (variables, custom licenses, serial numbers) take a lock.
+ */
+class Core {
+  private:
+    std::string _dataFile;
+    std::string _productId, _productName;
+    int _buildId;
+    bool _timerOnInit;
+    int _timerInterval; //ms
+    std::atomic<int64_t> _fixedClock; //0: uses system clock
+
+    std::vector<std::unique_ptr<Entity>> _entities;
+    std::unordered_map<std::string, Entity *> _entityIndex;
+    std::vector<std::unique_ptr<License>> _licenses; //all licenses ever created (never freed)
+    std::map<std::string, std::vector<ActionSpec>> _codes;
+    std::map<std::string, std::vector<ActionSpec>> _sns;
+
+    std::atomic<bool> _inited;
+    std::thread::id _mainThread;
+
+    //monitors (append only)
+    static const int MAX_MONITORS = 16;
+    std::unique_ptr<Monitor> _monitors[MAX_MONITORS];
+    std::atomic<int> _totalMonitors;
+
+    //structural changes
+    std::recursive_mutex _lock;
+    std::vector<std::unique_ptr<Variable>> _vars;
+    std::vector<std::unique_ptr<Variable>> _removedVars;
+    std::map<std::string, std::pair<gs::lm_create_callback, void *>> _customLMs;
+    std::map<std::string, std::string> _appVars;
+    std::vector<std::pair<std::string, std::vector<std::string>>> _unlockSNs;
+
+    //time engine
+    std::atomic<bool> _timerActive;
+    std::atomic<bool> _enginePaused;
+    std::thread _timer;
+    std::mutex _timerLock;
+    std::condition_variable _timerCV;
+    bool _timerStop;
+
+    //async user events
+    std::thread _eventThread;
+    std::mutex _eventLock;
+    std::condition_variable _eventCV;
+    std::deque<std::pair<unsigned int, std::vector<char>>> _pendingEvents;
+    bool _eventStop;
+
+    Core();
+
+    void load(const char *dataFile);
+    bool parseAction(const std::string &spec, ActionSpec &act);
+
+    bool applyActions(const std::vector<ActionSpec> &acts);
+    void applyAction(const ActionSpec &act, std::vector<Entity *> &affected);
+    void reset();
+
+    void timerProc();
+    void eventProc();
+    void stopTimer();
+
+  public:
+    ~Core();
+
+    static Core &instance();
+
+    //product
+    const std::string &productId() const { return _productId; }
+    const std::string &productName() const { return _productName; }
+    int buildId() const { return _buildId; }
+
+    int init(const char *productId);
+    void cleanUp();
+    bool isInited() const { return _inited; }
+    bool isMainThread() const { return std::this_thread::get_id() == _mainThread; }
+
+    time_t now() const;
+    void setClock(time_t t) { _fixedClock = t; }
+
+    //entities
+    int entityCount() const { return (int)_entities.size(); }
+    Entity *entity(int index) const;
+    Entity *entity(const char *entityId) const;
+    bool beginAccess(Entity *e);
+    bool endAccess(Entity *e);
+
+    //custom license models
+    void registerCustomLM(const char *licId, gs::lm_create_callback createLM, void *usrData);
+    License *createCustomLicense(const char *licId, const char *licName, const char *description, const CustomLM &lm);
+    License *createLicense(const char *licId);
+    bool bindLicense(Entity *e, License *lic);
+
+    //variables
+    Variable *addVariable(const char *varName, TVarType varType, int attr, const char *initValStr);
+    bool removeVariable(const char *varName);
+    Variable *variable(const char *varName);
+    Variable *variable(int index);
+    int variableCount();
+
+    //requests / license codes
+    Action *addAction(Request *req, gs::action_id_t actId, const char *entityId);
+    const char *requestCode(Request *req);
+    bool applyLicenseCode(const char *code);
+
+    //serial numbers
+    bool isSNValid(const char *sn);
+    bool applySN(const char *sn);
+    bool revokeSN(const char *sn);
+    int unlockSNCount();
+    const char *unlockSN(int index);
+    int entitiesUnlockedBySN(const char *sn);
+    const char *entityUnlockedBySN(const char *sn, int index);
+    const char *snByUnlockedEntity(const char *entityId);
+
+    //move
+    const char *exportPackage(MovePackage *mp);
+    bool importPackage(const std::string &data);
+
+    //session variables
+    void setAppVar(const char *name, const char *val);
+    const char *appVar(const char *name);
+
+    //events
+    Monitor *addMonitor(gs::gs5_monitor_callback cb, void *usrData, const char *name);
+    void fire(int eventId, Entity *source = nullptr, const void *data = nullptr, unsigned int dataSize = 0);
+    void postUserEvent(unsigned int eventId, bool sync, const void *data, unsigned int dataSize);
+    void tick();
+
+    //time engine
+    void turnOnTimer();
+    void turnOffTimer();
+    bool isTimerActive() const { return _timerActive; }
+    void pauseEngine() { _enginePaused = true; }
+    void resumeEngine() { _enginePaused = false; }
+    bool isEngineActive() const { return !_enginePaused; }
+};
+
+//Last error of the calling thread
+void setLastError(int code, const char *msg);
+int lastErrorCode();
+const char *lastErrorMessage();
+
+//Returns a string in thread local storage, valid until the next call on the same thread
+const char *tls_str(const std::string &s);
+
+//Name of a variable type as used in data file ("int", "time"...)
+const char *typeName(TVarType type);
+
+} // namespace stub
+
+#endif
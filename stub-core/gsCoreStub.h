@@ -0,0 +1,23 @@
+/*! \file gsCoreStub.h
+  \brief Test hooks exported by the stand-in gsCore
+
+  These apis only exist in the stub core, tests resolve them at runtime (dlsym) so the same test binary
+  can still run against a real gsCore where they are simply not available.
+  */
+#ifndef _GS_CORE_STUB_H_
+#define _GS_CORE_STUB_H_
+
+#include <GS5_Intf.h>
+
+#include <ctime>
+
+extern "C" {
+/// Table of all apis, to use the stub core in process (see gs::sdk_set_api_table())
+const gs::sdk_api_entry *gsStubGetApiTable(int *count);
+/// Fires an event to all monitors, entityId (optional) is the event source
+void gsStubFireEvent(int evtId, const char *entityId);
+/// Freezes the clock seen by license models at t (unix time), 0 restores the system clock
+void gsStubSetClock(time_t t);
+}
+
+#endif
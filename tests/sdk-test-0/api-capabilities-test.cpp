@@ -0,0 +1,26 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <GS5.h>
+using namespace gs;
+
+namespace {
+const char *tag = "[api-capabilities]";
+const int ORD_GET_VERSION = 2;             //gsGetVersion, the first api
+const int ORD_APPLY_LICENSE_CODE_EX = 158; //gsApplyLicenseCodeEx
+} // namespace
+
+TEST_CASE("api-capabilities", tag) {
+    CHECK(gsHasApi(ORD_GET_VERSION));
+    CHECK(gsHasApi(ORD_APPLY_LICENSE_CODE_EX));
+
+    //out of range or unused ordinals
+    CHECK_FALSE(gsHasApi(-1));
+    CHECK_FALSE(gsHasApi(0));
+    CHECK_FALSE(gsHasApi(SDK_MAX_API_ORDINAL + 1));
+
+    auto caps = TGSCore::capabilities();
+    CHECK(caps.count() == (size_t)sdk_prebind());
+    for (int ord = 0; ord <= SDK_MAX_API_ORDINAL; ord++)
+        CHECK(caps[ord] == gsHasApi(ord));
+}
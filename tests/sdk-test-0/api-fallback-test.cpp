@@ -0,0 +1,80 @@
+// The stub core is linked in process with an api table lacking gsApplyLicenseCodeEx and gsRenderHTMLEx, like an
+// older gsCore. gsHasApi() must report them missing and TGSCore must fall back to gsApplyLicenseCode / gsRenderHTML.
+// The process exits with 0 if all checks pass.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <gsCoreStub.h>
+#include <sdk-test-0/license_data.h>
+
+#include <GS5.h>
+using namespace gs;
+
+namespace {
+const char *productId = "b5e5cfab-3783-4358-a575-3520d1ef0f7b";
+const char *password = "egsne_3111&IJGN&dcsvo&17332";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+
+const int ORD_APPLY_LICENSE_CODE = 46;     //gsApplyLicenseCode
+const int ORD_RENDER_HTML = 80;            //gsRenderHTML
+const int ORD_RENDER_HTML_EX = 83;         //gsRenderHTMLEx
+const int ORD_APPLY_LICENSE_CODE_EX = 158; //gsApplyLicenseCodeEx
+
+int failures = 0;
+
+void check(bool ok, const char *what) {
+    if (!ok) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+uint64_t calls(int ord) {
+    sdk_api_stats stats;
+    return sdk_profile_get_stats(ord, &stats) ? stats.calls : 0;
+}
+} // namespace
+
+int main() {
+    int count = 0;
+    const sdk_api_entry *all = gsStubGetApiTable(&count);
+    static std::vector<sdk_api_entry> table;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(all[i].name, "gsApplyLicenseCodeEx") != 0 && strcmp(all[i].name, "gsRenderHTMLEx") != 0)
+            table.push_back(all[i]);
+    }
+    if (!sdk_set_api_table(table.data(), (int)table.size())) {
+        printf("api table not accepted\n");
+        return 2;
+    }
+
+    check(!gsHasApi(ORD_APPLY_LICENSE_CODE_EX), "gsHasApi(gsApplyLicenseCodeEx)");
+    check(!gsHasApi(ORD_RENDER_HTML_EX), "gsHasApi(gsRenderHTMLEx)");
+    check(gsHasApi(ORD_APPLY_LICENSE_CODE), "!gsHasApi(gsApplyLicenseCode)");
+    check(gsHasApi(ORD_RENDER_HTML), "!gsHasApi(gsRenderHTML)");
+    auto caps = TGSCore::capabilities();
+    check(!caps[ORD_APPLY_LICENSE_CODE_EX] && !caps[ORD_RENDER_HTML_EX], "capabilities()");
+
+    auto core = TGSCore::getInstance();
+    if (!core->init(productId, sdk_test_0_lic_data_build_4, sizeof(sdk_test_0_lic_data_build_4), password)) {
+        printf("license cannot be initialized\n");
+        return 2;
+    }
+
+    sdk_profile_enable(true);
+    sdk_profile_reset();
+    check(core->applyLicenseCode(lic_e1_unlock, "sn", "ref"), "applyLicenseCode(code, sn, snRef)");
+    check(core->entity(e1_id).isUnlocked(), "e1 unlocked");
+    check(calls(ORD_APPLY_LICENSE_CODE) == 1, "gsApplyLicenseCode called");
+    core->renderHTML("about:blank", "title", 400, 300, true, false, false);
+    check(calls(ORD_RENDER_HTML) == 1, "gsRenderHTML called");
+    sdk_profile_enable(false);
+    sdk_profile_reset(); //nothing to dump at exit
+
+    TGSCore::finish();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <thread>
+
+#include <GS5.h>
+using namespace gs;
+
+namespace {
+const char *tag = "[api-profile]";
+const int ORD_GET_ENTITY_COUNT = 10; //gsGetEntityCount
+} // namespace
+
+TEST_CASE("api-profile", tag) {
+    auto core = TGSCore::getInstance();
+    const int N = 1000;
+
+    sdk_profile_reset();
+    sdk_profile_enable(true);
+    CHECK(sdk_profile_enabled());
+
+    //calls from two threads are merged
+    auto calls = [core] {
+        for (int i = 0; i < N; i++)
+            core->getTotalEntities();
+    };
+    std::thread t(calls);
+    calls();
+    t.join();
+
+    sdk_profile_enable(false);
+    CHECK_FALSE(sdk_profile_enabled());
+
+    sdk_api_stats stats;
+    REQUIRE(sdk_profile_get_stats(ORD_GET_ENTITY_COUNT, &stats));
+    CHECK(stats.name == std::string("gsGetEntityCount"));
+    CHECK(stats.calls == 2 * N);
+    CHECK(stats.min <= stats.p50);
+    CHECK(stats.p50 <= stats.p90);
+    CHECK(stats.p90 <= stats.p99);
+    CHECK(stats.p99 <= stats.p999);
+    CHECK(stats.p999 <= stats.max);
+    CHECK(stats.total >= stats.calls * stats.min);
+
+    SECTION("disabled") {
+        //not recorded anymore
+        core->getTotalEntities();
+        REQUIRE(sdk_profile_get_stats(ORD_GET_ENTITY_COUNT, &stats));
+        CHECK(stats.calls == 2 * N);
+    }
+
+    SECTION("reset") {
+        sdk_profile_reset();
+        CHECK_FALSE(sdk_profile_get_stats(ORD_GET_ENTITY_COUNT, &stats));
+    }
+    //nothing left to dump at exit
+    sdk_profile_reset();
+}
@@ -0,0 +1,55 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <GS5.h>
+using namespace gs;
+
+namespace {
+const char *tag = "[core-discovery]";
+
+std::string read_line(const char *fileName) {
+    std::string s;
+    FILE *f = fopen(fileName, "r");
+    if (f) {
+        char buf[4096];
+        if (fgets(buf, sizeof(buf), f))
+            s = buf;
+        fclose(f);
+    }
+    while (!s.empty() && s.back() == '\n')
+        s.pop_back();
+    return s;
+}
+} // namespace
+
+TEST_CASE("core-discovery", tag) {
+    TGSCore::getInstance();
+
+    const sdk_core_discovery *d = sdk_get_core_discovery();
+    REQUIRE(d != nullptr);
+    CHECK(std::string(d->path).find("gsCore") != std::string::npos);
+
+    //probed in order until gsCore is loaded
+    REQUIRE(d->probeCount > 0);
+    uint64_t elapsed = 0;
+    for (int i = 0; i < d->probeCount; i++) {
+        CHECK(d->probes[i].loaded == (i == d->probeCount - 1));
+        elapsed += d->probes[i].elapsed;
+    }
+    CHECK(d->elapsed >= elapsed);
+    CHECK(d->cached == (d->probes[0].source == std::string("cache") && d->probes[0].loaded));
+
+    //too late
+    CHECK_FALSE(sdk_set_core_cache("gsCore.cache"));
+
+    const char *cache = getenv("GS_SDK_CORE_CACHE");
+    if (cache && *cache) {
+        SECTION("cache") {
+            CHECK(read_line(cache) == d->path);
+        }
+    }
+}
@@ -0,0 +1,43 @@
+// An entity event handler exits the app (gsExitApp) while the events are delivered from the dispatcher thread
+// (EVENT_DISPATCH_THREAD), the usual reaction to a license failure. The process must exit with the code given.
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include <sdk-test-0/license_data.h>
+
+#include <GS5.h>
+using namespace gs;
+
+namespace {
+const char *productId = "b5e5cfab-3783-4358-a575-3520d1ef0f7b";
+const char *password = "egsne_3111&IJGN&dcsvo&17332";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+
+void onEntityEvent(unsigned int eventId, TGSEntity *, void *) {
+    if (eventId == EVENT_ENTITY_ACCESS_STARTED)
+        gsExitApp(0);
+}
+} // namespace
+
+int main() {
+    auto core = TGSCore::getInstance();
+    if (!core->init(productId, sdk_test_0_lic_data_build_4, sizeof(sdk_test_0_lic_data_build_4), password)) {
+        printf("license cannot be initialized\n");
+        return 2;
+    }
+    if (!core->applyLicenseCode(lic_e1_unlock)) {
+        printf("license code cannot be applied\n");
+        return 2;
+    }
+    core->setEntityEventHandler(onEntityEvent, nullptr);
+    core->setEventDispatch(EVENT_DISPATCH_THREAD);
+    core->entity(e1_id).beginAccess();
+
+    std::this_thread::sleep_for(std::chrono::seconds(10));
+    printf("the handler did not exit the app\n");
+    return 1;
+}
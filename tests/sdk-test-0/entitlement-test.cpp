@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <chrono>
+#include <thread>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[entitlement]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+} // namespace
+
+TEST_CASE("entitlement", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+    core->reconcileEntitlements();
+
+    int e1 = core->entityRegistry()->indexOf(e1_id);
+    REQUIRE(e1 >= 0);
+
+    SECTION("cached attributes") {
+        for (int i = 0; i < core->getTotalEntities(); i++)
+            CHECK(core->entityAttributes(i) == (core->entity(i).attribute() & TEntitlementMap::MASK));
+        CHECK(core->entityAttributes(e1_id) == core->entityAttributes(e1));
+        CHECK(core->entityAttributes(-1) == 0);
+        CHECK(core->entityAttributes("no-such-entity") == 0);
+    }
+
+    SECTION("updated on events") {
+        CHECK_FALSE(core->entityAttributes(e1) & ENTITY_ATTRIBUTE_UNLOCKED);
+        CHECK(core->applyLicenseCode(lic_e1_unlock));
+        CHECK(core->entityAttributes(e1) & ENTITY_ATTRIBUTE_UNLOCKED);
+        clean_license();
+        CHECK_FALSE(core->entityAttributes(e1) & ENTITY_ATTRIBUTE_UNLOCKED);
+    }
+
+    SECTION("reconciled periodically") {
+        CHECK(core->applyLicenseCode(lic_e1_unlock));
+        core->setEntitlementReconcileInterval(10);
+
+        //no event is fired for a license locked directly
+        core->entity(e1).license().lock();
+        bool locked = false;
+        for (int i = 0; i < 100 && !locked; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            locked = (core->entityAttributes(e1) & ENTITY_ATTRIBUTE_LOCKED) != 0;
+        }
+        CHECK(locked);
+
+        core->setEntitlementReconcileInterval(1000);
+        clean_license();
+    }
+
+    SECTION("bitmap") {
+        TEntitlementMap m(40);
+        CHECK(m.size() == 40);
+        m.set(17, ENTITY_ATTRIBUTE_ACCESSIBLE | ENTITY_ATTRIBUTE_AUTOSTART);
+        m.set(18, TEntitlementMap::MASK);
+        CHECK(m.get(17) == ENTITY_ATTRIBUTE_ACCESSIBLE);
+        CHECK(m.get(18) == TEntitlementMap::MASK);
+        CHECK(m.get(16) == 0);
+        m.set(18, ENTITY_ATTRIBUTE_LOCKED);
+        CHECK(m.get(18) == ENTITY_ATTRIBUTE_LOCKED);
+        CHECK(m.get(17) == ENTITY_ATTRIBUTE_ACCESSIBLE);
+    }
+}
@@ -0,0 +1,52 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[entity-registry]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+const char *e2_id = "c46c0500-e79f-4a0f-994b-ff8b56b441c2";
+} // namespace
+
+TEST_CASE("entity-registry", tag) {
+    auto core = TGSCore::getInstance();
+    std::shared_ptr<const TEntityRegistry> reg = core->entityRegistry();
+    REQUIRE(reg->size() == core->getTotalEntities());
+
+    SECTION("lookup") {
+        CHECK(reg->indexOf(e1_id) == 0);
+        CHECK(reg->indexOf(e2_id) == 1);
+        CHECK(reg->indexOf("no-such-entity") == -1);
+        CHECK(reg->find("no-such-entity") == nullptr);
+
+        const Entity *e2 = reg->find(e2_id);
+        REQUIRE(e2 != nullptr);
+        CHECK(e2->name() == std::string("e2"));
+        CHECK(reg->id(1) == std::string(e2_id));
+
+        int n = 0;
+        for (const Entity &e : *reg)
+            CHECK(e.id() == std::string(reg->id(n++)));
+        CHECK(n == reg->size());
+    }
+
+    SECTION("snapshot") {
+        //unchanged until the license changes
+        CHECK(core->entityRegistry() == reg);
+
+        core->lockAllEntities();
+        CHECK(core->isAllEntitiesLocked());
+
+        clean_license();
+        std::shared_ptr<const TEntityRegistry> reg2 = core->entityRegistry();
+        CHECK(reg2 != reg);
+        CHECK(reg2->generation() != reg->generation());
+
+        //the previous snapshot is still usable
+        CHECK(reg->find(e1_id)->name() == std::string("e1"));
+    }
+}
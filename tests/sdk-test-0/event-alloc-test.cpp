@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+//heap allocations of the calling thread, other threads (e.g. the entitlement reconciler) are not counted
+namespace {
+thread_local long t_allocs = 0;
+} // namespace
+
+void *operator new(std::size_t size) {
+    t_allocs++;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, std::size_t) noexcept { free(p); }
+
+namespace {
+const char *tag = "[event-alloc]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+
+struct THeartBeats {
+    int count = 0;
+    TGSEntity *entity = nullptr;
+    bool sameEntity = true;
+};
+
+void onEntityEvent(unsigned int eventId, TGSEntity *entity, void *usrData) {
+    THeartBeats *hb = (THeartBeats *)usrData;
+    if (eventId != EVENT_ENTITY_ACCESS_HEARTBEAT)
+        return;
+    if (hb->entity != nullptr && hb->entity != entity)
+        hb->sameEntity = false;
+    hb->entity = entity;
+    hb->count++;
+}
+
+void onHeartBeat(unsigned int, TGSEntity *, void *, unsigned int, void *usrData) {
+    (*(int *)usrData)++;
+}
+} // namespace
+
+TEST_CASE("event-alloc", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+    REQUIRE(core->applyLicenseCode(lic_e1_unlock));
+    auto reg = core->entityRegistry();
+
+    THeartBeats hb;
+    int subscribed = 0;
+    core->setEntityEventHandler(onEntityEvent, &hb);
+    int s = core->subscribe(onHeartBeat, &subscribed, TEventMask{EVENT_ENTITY_ACCESS_HEARTBEAT}, e1_id);
+
+    Entity e1 = core->entity(e1_id);
+    REQUIRE(e1.beginAccess());
+    core->tickFromExternalTimer(); //warm up
+
+    long allocs = t_allocs;
+    for (int i = 0; i < 100; i++)
+        core->tickFromExternalTimer();
+    allocs = t_allocs - allocs;
+
+    CHECK(e1.endAccess());
+    core->unsubscribe(s);
+    core->setEntityEventHandler(NULL, NULL);
+
+    CHECK(hb.count == 101);
+    CHECK(subscribed == 101);
+    CHECK(allocs == 0);
+    //the interned entity object
+    CHECK(hb.sameEntity);
+    CHECK(hb.entity == reg->object(reg->indexOf(e1_id)));
+    CHECK(std::string(hb.entity->id()) == e1_id);
+
+    clean_license();
+}
@@ -0,0 +1,155 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[event-dispatch]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+
+struct TReceived {
+    unsigned int eventId;
+    std::string source; //entity id or user event data
+    std::thread::id thread;
+};
+std::vector<TReceived> s_received;
+
+void onEntityEvent(unsigned int eventId, TGSEntity *entity, void *) {
+    s_received.push_back({eventId, entity->id(), std::this_thread::get_id()});
+}
+void onUserEvent(unsigned int eventId, void *data, unsigned int size, void *) {
+    s_received.push_back({eventId, std::string((const char *)data, size), std::this_thread::get_id()});
+}
+
+void postUserEvent(const char *data) {
+    gsPostUserEvent(GS_USER_EVENT, true, (void *)data, (unsigned int)strlen(data));
+}
+
+bool actionApplied(const TReceived &r) {
+    return r.eventId == EVENT_ENTITY_ACTION_APPLIED && r.source == e1_id;
+}
+} // namespace
+
+TEST_CASE("event-dispatch", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+    s_received.clear();
+    core->setEntityEventHandler(onEntityEvent, nullptr);
+    core->setUserEventHandler(onUserEvent, nullptr);
+
+    SECTION("pump") {
+        core->setEventDispatch(EVENT_DISPATCH_PUMP, 64);
+        CHECK(core->eventDispatchMode() == EVENT_DISPATCH_PUMP);
+
+        CHECK(core->applyLicenseCode(lic_e1_unlock));
+        CHECK(s_received.empty());
+        CHECK(core->eventQueueStats().pending > 0);
+
+        int n = core->dispatchPending();
+        CHECK(n == (int)s_received.size());
+        CHECK(core->eventQueueStats().pending == 0);
+        CHECK(core->eventQueueStats().delivered == (uint64_t)n);
+        REQUIRE(n > 0);
+        CHECK(std::any_of(s_received.begin(), s_received.end(), actionApplied));
+        CHECK(s_received[0].thread == std::this_thread::get_id());
+
+        SECTION("maxEvents") {
+            postUserEvent("a");
+            postUserEvent("b");
+            CHECK(core->dispatchPending(1) == 1);
+            CHECK(s_received.back().source == "a");
+            CHECK(core->dispatchPending() == 1);
+            CHECK(s_received.back().source == "b");
+        }
+        SECTION("pending events delivered when switched back") {
+            postUserEvent("c");
+            core->setEventDispatch(EVENT_DISPATCH_SYNC);
+            CHECK(s_received.back().source == "c");
+        }
+    }
+
+    SECTION("thread") {
+        core->setEventDispatch(EVENT_DISPATCH_THREAD);
+        CHECK(core->applyLicenseCode(lic_e1_unlock));
+        //joins the dispatcher once the events queued are delivered
+        core->setEventDispatch(EVENT_DISPATCH_SYNC);
+
+        REQUIRE_FALSE(s_received.empty());
+        CHECK(std::any_of(s_received.begin(), s_received.end(), actionApplied));
+        CHECK(s_received[0].thread != std::this_thread::get_id());
+    }
+
+    SECTION("backpressure") {
+        SECTION("drop newest") {
+            core->setEventDispatch(EVENT_DISPATCH_PUMP, 2, EVENT_QUEUE_DROP_NEWEST);
+            postUserEvent("1");
+            postUserEvent("2");
+            postUserEvent("3");
+            TEventQueueStats stats = core->eventQueueStats();
+            CHECK(stats.queued == 2);
+            CHECK(stats.dropped == 1);
+            CHECK(stats.highWater == 2);
+            CHECK(core->dispatchPending() == 2);
+            CHECK(s_received[0].source == "1");
+            CHECK(s_received[1].source == "2");
+        }
+        SECTION("drop oldest") {
+            core->setEventDispatch(EVENT_DISPATCH_PUMP, 2, EVENT_QUEUE_DROP_OLDEST);
+            postUserEvent("1");
+            postUserEvent("2");
+            postUserEvent("3");
+            CHECK(core->eventQueueStats().dropped == 1);
+            CHECK(core->dispatchPending() == 2);
+            CHECK(s_received[0].source == "2");
+            CHECK(s_received[1].source == "3");
+        }
+        SECTION("block") {
+            TEventQueue q(1, EVENT_QUEUE_BLOCK);
+            CHECK(q.push(GS_USER_EVENT, EVENT_TYPE_USER, NULL, "1", 1, true));
+            //the delivering thread itself is never blocked
+            CHECK_FALSE(q.push(GS_USER_EVENT, EVENT_TYPE_USER, NULL, "2", 1, false));
+
+            std::thread producer([&q] { q.push(GS_USER_EVENT, EVENT_TYPE_USER, NULL, "3", 1, true); });
+            TQueuedEvent evt;
+            CHECK(q.pop(evt, true));
+            CHECK(evt.data == std::vector<unsigned char>{'1'});
+            CHECK(q.pop(evt, true));
+            CHECK(evt.data == std::vector<unsigned char>{'3'});
+            producer.join();
+            CHECK(q.stats().dropped == 1);
+
+            q.close();
+            CHECK_FALSE(q.pop(evt, true));
+            CHECK_FALSE(q.push(GS_USER_EVENT, EVENT_TYPE_USER, NULL, "4", 1, true));
+        }
+        SECTION("block is rejected when pumped") {
+            //the pumping thread would wait for itself once the queue is full
+            CHECK_THROWS_AS(core->setEventDispatch(EVENT_DISPATCH_PUMP, 2, EVENT_QUEUE_BLOCK), gs5_error);
+            CHECK(core->eventDispatchMode() == EVENT_DISPATCH_SYNC);
+
+            REQUIRE(core->applyLicenseCode(lic_e1_unlock));
+            Entity e1 = core->entity(e1_id);
+            REQUIRE(e1.beginAccess());
+            core->tickFromExternalTimer();
+            core->tickFromExternalTimer();
+            CHECK(e1.endAccess());
+        }
+    }
+
+    core->setEventDispatch(EVENT_DISPATCH_SYNC);
+    CHECK(core->eventQueueStats().queued == 0);
+    core->setEntityEventHandler(NULL, NULL);
+    core->setUserEventHandler(NULL, NULL);
+    clean_license();
+}
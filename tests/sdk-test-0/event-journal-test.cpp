@@ -0,0 +1,200 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GS5.h>
+#include <GS5_Ext.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[event-journal]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+const char *journalFile = "event-journal-test.gsj";
+
+class TReplayApp : public TGSApp {
+  public:
+    std::vector<unsigned int> events;
+    std::vector<std::string> entities;
+    std::string userData;
+
+  protected:
+    void OnAppEvent(unsigned int evtId) override { events.push_back(evtId); }
+    void OnLicenseEvent(unsigned int evtId) override { events.push_back(evtId); }
+    void OnEntityEvent(unsigned int evtId, TGSEntity *entity) override {
+        events.push_back(evtId);
+        entities.push_back(entity->id());
+    }
+    void OnReplayedEntityEvent(unsigned int evtId, const char *entityId) override {
+        events.push_back(evtId);
+        entities.push_back(std::string("id:") + entityId);
+    }
+    void OnUserEvent(unsigned int eventId, void *eventData, unsigned int eventDataSize) override {
+        events.push_back(eventId);
+        userData.assign((const char *)eventData, eventDataSize);
+    }
+};
+
+std::vector<TEventJournal::TEntry> readJournal(const char *fileName) {
+    TEventJournal journal(fileName, false);
+    std::vector<TEventJournal::TEntry> v;
+    TEventJournal::TEntry evt;
+    while (journal.read(evt))
+        v.push_back(evt);
+    return v;
+}
+} // namespace
+
+TEST_CASE("event-journal", tag) {
+    SECTION("round trip") {
+        {
+            TEventJournal journal(journalFile, true);
+            journal.write(EVENT_APP_BEGIN, EVENT_TYPE_APP, NULL, NULL, 0);
+            journal.write(EVENT_ENTITY_ACCESS_HEARTBEAT, EVENT_TYPE_ENTITY, e1_id, NULL, 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            journal.write(GS_USER_EVENT + 1, EVENT_TYPE_USER, NULL, "payload", 7);
+            CHECK(journal.count() == 3);
+            TEventJournal::TEntry evt;
+            CHECK_THROWS_AS(journal.read(evt), gs5_error);
+        }
+        std::vector<TEventJournal::TEntry> v = readJournal(journalFile);
+        REQUIRE(v.size() == 3);
+        CHECK(v[0].eventId == EVENT_APP_BEGIN);
+        CHECK(v[0].type == EVENT_TYPE_APP);
+        CHECK(v[1].type == EVENT_TYPE_ENTITY);
+        CHECK(v[1].entityId == e1_id);
+        CHECK(v[2].eventId == GS_USER_EVENT + 1);
+        CHECK(v[2].type == EVENT_TYPE_USER);
+        CHECK(std::string(v[2].data.begin(), v[2].data.end()) == "payload");
+        CHECK(v[2].delay >= 20000);
+    }
+
+    SECTION("bad journal") {
+        CHECK_THROWS_AS(TEventJournal("no-such-dir/journal.gsj", false), gs5_error);
+
+        FILE *f = fopen(journalFile, "wb");
+        fputs("not a journal", f);
+        fclose(f);
+        CHECK_THROWS_AS(TEventJournal(journalFile, false), gs5_error);
+
+        {
+            TEventJournal journal(journalFile, true);
+            journal.write(GS_USER_EVENT, EVENT_TYPE_USER, NULL, "0123456789", 10);
+        }
+        std::vector<char> buf(64);
+        f = fopen(journalFile, "rb");
+        size_t n = fread(buf.data(), 1, buf.size(), f);
+        fclose(f);
+        f = fopen(journalFile, "wb");
+        fwrite(buf.data(), 1, n - 3, f);
+        fclose(f);
+        CHECK_THROWS_AS(readJournal(journalFile), gs5_error);
+
+        //lengths beyond the end of the file are not allocated
+        const std::string records[] = {
+            std::string("\x00\x01\x80\x80\x80\x80\x01\x00\xF0\xFF\xFF\xFF\x0F", 13), //user data of ~4 GiB
+            std::string("\x00\xC8\x01\xC8\x01\xFF\xFF\x03", 8),                     //entity id of 64 KiB
+        };
+        for (const std::string &rec : records) {
+            {
+                TEventJournal journal(journalFile, true);
+            }
+            f = fopen(journalFile, "ab");
+            fwrite(rec.data(), 1, rec.size(), f);
+            fclose(f);
+            CHECK_THROWS_AS(readJournal(journalFile), gs5_error);
+        }
+    }
+
+#ifdef __linux__
+    SECTION("disk full") {
+        {
+            TEventJournal journal("/dev/full", true);
+            std::vector<char> data(64 * 1024);
+            CHECK_FALSE(journal.write(GS_USER_EVENT, EVENT_TYPE_USER, NULL, data.data(), (unsigned int)data.size()));
+            CHECK(journal.failed());
+            CHECK_FALSE(journal.write(GS_USER_EVENT, EVENT_TYPE_USER, NULL, NULL, 0));
+            CHECK(journal.count() == 0);
+        }
+
+        //buffered events, the failure shows when the journal is stopped
+        auto core = TGSCore::getInstance();
+        core->startEventJournal("/dev/full");
+        gsPostUserEvent(GS_USER_EVENT, true, (void *)"hello", 5);
+        CHECK_FALSE(core->stopEventJournal());
+        CHECK(core->stopEventJournal());
+    }
+#endif
+
+    SECTION("record and replay") {
+        auto core = TGSCore::getInstance();
+        clean_license();
+        core->startEventJournal(journalFile);
+        REQUIRE(core->applyLicenseCode(lic_e1_unlock));
+        Entity e1 = core->entity(e1_id);
+        REQUIRE(e1.beginAccess());
+        core->tickFromExternalTimer();
+        CHECK(e1.endAccess());
+        gsPostUserEvent(GS_USER_EVENT + 7, true, (void *)"hello", 5);
+        CHECK(core->stopEventJournal());
+
+        std::vector<TEventJournal::TEntry> v = readJournal(journalFile);
+        REQUIRE(v.size() >= 6);
+        CHECK(v.back().eventId == GS_USER_EVENT + 7);
+
+        //not deleted, ~TGSApp() would clean up the core shared by the other tests
+        TReplayApp *app = new TReplayApp();
+        int unopened = -1;
+        CHECK(app->replayEvents(journalFile, false, &unopened) == (int)v.size());
+        CHECK(unopened == 0);
+        REQUIRE(app->events.size() == v.size());
+        int entityEvents = 0;
+        for (size_t i = 0; i < v.size(); i++) {
+            CHECK(app->events[i] == v[i].eventId);
+            if (v[i].type == EVENT_TYPE_ENTITY)
+                CHECK(app->entities[entityEvents++] == v[i].entityId);
+        }
+        CHECK(app->userData == "hello");
+
+        //at the original pace
+        core->startEventJournal(journalFile);
+        gsPostUserEvent(GS_USER_EVENT, true, NULL, 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        gsPostUserEvent(GS_USER_EVENT, true, NULL, 0);
+        CHECK(core->stopEventJournal());
+        app->events.clear();
+        auto start = std::chrono::steady_clock::now();
+        CHECK(app->replayEvents(journalFile, true) == 2);
+        CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(45));
+        CHECK(app->events.size() == 2);
+
+        //entities that cannot be opened are replayed by id
+        {
+            TEventJournal journal(journalFile, true);
+            journal.write(EVENT_ENTITY_ACCESS_STARTED, EVENT_TYPE_ENTITY, "no-such-entity", NULL, 0);
+            journal.write(EVENT_ENTITY_ACCESS_HEARTBEAT, EVENT_TYPE_ENTITY, e1_id, NULL, 0);
+            journal.write(EVENT_ENTITY_ACCESS_ENDED, EVENT_TYPE_ENTITY, "no-such-entity", NULL, 0);
+        }
+        app->events.clear();
+        app->entities.clear();
+        CHECK(app->replayEvents(journalFile, false, &unopened) == 3);
+        CHECK(unopened == 2);
+        CHECK(app->events == std::vector<unsigned int>{EVENT_ENTITY_ACCESS_STARTED, EVENT_ENTITY_ACCESS_HEARTBEAT, EVENT_ENTITY_ACCESS_ENDED});
+        CHECK(app->entities == std::vector<std::string>{"id:no-such-entity", e1_id, "id:no-such-entity"});
+
+        core->setAppEventHandler(NULL, NULL);
+        core->setLicenseEventHandler(NULL, NULL);
+        core->setEntityEventHandler(NULL, NULL);
+        core->setUserEventHandler(NULL, NULL);
+        clean_license();
+    }
+    remove(journalFile);
+}
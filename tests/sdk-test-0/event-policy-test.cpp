@@ -0,0 +1,103 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[event-policy]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+
+std::atomic<int> s_heartBeats(0);
+
+void onEntityEvent(unsigned int eventId, TGSEntity *, void *) {
+    if (eventId == EVENT_ENTITY_ACCESS_HEARTBEAT)
+        s_heartBeats++;
+}
+
+void tick(int n) {
+    for (int i = 0; i < n; i++)
+        TGSCore::getInstance()->tickFromExternalTimer();
+}
+} // namespace
+
+TEST_CASE("event-policy", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+    REQUIRE(core->applyLicenseCode(lic_e1_unlock));
+    core->entityRegistry();
+    Entity e1 = core->entity(e1_id);
+    REQUIRE(e1.beginAccess());
+    s_heartBeats = 0;
+    core->setEntityEventHandler(onEntityEvent, nullptr);
+
+    SECTION("sample") {
+        core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::sample(3));
+        tick(9);
+        CHECK(s_heartBeats == 3);
+        TEventPolicyStats stats = core->eventPolicyStats(EVENT_ENTITY_ACCESS_HEARTBEAT);
+        CHECK(stats.delivered == 3);
+        CHECK(stats.suppressed == 6);
+    }
+
+    SECTION("coalesce") {
+        core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::coalesce(60000));
+        tick(5);
+        CHECK(s_heartBeats == 1);
+        CHECK(core->eventPolicyStats(EVENT_ENTITY_ACCESS_HEARTBEAT).suppressed == 4);
+    }
+
+    SECTION("last in burst") {
+        //a window no tick() gap can reach: the events are held
+        core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::lastInBurst(60000));
+        tick(5);
+        CHECK(s_heartBeats == 0);
+        CHECK(core->eventPolicyStats(EVENT_ENTITY_ACCESS_HEARTBEAT).suppressed == 4);
+
+        //released right away when the policy is replaced
+        core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::all());
+        CHECK(s_heartBeats == 1);
+    }
+
+    SECTION("last in burst, released after the window") {
+        //a slow tick() may split the burst, only the totals are known
+        core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::lastInBurst(20));
+        tick(5);
+        TEventPolicyStats stats = core->eventPolicyStats(EVENT_ENTITY_ACCESS_HEARTBEAT);
+        for (int i = 0; i < 500 && stats.delivered + stats.suppressed < 5; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            stats = core->eventPolicyStats(EVENT_ENTITY_ACCESS_HEARTBEAT);
+        }
+        CHECK(stats.delivered >= 1);
+        CHECK(stats.delivered + stats.suppressed == 5);
+        //counted before the handler is called
+        for (int i = 0; i < 500 && s_heartBeats < (int)stats.delivered; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(s_heartBeats == (int)stats.delivered);
+    }
+
+    SECTION("all") {
+        core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::sample(2));
+        core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::all());
+        tick(4);
+        CHECK(s_heartBeats == 4);
+        CHECK(core->eventPolicyStats(EVENT_ENTITY_ACCESS_HEARTBEAT).delivered == 0);
+    }
+
+    SECTION("user events have no policy") {
+        CHECK_THROWS_AS(core->setEventPolicy(GS_USER_EVENT, TEventPolicy::sample(2)), gs5_error);
+    }
+
+    core->setEventPolicy(EVENT_ENTITY_ACCESS_HEARTBEAT, TEventPolicy::all());
+    core->setEntityEventHandler(NULL, NULL);
+    CHECK(e1.endAccess());
+    clean_license();
+}
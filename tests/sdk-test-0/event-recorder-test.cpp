@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[event-recorder]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+} // namespace
+
+TEST_CASE("event-recorder", tag) {
+    SECTION("ring") {
+        TEventRecorder r(5);
+        CHECK(r.capacity() == 8);
+        r.record(EVENT_APP_BEGIN, NULL);
+        r.record(EVENT_ENTITY_ACCESS_STARTED, e1_id);
+        r.record(EVENT_APP_RUN, NULL);
+
+        std::vector<TEventRecorder::TRecord> v = r.records();
+        REQUIRE(v.size() == 3);
+        CHECK(v[0].eventId == EVENT_APP_BEGIN);
+        CHECK(v[0].entityId == std::string());
+        CHECK(v[1].eventId == EVENT_ENTITY_ACCESS_STARTED);
+        CHECK(v[1].entityId == std::string(e1_id));
+        CHECK(v[1].thread == v[0].thread);
+        CHECK(v[2].time >= v[1].time);
+        CHECK(v[1].time >= v[0].time);
+
+        for (int i = 0; i < 10; i++)
+            r.record(GS_USER_EVENT + i, NULL);
+        v = r.records();
+        REQUIRE(v.size() == 8);
+        CHECK(r.recorded() == 13);
+        CHECK(v.front().seq == 5);
+        CHECK(v.front().eventId == GS_USER_EVENT + 2);
+        CHECK(v.back().eventId == GS_USER_EVENT + 9);
+
+        std::string longId(100, 'x');
+        r.record(EVENT_ENTITY_ACCESS_HEARTBEAT, longId.c_str());
+        CHECK(r.records().back().entityId == longId.substr(0, TEventRecorder::MAX_ENTITY_ID));
+    }
+
+    SECTION("dump") {
+        TEventRecorder r;
+        r.record(EVENT_ENTITY_ACCESS_HEARTBEAT, e1_id);
+        std::string s = r.dump();
+        CHECK(s.find(TGSCore::getEventName(EVENT_ENTITY_ACCESS_HEARTBEAT)) != std::string::npos);
+        CHECK(s.find(e1_id) != std::string::npos);
+        CHECK(std::count(s.begin(), s.end(), '\n') == 1);
+    }
+
+    SECTION("concurrent writers") {
+        TEventRecorder r(64);
+        std::atomic<bool> stop(false);
+        int torn = 0;
+        std::thread reader([&] {
+            while (!stop) {
+                for (const TEventRecorder::TRecord &rec : r.records()) {
+                    if (rec.entityId != "t" + std::to_string(rec.eventId))
+                        torn++;
+                }
+            }
+        });
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; t++) {
+            writers.emplace_back([&r, t] {
+                std::string id = "t" + std::to_string(t);
+                for (int i = 0; i < 20000; i++)
+                    r.record(t, id.c_str());
+            });
+        }
+        for (auto &w : writers)
+            w.join();
+        stop = true;
+        reader.join();
+        CHECK(torn == 0);
+        CHECK(r.recorded() == 80000);
+        CHECK(r.records().size() == 64);
+    }
+
+    SECTION("core") {
+        auto core = TGSCore::getInstance();
+        clean_license();
+        uint64_t before = core->eventRecorder().recorded();
+        CHECK(core->applyLicenseCode(lic_e1_unlock));
+        CHECK(core->eventRecorder().recorded() > before);
+
+        std::vector<TEventRecorder::TRecord> v = core->eventRecorder().records();
+        CHECK(std::any_of(v.begin(), v.end(), [](const TEventRecorder::TRecord &r) {
+            return r.eventId == EVENT_ENTITY_ACTION_APPLIED && r.entityId == std::string(e1_id);
+        }));
+
+        std::string file = "event-recorder-test.log";
+        REQUIRE(core->eventRecorder().dump(file.c_str()));
+        std::ifstream f(file);
+        std::stringstream ss;
+        ss << f.rdbuf();
+        f.close();
+        remove(file.c_str());
+        CHECK(ss.str().find(TGSCore::getEventName(EVENT_ENTITY_ACTION_APPLIED)) != std::string::npos);
+        clean_license();
+    }
+}
@@ -0,0 +1,156 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[event-subscription]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+const char *e2_id = "c46c0500-e79f-4a0f-994b-ff8b56b441c2";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+
+struct TSubscriberLog {
+    std::vector<unsigned int> events;
+    std::vector<std::string> entities;
+    int subscription = 0;
+    bool unsubscribeOnEvent = false;
+};
+
+void onEvent(unsigned int eventId, TGSEntity *entity, void *, unsigned int, void *usrData) {
+    TSubscriberLog *log = (TSubscriberLog *)usrData;
+    log->events.push_back(eventId);
+    if (entity)
+        log->entities.push_back(entity->id());
+    if (log->unsubscribeOnEvent)
+        TGSCore::getInstance()->unsubscribe(log->subscription);
+}
+
+void onEventCount(unsigned int, TGSEntity *, void *, unsigned int, void *usrData) {
+    ((std::atomic<int> *)usrData)->fetch_add(1);
+}
+
+void postUserEvent(unsigned int eventId) {
+    gsPostUserEvent(eventId, true, NULL, 0);
+}
+} // namespace
+
+TEST_CASE("event-mask", tag) {
+    TEventMask m{EVENT_ENTITY_ACCESS_HEARTBEAT, EVENT_ENTITY_ACTION_APPLIED};
+    CHECK(m.test(EVENT_ENTITY_ACCESS_HEARTBEAT));
+    CHECK(m.test(EVENT_ENTITY_ACTION_APPLIED));
+    CHECK_FALSE(m.test(EVENT_ENTITY_TRY_ACCESS));
+    CHECK_FALSE(m.test(EVENT_LICENSE_READY));
+    CHECK_FALSE(m.test(GS_USER_EVENT));
+
+    m.add(EVENT_TYPE_LICENSE);
+    CHECK(m.test(EVENT_LICENSE_READY));
+    CHECK(m.test(EVENT_LICENSE_LOADING));
+    CHECK_FALSE(m.test(EVENT_APP_BEGIN));
+
+    TEventMask u{GS_USER_EVENT + 1};
+    CHECK(u.test(GS_USER_EVENT + 1));
+    CHECK_FALSE(u.test(GS_USER_EVENT + 2));
+    CHECK_FALSE(u.test(EVENT_APP_BEGIN + 1));
+    //ids beyond the last bit share it, but are matched exactly
+    u.add(GS_USER_EVENT + 100);
+    CHECK(u.test(GS_USER_EVENT + 100));
+    CHECK_FALSE(u.test(GS_USER_EVENT + 63));
+    CHECK_FALSE(u.test(GS_USER_EVENT + 1000));
+    TEventMask v{GS_USER_EVENT + 1000};
+    v |= u;
+    CHECK(v.test(GS_USER_EVENT + 100));
+    CHECK(v.test(GS_USER_EVENT + 1000));
+    CHECK_FALSE(v.test(GS_USER_EVENT + 101));
+    CHECK(TEventMask().add(EVENT_TYPE_USER).test(GS_USER_EVENT + 1000));
+
+    CHECK(TEventMask().empty());
+    CHECK_FALSE(u.empty());
+    CHECK(TEventMask::all().test(EVENT_APP_END));
+    CHECK(TEventMask::all().test(0xFFFFFFF0));
+}
+
+TEST_CASE("event-subscription", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+
+    SECTION("filtered") {
+        TSubscriberLog applied, e2Applied, user;
+        int s1 = core->subscribe(onEvent, &applied, TEventMask{EVENT_ENTITY_ACTION_APPLIED});
+        int s2 = core->subscribe(onEvent, &e2Applied, TEventMask{EVENT_ENTITY_ACTION_APPLIED}, e2_id);
+        int s3 = core->subscribe(onEvent, &user, TEventMask().add(EVENT_TYPE_USER));
+        CHECK(s1 != s2);
+        CHECK(s2 != s3);
+
+        CHECK(core->applyLicenseCode(lic_e1_unlock));
+        REQUIRE_FALSE(applied.events.empty());
+        CHECK(std::find(applied.entities.begin(), applied.entities.end(), e1_id) != applied.entities.end());
+        for (unsigned int id : applied.events)
+            CHECK(id == EVENT_ENTITY_ACTION_APPLIED);
+        CHECK(std::find(e2Applied.entities.begin(), e2Applied.entities.end(), e1_id) == e2Applied.entities.end());
+        CHECK(user.events.empty());
+
+        size_t n = applied.events.size();
+        postUserEvent(GS_USER_EVENT + 7);
+        CHECK(user.events == std::vector<unsigned int>{GS_USER_EVENT + 7});
+        CHECK(applied.events.size() == n);
+
+        CHECK(core->unsubscribe(s1));
+        CHECK(core->unsubscribe(s2));
+        CHECK(core->unsubscribe(s3));
+        CHECK_FALSE(core->unsubscribe(s3));
+
+        postUserEvent(GS_USER_EVENT + 7);
+        CHECK(user.events.size() == 1);
+
+        TSubscriberLog beyond;
+        int s4 = core->subscribe(onEvent, &beyond, TEventMask{GS_USER_EVENT + 100});
+        postUserEvent(GS_USER_EVENT + 200);
+        postUserEvent(GS_USER_EVENT + 100);
+        CHECK(beyond.events == std::vector<unsigned int>{GS_USER_EVENT + 100});
+        CHECK(core->unsubscribe(s4));
+    }
+
+    SECTION("unsubscribed by itself") {
+        TSubscriberLog once, always;
+        once.unsubscribeOnEvent = true;
+        once.subscription = core->subscribe(onEvent, &once, TEventMask().add(EVENT_TYPE_USER));
+        int s = core->subscribe(onEvent, &always, TEventMask().add(EVENT_TYPE_USER));
+
+        postUserEvent(GS_USER_EVENT);
+        postUserEvent(GS_USER_EVENT);
+        CHECK(once.events.size() == 1);
+        CHECK(always.events.size() == 2);
+        CHECK_FALSE(core->unsubscribe(once.subscription));
+        CHECK(core->unsubscribe(s));
+    }
+
+    SECTION("changed while events are delivered") {
+        std::atomic<int> count(0);
+        std::atomic<bool> stop(false);
+        int s = core->subscribe(onEventCount, &count, TEventMask().add(EVENT_TYPE_USER));
+        std::thread poster([&stop] {
+            while (!stop)
+                postUserEvent(GS_USER_EVENT);
+        });
+        for (int i = 0; i < 1000 || count < 1000; i++) {
+            int t = core->subscribe(onEventCount, &count, TEventMask().add(EVENT_TYPE_USER));
+            CHECK(core->unsubscribe(t));
+        }
+        stop = true;
+        poster.join();
+        CHECK(core->unsubscribe(s));
+        CHECK(count > 0);
+    }
+
+    clean_license();
+}
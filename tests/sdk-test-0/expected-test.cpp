@@ -0,0 +1,79 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <memory>
+#include <string>
+
+#include <GS5.h>
+using namespace gs;
+
+namespace {
+const char *tag = "[expected]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+} // namespace
+
+TEST_CASE("expected", tag) {
+    auto core = TGSCore::getInstance();
+
+    SECTION("lookups") {
+        expected<Entity> e1 = core->tryEntity(e1_id);
+        REQUIRE(e1);
+        CHECK(e1->name() == std::string("e1"));
+        CHECK(core->tryEntity(1));
+
+        expected<Entity> none = core->tryEntity("no-such-entity");
+        CHECK_FALSE(none);
+        CHECK(none.error() == gs_errc::invalid_entity);
+        CHECK(core->tryEntity(100).error() == gs_errc::invalid_index);
+        CHECK(core->tryVariable("noSuchVariable").error() == gs_errc::invalid_name);
+        CHECK(core->tryVariable(-1).error() == gs_errc::invalid_index);
+        CHECK(core->tryVariable(core->getTotalVariables()).error() == gs_errc::invalid_index);
+        CHECK_THROWS_AS(core->variable(core->getTotalVariables()), gs5_error);
+        CHECK_THROWS_AS(core->getVariableByIndex(-1), gs5_error);
+
+        std::unique_ptr<TGSVariable> added(core->addVariable("expected", VAR_TYPE_INT, VAR_ATTR_READ | VAR_ATTR_WRITE, "7"));
+        int last = core->getTotalVariables() - 1;
+        expected<Variable> var = core->tryVariable(last);
+        REQUIRE(var);
+        CHECK(var->name() == std::string("expected"));
+        CHECK(core->variable(last).asInt() == 7);
+        core->removeVariable("expected");
+
+        //the throwing api reports the same error code
+        try {
+            none.value();
+            FAIL("no exception");
+        } catch (gs5_error &e) {
+            CHECK(e.code() == GS_ERROR_INVALID_ENTITY);
+        }
+    }
+
+    SECTION("license parameters") {
+        expected<License> lic = core->entity(e1_id).tryLicense();
+        REQUIRE(lic);
+
+        expected<int> tolerance = lic->tryGetParamInt("rollbackTolerance");
+        REQUIRE(tolerance);
+        CHECK(*tolerance == 4000);
+        CHECK(lic->tryGetParamUTCTime("timeBegin").value() == 1704096000);
+        CHECK(lic->tryGetParamBool("timeEndEnabled").value_or(false));
+
+        expected<int> missing = lic->tryGetParamInt("noSuchParam");
+        CHECK(missing.error() == gs_errc::invalid_name);
+        CHECK(missing.value_or(-1) == -1);
+        CHECK(missing.message() == std::string("Invalid name"));
+        CHECK(lic->tryParam(100).error() == gs_errc::invalid_index);
+
+        CHECK(lic->trySetParamInt("rollbackTolerance", 100));
+        CHECK(lic->getParamInt("rollbackTolerance") == 100);
+        CHECK(lic->trySetParamInt("rollbackTolerance", 4000));
+        CHECK(lic->trySetParamInt("noSuchParam", 1).error() == gs_errc::invalid_name);
+    }
+
+    SECTION("request") {
+        Request req = core->request();
+        expected<Action> act = req.tryAddAction(ACT_UNLOCK, e1_id);
+        REQUIRE(act);
+        CHECK(act->id() == ACT_UNLOCK);
+    }
+}
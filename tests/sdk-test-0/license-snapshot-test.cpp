@@ -0,0 +1,79 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[license-snapshot]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+const char *e2_id = "c46c0500-e79f-4a0f-994b-ff8b56b441c2";
+//e2 expires at 2030/01/01
+const char *lic_e2_end_2030 = "EKMP-WTLA-UYRI-JRBX-TGLT-LB6D-5U6L-WWHT-BSEP";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+} // namespace
+
+TEST_CASE("license-snapshot", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+
+    LicenseSnapshot before = LicenseSnapshot::capture();
+    REQUIRE(before.licenses().size() == 2);
+
+    SECTION("capture") {
+        int e2 = before.indexOf(e2_id);
+        REQUIRE(e2 == 1);
+        CHECK(before.str(before.licenses()[e2].licenseId) == std::string("gs.lm.expire.hardDate.1"));
+
+        int p = before.indexOf(e2, "timeEnd");
+        REQUIRE(p >= 0);
+        const LicenseSnapshot::TParam &timeEnd = before.params()[p];
+        CHECK(timeEnd.type == VAR_TYPE_TIME);
+        CHECK(timeEnd.i == 946713600);
+        CHECK(before.indexOf(e2, "noSuchParam") == -1);
+        CHECK(before.indexOf("no-such-entity") == -1);
+
+        LicenseSnapshot one = LicenseSnapshot::capture(core->entity(e2_id).license());
+        REQUIRE(one.licenses().size() == 1);
+        CHECK(one.indexOf(e2_id) == 0);
+        CHECK(one.licenses()[0].paramCount == before.licenses()[e2].paramCount);
+    }
+
+    SECTION("diff") {
+        CHECK(before.diff(LicenseSnapshot::capture()).empty());
+
+        CHECK(core->applyLicenseCode(lic_e2_end_2030));
+        LicenseSnapshot after = LicenseSnapshot::capture();
+
+        std::vector<LicenseSnapshot::TChange> changes = before.diff(after);
+        bool timeEndChanged = false;
+        for (const LicenseSnapshot::TChange &c : changes) {
+            CHECK(after.str(after.licenses()[c.licenseAfter].entityId) == std::string(e2_id));
+            if (c.kind == LicenseSnapshot::VALUE_CHANGED && after.str(after.params()[c.paramAfter].name) == std::string("timeEnd")) {
+                timeEndChanged = true;
+                CHECK(after.params()[c.paramAfter].i == 1893484800);
+            }
+        }
+        CHECK(timeEndChanged);
+
+        CHECK(core->applyLicenseCode(lic_e1_unlock));
+        changes = after.diff(LicenseSnapshot::capture());
+        REQUIRE(changes.size() == 1);
+        CHECK(changes[0].kind == LicenseSnapshot::STATUS_CHANGED);
+        CHECK(changes[0].licenseBefore == before.indexOf(e1_id));
+
+        //licenses missing on either side
+        LicenseSnapshot one = LicenseSnapshot::capture(core->entity(e1_id).license());
+        changes = one.diff(before);
+        REQUIRE(changes.size() >= 1);
+        CHECK(changes.back().kind == LicenseSnapshot::LICENSE_ADDED);
+        changes = before.diff(one);
+        CHECK(changes.front().kind == LicenseSnapshot::STATUS_CHANGED);
+        CHECK(changes.back().kind == LicenseSnapshot::LICENSE_REMOVED);
+
+        clean_license();
+    }
+}
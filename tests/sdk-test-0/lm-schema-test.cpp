@@ -0,0 +1,50 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <type_traits>
+
+#include <GS5_LM.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[lm-schema]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+
+static_assert(std::is_same<lm::HardDate::timeEnd::type, time_t>::value, "timeEnd is a time");
+static_assert(std::is_same<lm::HardDate::rollbackTolerance::type, int>::value, "rollbackTolerance is an int");
+static_assert(TLMParamIndex<lm::HardDate::timeEnd, lm::HardDate::timeBeginEnabled, lm::HardDate::timeBegin,
+                            lm::HardDate::timeEndEnabled, lm::HardDate::timeEnd>::value == 3, "");
+static_assert(TLMParamIndex<lm::Period::periodInSeconds, lm::HardDate::timeEnd>::value == -1, "");
+} // namespace
+
+TEST_CASE("lm-schema", tag) {
+    auto core = TGSCore::getInstance();
+    License lic = core->entity(e1_id).license();
+
+    SECTION("hard date") {
+        TLicenseModel<lm::HardDate> hd(lic);
+        CHECK(hd.get<lm::HardDate::timeBeginEnabled>());
+        CHECK(hd.get<lm::HardDate::timeBegin>() == 1704096000);
+        CHECK(hd.get<lm::HardDate::timeEndEnabled>());
+        CHECK(hd.get<lm::HardDate::timeEnd>() == 1735718400);
+        CHECK(hd.get<lm::HardDate::rollbackTolerance>() == 4000);
+
+        hd.set<lm::HardDate::rollbackTolerance>(100);
+        CHECK(lic.getParamInt("rollbackTolerance") == 100);
+
+        //resolved again once the license changes
+        clean_license();
+        CHECK(hd.stale());
+        CHECK(hd.get<lm::HardDate::rollbackTolerance>() == 4000);
+    }
+
+    SECTION("wrong model") {
+        CHECK_THROWS_AS(TLicenseModel<lm::Period>(lic), gs5_error);
+
+        TLicenseModel<lm::AccessTime> unbound;
+        CHECK_FALSE(unbound);
+        CHECK_THROWS_AS(unbound.get<lm::AccessTime::usedTimes>(), gs5_error);
+    }
+}
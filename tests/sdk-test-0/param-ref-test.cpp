@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[param-ref]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+const char *e2_id = "c46c0500-e79f-4a0f-994b-ff8b56b441c2";
+} // namespace
+
+TEST_CASE("param-ref", tag) {
+    auto core = TGSCore::getInstance();
+    License lic1 = core->entity(e1_id).license();
+    License lic2 = core->entity(e2_id).license();
+
+    SECTION("get / set") {
+        ParamRef<int> tolerance(lic1, "rollbackTolerance");
+        ParamRef<int64_t> timeEnd(lic1, "timeEnd");
+        ParamRef<bool> timeEndEnabled(lic1, "timeEndEnabled");
+        CHECK_FALSE(tolerance.stale());
+        CHECK(tolerance.get() == 4000);
+        CHECK(timeEnd.get() == 1735718400);
+        CHECK(timeEndEnabled.get());
+
+        tolerance.set(5000);
+        CHECK(tolerance.get() == 5000);
+        CHECK(lic1.getParamInt("rollbackTolerance") == 5000);
+
+        clean_license();
+    }
+
+    SECTION("invalidation") {
+        ParamRef<int64_t> timeEnd(lic1, "timeEnd");
+        timeEnd.set(1);
+
+        //the license is reset, the parameter is resolved again
+        clean_license();
+        CHECK(timeEnd.stale());
+        CHECK(timeEnd.get() == 1735718400);
+        CHECK_FALSE(timeEnd.stale());
+
+        timeEnd.rebind(lic2);
+        CHECK(timeEnd.stale());
+        CHECK(timeEnd.get() == 946713600);
+    }
+
+    SECTION("errors") {
+        CHECK_THROWS_AS(ParamRef<int>(lic1, "noSuchParam"), gs5_error);
+
+        ParamRef<int> unbound;
+        CHECK_FALSE(unbound);
+        CHECK_THROWS_AS(unbound.get(), gs5_error);
+
+        //rebound references are resolved on the next access
+        ParamRef<int> tolerance(lic1, "rollbackTolerance");
+        CHECK_NOTHROW(tolerance.rebind((TLicenseHandle)INVALID_GS_HANDLE));
+        CHECK_THROWS_AS(tolerance.get(), gs5_error);
+    }
+}
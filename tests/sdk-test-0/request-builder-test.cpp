@@ -0,0 +1,83 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <string>
+#include <time.h>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[request-builder]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+const char *e2_id = "c46c0500-e79f-4a0f-994b-ff8b56b441c2";
+const std::time_t T2030 = 1893484800; //2030/01/01
+const std::time_t T2040 = 2208988800; //2040/01/01
+
+//the same request, built the classic way
+std::string classicCode(std::time_t endDate) {
+    auto core = TGSCore::getInstance();
+    std::unique_ptr<TGSRequest> req(core->createRequest());
+    std::unique_ptr<TGSAction> act(req->addAction(ACT_SET_ENDDATE, e2_id));
+    std::unique_ptr<TGSVariable> v(act->getParamByName("endDate"));
+    v->fromUTCTime(endDate);
+    return req->code();
+}
+} // namespace
+
+TEST_CASE("request-builder", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+
+    SECTION("builder") {
+        std::string code = core->requestBuilder().action(ACT_SET_ENDDATE, e2_id).param("endDate", T2030).code();
+        CHECK(code == classicCode(T2030));
+
+        code = core->requestBuilder()
+                   .action(ACT_SET_ENDDATE, e2_id)
+                   .param("endDate", T2030)
+                   .action(ACT_UNLOCK, core->entity(e1_id))
+                   .code();
+        REQUIRE(core->applyLicenseCode(code.c_str()));
+        CHECK(core->entity(e1_id).isUnlocked());
+        Entity e2 = core->entity(e2_id);
+        CHECK(e2.license().getParamUTCTime("timeEnd") == T2030);
+        CHECK(e2.isAccessible());
+
+        Request req = core->requestBuilder().action(ACT_CLEAN).release();
+        CHECK(req);
+        CHECK(req.code()[0] != '\0');
+
+        CHECK_THROWS_AS(core->requestBuilder().param("endDate", T2030), gs5_error);
+        CHECK_THROWS_AS(core->requestBuilder().action(ACT_SET_ENDDATE, e2_id).param("noSuchParam", 1), gs5_error);
+    }
+
+    SECTION("template") {
+        RequestTemplate extend("extend e2");
+        extend.action(ACT_SET_ENDDATE, e2_id).param("endDate");
+        CHECK(extend.paramCount() == 1);
+        core->registerRequestTemplate(std::move(extend));
+
+        std::shared_ptr<const RequestTemplate> t = core->requestTemplate("extend e2");
+        CHECK(t->name() == std::string("extend e2"));
+        CHECK(t->code(T2030) == classicCode(T2030));
+        CHECK(t->code(T2040) == classicCode(T2040));
+
+        REQUIRE(core->applyLicenseCode(t->code(T2040).c_str()));
+        CHECK(core->entity(e2_id).license().getParamUTCTime("timeEnd") == T2040);
+
+        CHECK_THROWS_AS(t->code(), gs5_error);
+        CHECK_THROWS_AS(t->code(T2030, T2040), gs5_error);
+        CHECK_THROWS_AS(core->requestTemplate("no such template"), gs5_error);
+
+        RequestTemplate bad("bad");
+        CHECK_THROWS_AS(bad.param("endDate"), gs5_error);
+        CHECK_THROWS_AS(bad.action(ACT_SET_ENDDATE, "no-such-entity"), gs5_error);
+        bad.action(ACT_SET_ENDDATE, e2_id);
+        CHECK_THROWS_AS(bad.param("noSuchParam"), gs5_error);
+    }
+
+    clean_license();
+}
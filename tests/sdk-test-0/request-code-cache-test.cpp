@@ -0,0 +1,67 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <string>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[request-code-cache]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+//unlock e1
+const char *lic_e1_unlock = "5X5I-V5EM-PWZW-7IAW-H9K4";
+} // namespace
+
+TEST_CASE("request-code-cache", tag) {
+    auto core = TGSCore::getInstance();
+    clean_license();
+    core->invalidateRequestCodes();
+    TRequestCodeStats before = core->requestCodeStats();
+
+    SECTION("cached") {
+        std::string unlock = core->getUnlockRequestCode();
+        CHECK(core->getUnlockRequestCode() == unlock);
+        CHECK(core->requestCode(ACT_UNLOCK) == unlock);
+
+        Entity e1 = core->entity(e1_id);
+        std::string e1Unlock = e1.getUnlockRequestCode();
+        CHECK(e1Unlock != unlock);
+        CHECK(e1.license().getUnlockRequestCode() == e1Unlock);
+        std::unique_ptr<TGSEntity> e(core->getEntityById(e1_id));
+        CHECK(e->getUnlockRequestCode() == e1Unlock);
+        CHECK(e1.unlockRequest().code() == e1Unlock);
+
+        TRequestCodeStats stats = core->requestCodeStats();
+        CHECK(stats.misses - before.misses == 2);
+        CHECK(stats.hits - before.hits == 4);
+
+        CHECK_THROWS_AS(core->requestCode(ACT_UNLOCK, "no-such-entity"), gs5_error);
+    }
+
+    SECTION("invalidated") {
+        core->getCleanRequestCode();
+        core->getCleanRequestCode();
+        CHECK(core->requestCodeStats().misses - before.misses == 1);
+
+        //EVENT_ENTITY_ACTION_APPLIED
+        REQUIRE(core->applyLicenseCode(lic_e1_unlock));
+        core->getCleanRequestCode();
+        CHECK(core->requestCodeStats().misses - before.misses == 2);
+
+        core->entity(e1_id).lock();
+        core->getCleanRequestCode();
+        CHECK(core->requestCodeStats().misses - before.misses == 3);
+
+        core->invalidateRequestCodes();
+        core->getCleanRequestCode();
+        core->getCleanRequestCode();
+        TRequestCodeStats stats = core->requestCodeStats();
+        CHECK(stats.misses - before.misses == 4);
+        CHECK(stats.hits - before.hits == 2);
+    }
+
+    clean_license();
+}
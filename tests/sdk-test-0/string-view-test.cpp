@@ -0,0 +1,72 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <string_view>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[string-view]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+} // namespace
+
+TEST_CASE("string-view", tag) {
+    auto core = TGSCore::getInstance();
+
+    SECTION("string_view") {
+        gs::string_view empty;
+        CHECK(empty.empty());
+        CHECK(gs::string_view(nullptr).empty());
+
+        gs::string_view abc("abc");
+        CHECK(abc.size() == 3);
+        CHECK(abc == "abc");
+        CHECK(abc != "abd");
+        CHECK(abc < "abcd");
+        CHECK(gs::string_view("abc", 2) == "ab");
+        CHECK(abc.str() == "abc");
+
+        std::string_view sv = abc;
+        CHECK(sv == "abc");
+    }
+
+    SECTION("objects") {
+        std::unique_ptr<TGSVariable> added(core->addVariable("sv", VAR_TYPE_STRING, VAR_ATTR_READ | VAR_ATTR_WRITE, "hello"));
+        Variable var = core->variable("sv");
+        CHECK(var.asStringView() == "hello");
+        var.fromString("world");
+        CHECK(var.asStringView() == "world");
+
+        //a value view lasts until the next gsCore call of this thread, another value read may overwrite it
+        std::unique_ptr<TGSVariable> addedB(core->addVariable("sv2", VAR_TYPE_STRING, VAR_ATTR_READ | VAR_ATTR_WRITE, "other"));
+        Variable varB = core->variable("sv2");
+        std::string a = var.asStringView().str();
+        gs::string_view b = varB.asStringView();
+        CHECK(b == "other");
+        CHECK(a == "world");
+        CHECK(var.asStringView() == "world");
+        CHECK(varB.asStringView() == "other");
+        core->removeVariable("sv2");
+        core->removeVariable("sv");
+
+        Entity e1 = core->entity(e1_id);
+        Request req = e1.unlockRequest();
+        CHECK(gs::string_view(req.code()) == e1.getUnlockRequestCode().c_str());
+        CHECK(e1.license().unlockRequest().code() == e1.license().getUnlockRequestCode());
+    }
+
+    SECTION("move package") {
+        std::unique_ptr<TMovePackage> mp(core->createMovePackage());
+        mp->addEntityId(e1_id);
+        gs::string_view data = mp->exportDataView();
+        CHECK_FALSE(data.empty());
+
+        std::string app = core->exportApp();
+        CHECK(core->exportAppView() == app.c_str());
+
+        clean_license();
+    }
+}
@@ -0,0 +1,90 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GS5.h>
+using namespace gs;
+
+#include "main.h"
+
+namespace {
+const char *tag = "[user-event-post]";
+
+struct TReceived {
+    unsigned int eventId;
+    std::string data;
+    std::thread::id thread;
+};
+std::vector<TReceived> s_received; //written by the poster thread only
+
+void onUserEvent(unsigned int eventId, void *data, unsigned int size, void *) {
+    s_received.push_back({eventId, std::string((const char *)data, size), std::this_thread::get_id()});
+}
+} // namespace
+
+TEST_CASE("user-event-post", tag) {
+    auto core = TGSCore::getInstance();
+    core->flushUserEvents();
+    s_received.clear();
+    core->setUserEventHandler(onUserEvent, nullptr);
+    TUserEventPoster::TStats before = core->userEventStats();
+
+    SECTION("data copied") {
+        char buf[16] = "small";
+        core->postUserEventAsync(GS_USER_EVENT + 1, buf, 5);
+        strcpy(buf, "reused");
+        std::string medium(300, 'm'), large(10000, 'l');
+        core->postUserEventAsync(GS_USER_EVENT + 2, medium.data(), (unsigned int)medium.size());
+        core->postUserEventAsync(GS_USER_EVENT + 3, large.data(), (unsigned int)large.size());
+        core->postUserEventAsync(GS_USER_EVENT + 4);
+        core->flushUserEvents();
+
+        REQUIRE(s_received.size() == 4);
+        CHECK(s_received[0].eventId == GS_USER_EVENT + 1);
+        CHECK(s_received[0].data == "small");
+        CHECK(s_received[1].data == medium);
+        CHECK(s_received[2].data == large);
+        CHECK(s_received[3].data.empty());
+        CHECK(s_received[0].thread != std::this_thread::get_id());
+
+        TUserEventPoster::TStats stats = core->userEventStats();
+        CHECK(stats.posted - before.posted == 4);
+        CHECK(stats.delivered - before.delivered == 4);
+        //only the one larger than the largest size class
+        CHECK(stats.unpooled - before.unpooled == 1);
+    }
+
+    SECTION("many posting threads") {
+        const int THREADS = 4, POSTS = 2000;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; t++) {
+            threads.emplace_back([core, t] {
+                for (int i = 0; i < POSTS; i++) {
+                    int payload[2] = {t, i};
+                    core->postUserEventAsync(GS_USER_EVENT, payload, sizeof(payload));
+                }
+            });
+        }
+        for (auto &t : threads)
+            t.join();
+        core->flushUserEvents();
+
+        REQUIRE(s_received.size() == THREADS * POSTS);
+        //in order per posting thread
+        std::vector<int> next(THREADS, 0);
+        int outOfOrder = 0;
+        for (const TReceived &r : s_received) {
+            const int *payload = (const int *)r.data.data();
+            if (r.data.size() != 2 * sizeof(int) || payload[1] != next[payload[0]]++)
+                outOfOrder++;
+        }
+        CHECK(outOfOrder == 0);
+        CHECK(core->userEventStats().delivered - before.delivered == THREADS * POSTS);
+    }
+
+    core->setUserEventHandler(NULL, NULL);
+}
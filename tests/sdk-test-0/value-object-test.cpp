@@ -0,0 +1,66 @@
+#include <catch2/catch.hpp>
+#include <catch_ex.h>
+
+#include <vector>
+
+#include <GS5.h>
+using namespace gs;
+
+namespace {
+const char *tag = "[value-object]";
+const char *e1_id = "a98b6275-b494-4cd9-bff5-4526aa0efd12";
+} // namespace
+
+TEST_CASE("value-object", tag) {
+    auto core = TGSCore::getInstance();
+
+    SECTION("entity") {
+        Entity e1 = core->entity(e1_id);
+        REQUIRE(e1);
+        CHECK(e1.name() == std::string("e1"));
+        CHECK(e1.hasLicense());
+
+        License lic = e1.license();
+        CHECK(lic.id() == std::string("gs.lm.expire.hardDate.1"));
+        CHECK(lic.getParamInt("rollbackTolerance") == 4000);
+        CHECK(lic.getParamUTCTime("timeBegin") == 1704096000);
+        CHECK(lic.entity().id() == std::string(e1_id));
+
+        CHECK_THROWS_AS(lic.param("noSuchParam"), gs5_error);
+        CHECK_THROWS_AS(core->entity("no-such-entity"), gs5_error);
+    }
+
+    SECTION("move") {
+        Entity a = core->entity(0);
+        gs_handle_t h = a.handle();
+
+        Entity b = std::move(a);
+        CHECK_FALSE(a);
+        CHECK(b.handle() == h);
+
+        a = std::move(b);
+        CHECK(a.handle() == h);
+        CHECK_FALSE(b);
+
+        a.close();
+        CHECK_FALSE(a);
+    }
+
+    SECTION("container") {
+        std::vector<Entity> entities;
+        for (int i = 0; i < core->getTotalEntities(); i++)
+            entities.push_back(core->entity(i));
+        REQUIRE(entities.size() == 2);
+        CHECK(entities[1].name() == std::string("e2"));
+    }
+
+    SECTION("request") {
+        Entity e1 = core->entity(e1_id);
+        CHECK(e1.getUnlockRequestCode() == e1.license().getUnlockRequestCode());
+
+        Request req = core->request();
+        Action act = req.addAction(ACT_UNLOCK, e1);
+        CHECK(act.id() == ACT_UNLOCK);
+        CHECK_FALSE(std::string(req.code()).empty());
+    }
+}
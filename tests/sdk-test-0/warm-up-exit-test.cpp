@@ -0,0 +1,20 @@
+// Returns from main() while gsCore may still be loading in the warm-up thread, without calling sdk_finish().
+// The process must exit cleanly (exit code 0).
+//
+// --after-finish: the warm-up is requested after sdk_finish(), it must not start.
+
+#include <cstring>
+
+#include <GS5_Intf.h>
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--after-finish") == 0) {
+        gs::sdk_warm_up();
+        gs::sdk_finish();
+        gs::sdk_warm_up();
+        return 0;
+    }
+    gs::sdk_warm_up();
+    gs::sdk_warm_up();
+    return 0;
+}